@@ -0,0 +1,68 @@
+// Generador de programas .brick sintéticos para pruebas de rendimiento.
+//   brick_gen [--entities N] [--rules M] [--statements K] [--seed S]
+//             [--size BYTES] [--no-comments] [-o archivo.brick]
+// Con --size se calculan entidades y reglas para llegar a ese tamaño.
+#include "program_gen.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+using namespace brick;
+namespace {
+void printUsage(const char* programName) {
+    std::printf("Uso: %s [--entities N] [--rules M] [--statements K] [--seed S]\n", programName);
+    std::printf("       [--size BYTES] [--no-comments] [-o archivo.brick]\n");
+}
+bool readNumber(int argc, char* argv[], int* i, unsigned long* value) {
+    if (*i + 1 >= argc) {
+        return false;
+    }
+    char* end = NULL;
+    *value = std::strtoul(argv[++*i], &end, 10);
+    return end && *end == '\0';
+}
+}
+int main(int argc, char* argv[]) {
+    GeneratorOptions options;
+    unsigned long size = 0;
+    const char* output = NULL;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        unsigned long value = 0;
+        if (arg == "-h" || arg == "--help") {
+            printUsage(argv[0]);
+            return 0;
+        } else if (arg == "--no-comments") {
+            options.comments = false;
+        } else if (arg == "-o" && i + 1 < argc) {
+            output = argv[++i];
+        } else if ((arg == "--entities" || arg == "--rules" || arg == "--statements" ||
+                    arg == "--seed" || arg == "--size") && readNumber(argc, argv, &i, &value)) {
+            if (arg == "--entities") options.entities = value;
+            else if (arg == "--rules") options.rules = value;
+            else if (arg == "--statements") options.statements = value;
+            else if (arg == "--seed") options.seed = value;
+            else size = value;
+        } else {
+            std::fprintf(stderr, "Opción inválida: %s\n", arg.c_str());
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (size > 0) {
+        bool comments = options.comments;
+        options = optionsForSize(size, options.statements, options.seed);
+        options.comments = comments;
+    }
+    std::string program = generateProgram(options);
+    FILE* file = output ? std::fopen(output, "wb") : stdout;
+    if (!file) {
+        std::fprintf(stderr, "No se pudo crear %s\n", output);
+        return 1;
+    }
+    bool written = std::fwrite(program.data(), 1, program.size(), file) == program.size();
+    if (output) {
+        written = std::fclose(file) == 0 && written;
+    }
+    return written ? 0 : 1;
+}
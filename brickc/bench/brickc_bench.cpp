@@ -0,0 +1,195 @@
+// Rendimiento del front-end sobre programas sintéticos de 1 KB a 100 MB.
+//   brickc_bench [--min-size BYTES] [--max-size BYTES] [--repeat R]
+//                [--statements K] [--output resultados.json]
+// Para cada tamaño mide por separado el lexer (solo tokens), el parser
+// (incluye su propio lexeo y el AST plano) y la tabla de símbolos (poblar,
+// compilar reglas y validar). Se queda con la mejor de R repeticiones. La
+// última columna es la latencia de una edición dentro de una regla con
+// IncrementalDocument, que no debería crecer con el archivo. El JSON lleva
+// la versión y los parámetros para comparar entre commits.
+#include "program_gen.hpp"
+#include "../src/lexer.hpp"
+#include "../src/parser.hpp"
+#include "../src/flat_ast.hpp"
+#include "../src/incremental.hpp"
+#include "../src/symbols.hpp"
+#include "../src/error.hpp"
+#include "../src/pass_timer.hpp"
+#include "../src/util.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+using namespace brick;
+namespace {
+struct Phase {
+    double seconds;
+    Phase() : seconds(0) {}
+    void keepBest(double elapsed) {
+        if (seconds == 0 || elapsed < seconds) seconds = elapsed;
+    }
+};
+struct Result {
+    size_t bytes;
+    size_t tokens;
+    size_t nodes;
+    Phase lex;
+    Phase parse;
+    Phase symbols;
+    double editMicroseconds;
+};
+double seconds(double startMs) {
+    return (PassTimer::now() - startMs) / 1000.0;
+}
+bool measure(const std::string& source, int repeat, Result& result) {
+    result.bytes = source.size();
+    for (int r = 0; r < repeat; ++r) {
+        StringInterner lexNames;
+        Lexer lexer;
+        lexer.setInterner(&lexNames);
+        lexer.init(source);
+        double start = PassTimer::now();
+        size_t tokens = 0;
+        while (lexer.nextToken().type != T_EOF) {
+            ++tokens;
+        }
+        result.lex.keepBest(seconds(start));
+        result.tokens = tokens;
+
+        StringInterner names;
+        Lexer parseLexer;
+        parseLexer.setInterner(&names);
+        parseLexer.init(source);
+        ErrorHandler errors;
+        AstArena arena;
+        FlatAst flat;
+        start = PassTimer::now();
+        Parser parser(&parseLexer, &errors, &arena);
+        bool parsed = parser.parseProgram(flat);
+        result.parse.keepBest(seconds(start));
+        if (!parsed || errors.hasErrors()) {
+            errors.printAll(std::cerr);
+            return false;
+        }
+        result.nodes = flat.nodeCount();
+        arena.release();
+
+        start = PassTimer::now();
+        SymbolTable table(&errors, &names);
+        bool ok = table.populateFromAST(flat) && table.validate() && !errors.hasErrors();
+        result.symbols.keepBest(seconds(start));
+        if (!ok) {
+            errors.printAll(std::cerr);
+            return false;
+        }
+    }
+    return true;
+}
+// Inserta y quita una sentencia en la regla del medio, alternando, y mide el
+// promedio por edición hasta tener la tabla de símbolos y los diagnósticos.
+// Incluye los reparseos completos que el documento hace para compactar.
+bool measureEdits(const std::string& source, Result& result) {
+    const int EDITS = 200;
+    IncrementalDocument document;
+    document.load(source);
+    size_t rule = source.find("    rule ", source.size() / 2);
+    size_t at = rule == std::string::npos ? std::string::npos : source.find('{', rule);
+    if (at == std::string::npos || document.hasErrors()) {
+        return false;
+    }
+    const std::string statement = "\n        lose;";
+    ++at;
+    double start = PassTimer::now();
+    for (int i = 0; i < EDITS; ++i) {
+        if (i % 2 == 0) {
+            document.edit(at, at, statement);
+        } else {
+            document.edit(at, at + statement.size(), "");
+        }
+        ErrorHandler diagnostics;
+        document.diagnostics(diagnostics);
+        if (diagnostics.hasErrors()) {
+            return false;
+        }
+    }
+    result.editMicroseconds = (PassTimer::now() - start) * 1000.0 / EDITS;
+    return true;
+}
+void printPhase(FILE* out, const char* name, const Phase& phase, const Result& result, bool last) {
+    std::fprintf(out, "      \"%s\": {\"seconds\": %.6f, \"mb_per_s\": %.3f, \"tokens_per_s\": %.0f}%s\n",
+                 name, phase.seconds, result.bytes / phase.seconds / 1e6,
+                 result.tokens / phase.seconds, last ? "" : ",");
+}
+}
+int main(int argc, char* argv[]) {
+    unsigned long minSize = 1000;
+    unsigned long maxSize = 100000000;
+    unsigned long repeat = 3;
+    unsigned long statements = 8;
+    const char* output = NULL;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--output" && i + 1 < argc) {
+            output = argv[++i];
+        } else if ((arg == "--min-size" || arg == "--max-size" || arg == "--repeat" ||
+                    arg == "--statements") && i + 1 < argc) {
+            unsigned long value = std::strtoul(argv[++i], NULL, 10);
+            if (arg == "--min-size") minSize = value;
+            else if (arg == "--max-size") maxSize = value;
+            else if (arg == "--repeat") repeat = value > 0 ? value : 1;
+            else statements = value;
+        } else {
+            std::fprintf(stderr, "Uso: %s [--min-size B] [--max-size B] [--repeat R] "
+                         "[--statements K] [--output archivo.json]\n", argv[0]);
+            return 1;
+        }
+    }
+    std::vector<Result> results;
+    std::printf("%12s %10s %11s %12s %11s %12s %11s %12s %11s\n", "bytes", "tokens",
+                "lexer MB/s", "tokens/s", "parser MB/s", "tokens/s", "tabla MB/s", "tokens/s", "edición µs");
+    for (unsigned long size = 1000; size <= maxSize; size *= 10) {
+        if (size < minSize) continue;
+        std::string source = generateProgram(optionsForSize(size, statements, 42));
+        Result result;
+        if (!measure(source, static_cast<int>(repeat), result)) {
+            std::fprintf(stderr, "El programa de %lu bytes no compila\n", size);
+            return 1;
+        }
+        if (!measureEdits(source, result)) {
+            std::fprintf(stderr, "Las ediciones del programa de %lu bytes dieron errores\n", size);
+            return 1;
+        }
+        std::printf("%12lu %10lu %11.2f %12.0f %11.2f %12.0f %11.2f %12.0f %11.2f\n",
+                    static_cast<unsigned long>(result.bytes), static_cast<unsigned long>(result.tokens),
+                    result.bytes / result.lex.seconds / 1e6, result.tokens / result.lex.seconds,
+                    result.bytes / result.parse.seconds / 1e6, result.tokens / result.parse.seconds,
+                    result.bytes / result.symbols.seconds / 1e6, result.tokens / result.symbols.seconds,
+                    result.editMicroseconds);
+        std::fflush(stdout);
+        results.push_back(result);
+    }
+    if (!output) {
+        return 0;
+    }
+    FILE* out = std::fopen(output, "w");
+    if (!out) {
+        std::fprintf(stderr, "No se pudo crear %s\n", output);
+        return 1;
+    }
+    std::fprintf(out, "{\n  \"brickc_version\": \"%s\",\n  \"statements_per_rule\": %lu,\n"
+                 "  \"repeat\": %lu,\n  \"results\": [\n", BRICKC_VERSION, statements, repeat);
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& result = results[i];
+        std::fprintf(out, "    {\"bytes\": %lu, \"tokens\": %lu, \"nodes\": %lu,\n",
+                     static_cast<unsigned long>(result.bytes), static_cast<unsigned long>(result.tokens),
+                     static_cast<unsigned long>(result.nodes));
+        printPhase(out, "lexer", result.lex, result, false);
+        printPhase(out, "parser", result.parse, result, false);
+        printPhase(out, "symbols", result.symbols, result, false);
+        std::fprintf(out, "      \"edit\": {\"microseconds\": %.3f}\n", result.editMicroseconds);
+        std::fprintf(out, "    }%s\n", i + 1 < results.size() ? "," : "");
+    }
+    std::fprintf(out, "  ]\n}\n");
+    return std::fclose(out) == 0 ? 0 : 1;
+}
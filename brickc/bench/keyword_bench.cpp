@@ -0,0 +1,88 @@
+// Microbenchmark: reconocimiento de palabras reservadas en el lexer.
+// Compara la cadena de comparaciones original (isKeyword + 15 ifs) con la
+// búsqueda por hash perfecto de Lexer::keywordType sobre una fuente con
+// muchos identificadores.
+#include "../src/lexer.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <string>
+#include <vector>
+using namespace brick;
+namespace {
+const char* WORDS[] = {
+    "game", "snake_head", "speed", "fruit", "grid", "color", "wall_left", "entity",
+    "spawn", "move_forward", "solid", "controls", "turn_up", "rule", "tick",
+    "collide", "grow_snake", "score", "lose", "true", "false", "paddle_right",
+    "superfruit", "lives", "obstacle", "x", "spawn_new_fruit", "colors", "ticks"
+};
+const size_t WORD_COUNT = sizeof(WORDS) / sizeof(WORDS[0]);
+bool legacyIsKeyword(const std::string& word) {
+    return word == "game" || word == "speed" || word == "grid" || word == "color" ||
+           word == "entity" || word == "spawn" || word == "solid" || word == "controls" ||
+           word == "rule" || word == "tick" || word == "collide" || word == "score" ||
+           word == "lose" || word == "true" || word == "false";
+}
+TokenType legacyKeywordType(const std::string& lexeme) {
+    TokenType type = T_IDENT;
+    if (legacyIsKeyword(lexeme)) {
+        if (lexeme == "game") type = T_GAME;
+        else if (lexeme == "speed") type = T_SPEED;
+        else if (lexeme == "grid") type = T_GRID;
+        else if (lexeme == "color") type = T_COLOR;
+        else if (lexeme == "entity") type = T_ENTITY;
+        else if (lexeme == "spawn") type = T_SPAWN;
+        else if (lexeme == "solid") type = T_SOLID;
+        else if (lexeme == "controls") type = T_CONTROLS;
+        else if (lexeme == "rule") type = T_RULE;
+        else if (lexeme == "tick") type = T_TICK;
+        else if (lexeme == "collide") type = T_COLLIDE;
+        else if (lexeme == "score") type = T_SCORE;
+        else if (lexeme == "lose") type = T_LOSE;
+        else if (lexeme == "true") type = T_TRUE;
+        else if (lexeme == "false") type = T_FALSE;
+    }
+    return type;
+}
+double secondsSince(clock_t start) {
+    return static_cast<double>(clock() - start) / CLOCKS_PER_SEC;
+}
+}
+int main(int argc, char* argv[]) {
+    size_t identifiers = argc > 1 ? static_cast<size_t>(std::atol(argv[1])) : 2000000;
+    std::vector<std::string> words;
+    std::string source;
+    words.reserve(identifiers);
+    srand(1234);
+    for (size_t i = 0; i < identifiers; ++i) {
+        words.push_back(WORDS[rand() % WORD_COUNT]);
+        source += words.back();
+        source += (i % 8 == 7) ? '\n' : ' ';
+    }
+    unsigned long checksum = 0;
+    clock_t start = clock();
+    for (size_t i = 0; i < words.size(); ++i) {
+        checksum += legacyKeywordType(words[i]);
+    }
+    double legacySeconds = secondsSince(start);
+    start = clock();
+    for (size_t i = 0; i < words.size(); ++i) {
+        checksum -= Lexer::keywordType(words[i].data(), words[i].length());
+    }
+    double hashSeconds = secondsSince(start);
+    Lexer lexer(source);
+    size_t tokens = 0;
+    start = clock();
+    while (lexer.nextToken().type != T_EOF) {
+        tokens++;
+    }
+    double lexSeconds = secondsSince(start);
+    std::printf("identificadores: %lu (checksum %lu)\n", static_cast<unsigned long>(identifiers), checksum);
+    std::printf("%-24s %10.2f M ident/s\n", "cadena de comparaciones",
+                identifiers / legacySeconds / 1e6);
+    std::printf("%-24s %10.2f M ident/s\n", "hash perfecto",
+                identifiers / hashSeconds / 1e6);
+    std::printf("%-24s %10.2f M tokens/s\n", "lexer completo",
+                tokens / lexSeconds / 1e6);
+    return checksum == 0 ? 0 : 1;
+}
@@ -0,0 +1,178 @@
+#include "program_gen.hpp"
+#include <cstdio>
+namespace brick {
+namespace {
+// Congruencial lineal de 32 bits (constantes de Numerical Recipes).
+class Random {
+private:
+    unsigned long state;
+public:
+    explicit Random(unsigned long seed) : state(seed ? seed : 1) {}
+    unsigned long next() {
+        state = (state * 1664525UL + 1013904223UL) & 0xFFFFFFFFUL;
+        return state >> 8;
+    }
+    size_t below(size_t n) {
+        return n ? static_cast<size_t>(next() % n) : 0;
+    }
+};
+const char* KEYS[] = { "w", "a", "s", "d", "up", "down", "left", "right", "space", "p" };
+const size_t KEY_COUNT = sizeof(KEYS) / sizeof(KEYS[0]);
+const char* ACTIONS[] = { "move_forward", "grow", "bounce", "fire", "rotate", "drop", "spawn_wave" };
+const size_t ACTION_COUNT = sizeof(ACTIONS) / sizeof(ACTIONS[0]);
+const char* OPERATORS[] = { " + ", " - ", " * ", " / " };
+const char* COMPARISONS[] = { " == ", " != ", " < ", " > ", " <= ", " >= " };
+void append(std::string& out, const char* format, unsigned long a = 0, unsigned long b = 0, unsigned long c = 0) {
+    char line[160];
+    std::snprintf(line, sizeof(line), format, a, b, c);
+    out += line;
+}
+// Expresión aritmética de 1 a 3 operadores; los divisores nunca son cero.
+std::string expression(Random& random) {
+    std::string text;
+    char number[16];
+    std::snprintf(number, sizeof(number), "%lu", random.below(90) + 1);
+    text += number;
+    size_t operators = random.below(3) + 1;
+    for (size_t i = 0; i < operators; ++i) {
+        text += OPERATORS[random.below(4)];
+        if (random.below(4) == 0) {
+            text += random.below(2) ? "score" : "speed";
+        } else {
+            std::snprintf(number, sizeof(number), "%lu", random.below(90) + 1);
+            text += number;
+        }
+    }
+    return random.below(5) == 0 ? "(" + text + ")" : text;
+}
+std::string entityName(Random& random, size_t entities) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "e%lu", static_cast<unsigned long>(random.below(entities)));
+    return name;
+}
+// Llamada con o sin argumentos: lo único que admite 'tick:'.
+void call(std::string& out, Random& random) {
+    out += ACTIONS[random.below(ACTION_COUNT)];
+    if (random.below(2)) {
+        out += "(" + expression(random) + ")";
+    }
+}
+void action(std::string& out, Random& random, size_t entities) {
+    switch (random.below(6)) {
+        case 0:
+            call(out, random);
+            break;
+        case 1:
+            append(out, "score: +%lu", random.below(100) + 1);
+            break;
+        case 2:
+            out += "speed: " + expression(random);
+            break;
+        case 3:
+            out += "spawn: " + entityName(random, entities);
+            break;
+        case 4:
+            out += "remove: " + entityName(random, entities);
+            break;
+        default:
+            out += ACTIONS[random.below(ACTION_COUNT)];
+            break;
+    }
+}
+void statement(std::string& out, Random& random, size_t entities, const char* indent) {
+    out += indent;
+    switch (random.below(7)) {
+        case 0:
+            out += "tick: ";
+            call(out, random);
+            break;
+        case 1:
+            out += "collide: " + entityName(random, entities) + ", " + entityName(random, entities) + ": ";
+            action(out, random, entities);
+            break;
+        case 2:
+            out += std::string("on ") + (random.below(2) ? "press " : "release ") + KEYS[random.below(KEY_COUNT)] + ": ";
+            action(out, random, entities);
+            break;
+        case 3:
+            out += "if score" + std::string(COMPARISONS[random.below(6)]) + expression(random) + ": ";
+            action(out, random, entities);
+            break;
+        case 4:
+            append(out, "every: %lu ticks", random.below(200) + 1);
+            break;
+        default:
+            action(out, random, entities);
+            break;
+    }
+    out += ";\n";
+}
+}
+GeneratorOptions::GeneratorOptions()
+    : entities(8), rules(16), statements(6), seed(1), comments(true) {
+}
+std::string generateProgram(const GeneratorOptions& options) {
+    Random random(options.seed);
+    size_t entities = options.entities ? options.entities : 1;
+    std::string out;
+    out.reserve((options.rules * (options.statements + 3) + entities * 6) * 40 + 512);
+    if (options.comments) {
+        out += "// Programa sintético generado por brick_gen\n";
+        append(out, "// entidades=%lu reglas=%lu sentencias=%lu\n", entities, options.rules, options.statements);
+    }
+    out += "game synthetic {\n";
+    out += "    speed: 4 + 2 * 2;\n";
+    out += "    grid: (10 * 4, 60 / 2);\n";
+    out += "    color: #102030;\n";
+    out += "    lives: 3;\n";
+    out += "    score: 0;\n\n";
+    for (size_t i = 0; i < entities; ++i) {
+        if (options.comments && i % 16 == 0) {
+            append(out, "    // Entidades %lu a %lu\n", i, (i + 16 < entities ? i + 16 : entities) - 1);
+        }
+        append(out, "    entity e%lu {\n", i);
+        append(out, "        spawn: (%lu + %lu, %lu);\n", random.below(20), random.below(20), random.below(30));
+        append(out, "        color: #%06lX;\n", random.next() & 0xFFFFFF);
+        out += random.below(2) ? "        solid: true;\n" : "        solid: false;\n";
+        out += "    }\n";
+    }
+    out += "\n    controls {\n";
+    for (size_t i = 0; i < KEY_COUNT; ++i) {
+        out += std::string("        ") + KEYS[i] + ": " + ACTIONS[i % ACTION_COUNT] + ";\n";
+    }
+    out += "    }\n\n";
+    for (size_t i = 0; i < options.rules; ++i) {
+        if (options.comments) {
+            append(out, "    // Regla %lu\n", i);
+        }
+        append(out, "    rule r%lu {\n", i);
+        // Una de cada cuatro reglas anida la mitad de sus sentencias.
+        size_t nested = i % 4 == 3 ? options.statements / 2 : 0;
+        for (size_t s = 0; s < options.statements - nested; ++s) {
+            statement(out, random, entities, "        ");
+        }
+        if (nested > 0) {
+            append(out, "        rule r%lu_inner {\n", i);
+            for (size_t s = 0; s < nested; ++s) {
+                statement(out, random, entities, "            ");
+            }
+            out += "        }\n";
+        }
+        out += "    }\n";
+    }
+    out += "}\n";
+    return out;
+}
+GeneratorOptions optionsForSize(size_t bytes, size_t statements, unsigned long seed) {
+    GeneratorOptions options;
+    options.statements = statements;
+    options.seed = seed;
+    options.rules = 64;
+    options.entities = 16;
+    double sample = static_cast<double>(generateProgram(options).size());
+    double scale = bytes / sample;
+    options.rules = static_cast<size_t>(64 * scale) + 1;
+    options.entities = static_cast<size_t>(16 * scale) + 1;
+    return options;
+}
+}
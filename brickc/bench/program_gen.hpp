@@ -0,0 +1,24 @@
+#ifndef PROGRAM_GEN_HPP
+#define PROGRAM_GEN_HPP
+#include <cstddef>
+#include <string>
+namespace brick {
+// Parámetros de un programa sintético. Con la misma semilla la salida es la
+// misma en cualquier plataforma (no se usa rand()).
+struct GeneratorOptions {
+    size_t entities;
+    size_t rules;
+    size_t statements;
+    unsigned long seed;
+    bool comments;
+    GeneratorOptions();
+};
+// Programa válido para el front-end completo: ajustes con expresiones,
+// entidades, un bloque de controles y reglas con todas las sentencias del
+// lenguaje (collide, every, on, if, set, spawn y reglas anidadas).
+std::string generateProgram(const GeneratorOptions& options);
+// Ajusta 'rules' (y las entidades, en proporción) para que el programa
+// ocupe aproximadamente 'bytes'.
+GeneratorOptions optionsForSize(size_t bytes, size_t statements, unsigned long seed);
+}
+#endif
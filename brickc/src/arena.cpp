@@ -0,0 +1,123 @@
+#include "arena.hpp"
+#include "util.hpp"
+#include <cstdlib>
+#include <cstring>
+namespace brick {
+namespace {
+inline size_t alignUp(size_t value) {
+    return (value + AstArena::ALIGNMENT - 1) & ~(AstArena::ALIGNMENT - 1);
+}
+const size_t CHUNK_HEADER = (sizeof(void*) * 3 + AstArena::ALIGNMENT - 1) & ~(AstArena::ALIGNMENT - 1);
+}
+AstArena::AstArena(size_t firstChunkSize)
+    : head(NULL), nextChunkSize(firstChunkSize), chunkCount(0), allocationCount(0), bytesUsed(0) {
+}
+AstArena::~AstArena() {
+    release();
+}
+AstArena::Chunk* AstArena::newChunk(size_t minSize) {
+    size_t size = nextChunkSize;
+    if (size < minSize) {
+        size = minSize;
+    }
+    Chunk* chunk = static_cast<Chunk*>(MemoryUtils::allocate(CHUNK_HEADER + size));
+    if (!chunk) {
+        return NULL;
+    }
+    chunk->next = head;
+    chunk->size = size;
+    chunk->used = 0;
+    head = chunk;
+    chunkCount++;
+    if (nextChunkSize < MAX_CHUNK_SIZE) {
+        nextChunkSize *= 2;
+    }
+    return chunk;
+}
+void* AstArena::allocate(size_t size) {
+    size = alignUp(size == 0 ? 1 : size);
+    Chunk* chunk = head;
+    if (!chunk || chunk->size - chunk->used < size) {
+        chunk = newChunk(size);
+        if (!chunk) {
+            return NULL;
+        }
+    }
+    void* memory = reinterpret_cast<char*>(chunk) + CHUNK_HEADER + chunk->used;
+    chunk->used += size;
+    allocationCount++;
+    bytesUsed += size;
+    return memory;
+}
+StringRef AstArena::copyString(const char* text, size_t length) {
+    char* copy = static_cast<char*>(allocate(length + 1));
+    if (!copy) {
+        return StringRef();
+    }
+    std::memcpy(copy, text, length);
+    copy[length] = '\0';
+    return StringRef(copy, length);
+}
+StringRef AstArena::copyString(const StringRef& text) {
+    return copyString(text.data, text.length);
+}
+StringRef AstArena::copyString(const std::string& text) {
+    return copyString(text.data(), text.length());
+}
+AstArena::Mark AstArena::mark() const {
+    Mark position;
+    position.chunk = head;
+    position.used = head ? head->used : 0;
+    position.chunkCount = chunkCount;
+    position.allocationCount = allocationCount;
+    position.bytesUsed = bytesUsed;
+    return position;
+}
+void AstArena::rewind(const Mark& position) {
+    while (head != position.chunk) {
+        Chunk* next = head->next;
+        std::free(head);
+        head = next;
+    }
+    if (head) {
+        head->used = position.used;
+    }
+    chunkCount = position.chunkCount;
+    allocationCount = position.allocationCount;
+    bytesUsed = position.bytesUsed;
+}
+void AstArena::reset() {
+    if (head) {
+        Chunk* rest = head->next;
+        while (rest) {
+            Chunk* next = rest->next;
+            std::free(rest);
+            rest = next;
+        }
+        head->next = NULL;
+        head->used = 0;
+        chunkCount = 1;
+    }
+    allocationCount = 0;
+    bytesUsed = 0;
+}
+void AstArena::release() {
+    while (head) {
+        Chunk* next = head->next;
+        std::free(head);
+        head = next;
+    }
+    chunkCount = 0;
+    allocationCount = 0;
+    bytesUsed = 0;
+}
+size_t AstArena::getChunkCount() const {
+    return chunkCount;
+}
+size_t AstArena::getAllocationCount() const {
+    return allocationCount;
+}
+size_t AstArena::getBytesUsed() const {
+    return bytesUsed;
+}
+}
@@ -0,0 +1,55 @@
+#ifndef ARENA_HPP
+#define ARENA_HPP
+#include "source.hpp"
+#include <cstddef>
+#include <string>
+namespace brick {
+// Asignador por desplazamiento para los nodos del AST. La memoria se pide en
+// bloques que crecen al doble; los nodos nunca se liberan uno a uno: release()
+// devuelve todos los bloques de una vez y reset() conserva el primero para
+// reutilizarlo en la siguiente compilación. mark()/rewind() descartan solo lo
+// asignado desde una marca, como el subárbol de un bloque ya aplanado.
+class AstArena {
+private:
+    struct Chunk {
+        Chunk* next;
+        size_t size;
+        size_t used;
+    };
+    Chunk* head;
+    size_t nextChunkSize;
+    size_t chunkCount;
+    size_t allocationCount;
+    size_t bytesUsed;
+    Chunk* newChunk(size_t minSize);
+    AstArena(const AstArena&);
+    AstArena& operator=(const AstArena&);
+public:
+    static const size_t ALIGNMENT = 16;
+    static const size_t DEFAULT_CHUNK_SIZE = 16 * 1024;
+    static const size_t MAX_CHUNK_SIZE = 1024 * 1024;
+    struct Mark {
+        Chunk* chunk;
+        size_t used;
+        size_t chunkCount;
+        size_t allocationCount;
+        size_t bytesUsed;
+    };
+    explicit AstArena(size_t firstChunkSize = DEFAULT_CHUNK_SIZE);
+    ~AstArena();
+    void* allocate(size_t size);
+    StringRef copyString(const char* text, size_t length);
+    StringRef copyString(const StringRef& text);
+    StringRef copyString(const std::string& text);
+    Mark mark() const;
+    // Libera los bloques pedidos después de la marca; lo asignado antes de
+    // ella sigue siendo válido.
+    void rewind(const Mark& position);
+    void reset();
+    void release();
+    size_t getChunkCount() const;
+    size_t getAllocationCount() const;
+    size_t getBytesUsed() const;
+};
+}
+#endif
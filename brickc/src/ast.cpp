@@ -1,4 +1,6 @@
 #include "ast.hpp"
+#include <cstdlib>
+#include <new>
 #include <sstream>
 #include <iostream>
 namespace brick {
@@ -7,9 +9,120 @@ std::string Point::toString() const {
     oss << "(" << x << ", " << y << ")";
     return oss.str();
 }
+NodeList::NodeList(AstArena& a) : arena(&a), items(NULL), count(0), capacity(0) {
+}
+void NodeList::push_back(ASTNode* node) {
+    if (count == capacity) {
+        // El bloque anterior queda en el arena; se libera con el resto del árbol.
+        size_t newCapacity = capacity ? capacity * 2 : 4;
+        ASTNode** grown = static_cast<ASTNode**>(arena->allocate(newCapacity * sizeof(ASTNode*)));
+        if (!grown) {
+            return;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            grown[i] = items[i];
+        }
+        items = grown;
+        capacity = newCapacity;
+    }
+    items[count++] = node;
+}
+void NodeList::insert(size_t index, ASTNode* node) {
+    if (index > count) {
+        return;
+    }
+    push_back(node);
+    for (size_t i = count - 1; i > index; --i) {
+        items[i] = items[i - 1];
+    }
+    items[index] = node;
+}
+void NodeList::erase(size_t index, size_t n) {
+    if (index >= count) {
+        return;
+    }
+    if (n > count - index) {
+        n = count - index;
+    }
+    for (size_t i = index + n; i < count; ++i) {
+        items[i - n] = items[i];
+    }
+    count -= n;
+}
+size_t NodeList::indexOf(const ASTNode* node, size_t from) const {
+    for (size_t i = from < count ? from + 1 : count; i > 0; --i) {
+        if (items[i - 1] == node) {
+            return i - 1;
+        }
+    }
+    return count;
+}
+SourceSpan::SourceSpan() : begin(0), end(0), line(0), column(0), endLine(0), endColumn(0) {
+}
+BlockList::BlockList(AstArena& a) : arena(&a), items(NULL), count(0), capacity(0) {
+}
+bool BlockList::reserve(size_t n) {
+    if (n <= capacity) {
+        return true;
+    }
+    size_t newCapacity = capacity ? capacity * 2 : 16;
+    while (newCapacity < n) {
+        newCapacity *= 2;
+    }
+    GameBlock* grown = static_cast<GameBlock*>(arena->allocate(newCapacity * sizeof(GameBlock)));
+    if (!grown) {
+        return false;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        grown[i] = items[i];
+    }
+    items = grown;
+    capacity = newCapacity;
+    return true;
+}
+void BlockList::push_back(const GameBlock& block) {
+    if (reserve(count + 1)) {
+        items[count++] = block;
+    }
+}
+void BlockList::insert(size_t index, const GameBlock& block) {
+    if (index > count || !reserve(count + 1)) {
+        return;
+    }
+    for (size_t i = count; i > index; --i) {
+        items[i] = items[i - 1];
+    }
+    items[index] = block;
+    ++count;
+}
+void BlockList::erase(size_t index, size_t n) {
+    if (index >= count) {
+        return;
+    }
+    if (n > count - index) {
+        n = count - index;
+    }
+    for (size_t i = index + n; i < count; ++i) {
+        items[i - n] = items[i];
+    }
+    count -= n;
+}
 ASTNode::ASTNode(ASTNodeType t, int l, int c) : type(t), line(l), column(c) {
 }
-ASTNode::~ASTNode() {
+// Un nodo nunca recibe NULL: sin memoria se aborta, como en el operator new
+// global (pass_timer.cpp).
+void* ASTNode::operator new(size_t size, AstArena& arena) {
+    void* memory = arena.allocate(size);
+    if (!memory) {
+#ifdef BRICK_EXCEPTIONS
+        throw std::bad_alloc();
+#else
+        std::abort();
+#endif
+    }
+    return memory;
+}
+void ASTNode::operator delete(void*, AstArena&) {
 }
 std::string ASTNode::getTypeName() const {
     return nodeTypeName(type);
@@ -39,36 +152,30 @@ std::string ASTNode::nodeTypeName(ASTNodeType type) {
         case AST_HEXCOLOR: return "HexColor";
         case AST_BOOLEAN: return "Boolean";
         case AST_POINT: return "Point";
+        case AST_CALL_STMT: return "CallStatement";
+        case AST_SET_STMT: return "SetStatement";
+        case AST_SPAWN_STMT: return "SpawnStatement";
+        case AST_REMOVE_STMT: return "RemoveStatement";
+        case AST_PRESS_STMT: return "PressStatement";
+        case AST_RELEASE_STMT: return "ReleaseStatement";
+        case AST_IF_STMT: return "IfStatement";
+        case AST_EVERY_STMT: return "EveryStatement";
+        case AST_ON_STMT: return "OnStatement";
         default: return "Unknown";
     }
 }
-ProgramNode::ProgramNode(const std::string& name, ASTNode* body)
+ProgramNode::ProgramNode(const Symbol& name, ASTNode* body)
     : ASTNode(AST_PROGRAM), gameName(name), gameBody(body) {
 }
-ProgramNode::~ProgramNode() {
-    delete gameBody;
-}
 void ProgramNode::accept(Visitor& visitor) {
     visitor.visitProgram(*this);
 }
 std::string ProgramNode::toString() const {
-    return "Program(" + gameName + ")";
+    return "Program(" + gameName.str() + ")";
 }
-GameNode::GameNode(const std::string& gameName) : ASTNode(AST_GAME), name(gameName) {
-}
-GameNode::~GameNode() {
-    for (size_t i = 0; i < settings.size(); ++i) {
-        delete settings[i];
-    }
-    for (size_t i = 0; i < entities.size(); ++i) {
-        delete entities[i];
-    }
-    for (size_t i = 0; i < controls.size(); ++i) {
-        delete controls[i];
-    }
-    for (size_t i = 0; i < rules.size(); ++i) {
-        delete rules[i];
-    }
+GameNode::GameNode(AstArena& arena, const Symbol& gameName)
+    : ASTNode(AST_GAME), name(gameName), settings(arena), entities(arena), controls(arena), rules(arena),
+      blocks(arena) {
 }
 void GameNode::addSetting(ASTNode* setting) {
     if (setting) {
@@ -90,30 +197,78 @@ void GameNode::addRule(ASTNode* rule) {
         rules.push_back(rule);
     }
 }
+NodeList* GameNode::listFor(const ASTNode* node) {
+    switch (node->type) {
+        case AST_SETTING: return &settings;
+        case AST_ENTITY: return &entities;
+        case AST_RULE: return &rules;
+        default: return &controls;
+    }
+}
+void GameNode::addBlock(ASTNode* node, const SourceSpan& span) {
+    if (!node) {
+        return;
+    }
+    GameBlock block;
+    block.node = node;
+    block.span = span;
+    blocks.push_back(block);
+    listFor(node)->push_back(node);
+}
+void GameNode::replaceBlocks(size_t first, size_t count, const GameBlock* replacement, size_t replacementCount) {
+    bool sameKinds = count == replacementCount;
+    for (size_t i = 0; i < count && sameKinds; ++i) {
+        sameKinds = listFor(blocks[first + i].node) == listFor(replacement[i].node);
+    }
+    // Lo común al editar un bloque: se cambia por otro del mismo tipo y nada
+    // se mueve.
+    if (sameKinds) {
+        for (size_t i = 0; i < count; ++i) {
+            NodeList* list = listFor(blocks[first + i].node);
+            list->set(list->indexOf(blocks[first + i].node, first + i), replacement[i].node);
+            blocks[first + i] = replacement[i];
+        }
+        return;
+    }
+    for (size_t i = first; i < first + count && i < blocks.size(); ++i) {
+        NodeList* list = listFor(blocks[i].node);
+        list->erase(list->indexOf(blocks[i].node, i));
+    }
+    blocks.erase(first, count);
+    for (size_t i = 0; i < replacementCount; ++i) {
+        blocks.insert(first + i, replacement[i]);
+        NodeList* list = listFor(replacement[i].node);
+        list->insert(listPosition(first + i, list), replacement[i].node);
+    }
+}
+// Dónde va blocks[blockIndex] en su lista por tipo: después del bloque
+// anterior más cercano del mismo tipo.
+size_t GameNode::listPosition(size_t blockIndex, NodeList* list) {
+    for (size_t i = blockIndex; i > 0; --i) {
+        ASTNode* node = blocks[i - 1].node;
+        if (listFor(node) == list) {
+            return list->indexOf(node, i - 1) + 1;
+        }
+    }
+    return 0;
+}
 void GameNode::accept(Visitor& visitor) {
     visitor.visitGame(*this);
 }
 std::string GameNode::toString() const {
-    return "Game(" + name + ")";
+    return "Game(" + name.str() + ")";
 }
-SettingNode::SettingNode(const std::string& k, ASTNode* v)
+SettingNode::SettingNode(const Symbol& k, ASTNode* v)
     : ASTNode(AST_SETTING), key(k), value(v) {
 }
-SettingNode::~SettingNode() {
-    delete value;
-}
 void SettingNode::accept(Visitor& visitor) {
     visitor.visitSetting(*this);
 }
 std::string SettingNode::toString() const {
-    return "Setting(" + key + ")";
+    return "Setting(" + key.str() + ")";
 }
-EntityNode::EntityNode(const std::string& entityName) : ASTNode(AST_ENTITY), name(entityName) {
-}
-EntityNode::~EntityNode() {
-    for (size_t i = 0; i < properties.size(); ++i) {
-        delete properties[i];
-    }
+EntityNode::EntityNode(AstArena& arena, const Symbol& entityName)
+    : ASTNode(AST_ENTITY), name(entityName), properties(arena) {
 }
 void EntityNode::addProperty(ASTNode* property) {
     if (property) {
@@ -124,23 +279,19 @@ void EntityNode::accept(Visitor& visitor) {
     visitor.visitEntity(*this);
 }
 std::string EntityNode::toString() const {
-    return "Entity(" + name + ")";
+    return "Entity(" + name.str() + ")";
 }
-ControlNode::ControlNode(const std::string& inp, const std::string& act)
+ControlNode::ControlNode(const Symbol& inp, const Symbol& act)
     : ASTNode(AST_CONTROL), input(inp), action(act) {
 }
 void ControlNode::accept(Visitor& visitor) {
     visitor.visitControl(*this);
 }
 std::string ControlNode::toString() const {
-    return "Control(" + input + " -> " + action + ")";
-}
-RuleNode::RuleNode(const std::string& ruleName) : ASTNode(AST_RULE), name(ruleName) {
+    return "Control(" + input.str() + " -> " + action.str() + ")";
 }
-RuleNode::~RuleNode() {
-    for (size_t i = 0; i < statements.size(); ++i) {
-        delete statements[i];
-    }
+RuleNode::RuleNode(AstArena& arena, const Symbol& ruleName)
+    : ASTNode(AST_RULE), name(ruleName), statements(arena) {
 }
 void RuleNode::addStatement(ASTNode* stmt) {
     if (stmt) {
@@ -151,14 +302,10 @@ void RuleNode::accept(Visitor& visitor) {
     visitor.visitRule(*this);
 }
 std::string RuleNode::toString() const {
-    return "Rule(" + name + ")";
+    return "Rule(" + name.str() + ")";
 }
-TickStmtNode::TickStmtNode(const std::string& act) : ASTNode(AST_TICK_STMT), action(act) {
-}
-TickStmtNode::~TickStmtNode() {
-    for (size_t i = 0; i < args.size(); ++i) {
-        delete args[i];
-    }
+TickStmtNode::TickStmtNode(AstArena& arena, const Symbol& act)
+    : ASTNode(AST_TICK_STMT), action(act), args(arena) {
 }
 void TickStmtNode::addArg(ASTNode* arg) {
     if (arg) {
@@ -169,26 +316,17 @@ void TickStmtNode::accept(Visitor& visitor) {
     visitor.visitTickStmt(*this);
 }
 std::string TickStmtNode::toString() const {
-    return "Tick(" + action + ")";
+    return "Tick(" + action.str() + ")";
 }
-CollideStmtNode::CollideStmtNode(const std::string& e1, const std::string& e2, const std::string& act)
+CollideStmtNode::CollideStmtNode(const Symbol& e1, const Symbol& e2, ASTNode* act)
     : ASTNode(AST_COLLIDE_STMT), entity1(e1), entity2(e2), action(act) {
 }
-CollideStmtNode::~CollideStmtNode() {
-    for (size_t i = 0; i < args.size(); ++i) {
-        delete args[i];
-    }
-}
-void CollideStmtNode::addArg(ASTNode* arg) {
-    if (arg) {
-        args.push_back(arg);
-    }
-}
 void CollideStmtNode::accept(Visitor& visitor) {
     visitor.visitCollideStmt(*this);
 }
 std::string CollideStmtNode::toString() const {
-    return "Collide(" + entity1 + ", " + entity2 + " -> " + action + ")";
+    return "Collide(" + entity1.str() + ", " + entity2.str() + " -> " +
+           (action ? action->toString() : std::string("?")) + ")";
 }
 ScoreStmtNode::ScoreStmtNode(bool positive, int val) : ASTNode(AST_SCORE_STMT), isPositive(positive), value(val) {
 }
@@ -208,13 +346,86 @@ void LoseStmtNode::accept(Visitor& visitor) {
 std::string LoseStmtNode::toString() const {
     return "Lose";
 }
-IdentifierNode::IdentifierNode(const std::string& n) : ASTNode(AST_IDENTIFIER), name(n) {
+CallStmtNode::CallStmtNode(AstArena& arena, const Symbol& callName)
+    : ASTNode(AST_CALL_STMT), name(callName), args(arena) {
+}
+void CallStmtNode::addArg(ASTNode* arg) {
+    if (arg) {
+        args.push_back(arg);
+    }
+}
+void CallStmtNode::accept(Visitor& visitor) {
+    visitor.visitCallStmt(*this);
+}
+std::string CallStmtNode::toString() const {
+    std::ostringstream oss;
+    oss << "Call(" << name.str() << "/" << args.size() << ")";
+    return oss.str();
+}
+SetStmtNode::SetStmtNode(const Symbol& k, char o, ASTNode* v)
+    : ASTNode(AST_SET_STMT), key(k), op(o), value(v) {
+}
+void SetStmtNode::accept(Visitor& visitor) {
+    visitor.visitSetStmt(*this);
+}
+std::string SetStmtNode::toString() const {
+    return "Set(" + key.str() + " " + op + ")";
+}
+EntityStmtNode::EntityStmtNode(ASTNodeType t, const Symbol& e) : ASTNode(t), entity(e) {
+}
+void EntityStmtNode::accept(Visitor& visitor) {
+    visitor.visitEntityStmt(*this);
+}
+std::string EntityStmtNode::toString() const {
+    return (type == AST_SPAWN_STMT ? "Spawn(" : "Remove(") + entity.str() + ")";
+}
+InputStmtNode::InputStmtNode(ASTNodeType t, const Symbol& k, ASTNode* act)
+    : ASTNode(t), key(k), action(act) {
+}
+void InputStmtNode::accept(Visitor& visitor) {
+    visitor.visitInputStmt(*this);
+}
+std::string InputStmtNode::toString() const {
+    return (type == AST_PRESS_STMT ? "Press(" : "Release(") + key.str() + ")";
+}
+IfStmtNode::IfStmtNode(ASTNode* cond, ASTNode* act) : ASTNode(AST_IF_STMT), condition(cond), action(act) {
+}
+void IfStmtNode::accept(Visitor& visitor) {
+    visitor.visitIfStmt(*this);
+}
+std::string IfStmtNode::toString() const {
+    return "If";
+}
+EveryStmtNode::EveryStmtNode(int n) : ASTNode(AST_EVERY_STMT), ticks(n) {
+}
+void EveryStmtNode::accept(Visitor& visitor) {
+    visitor.visitEveryStmt(*this);
+}
+std::string EveryStmtNode::toString() const {
+    std::ostringstream oss;
+    oss << "Every(" << ticks << ")";
+    return oss.str();
+}
+OnStmtNode::OnStmtNode(AstArena& arena, const Symbol& ev) : ASTNode(AST_ON_STMT), event(ev), args(arena) {
+}
+void OnStmtNode::addArg(ASTNode* arg) {
+    if (arg) {
+        args.push_back(arg);
+    }
+}
+void OnStmtNode::accept(Visitor& visitor) {
+    visitor.visitOnStmt(*this);
+}
+std::string OnStmtNode::toString() const {
+    return "On(" + event.str() + ")";
+}
+IdentifierNode::IdentifierNode(const Symbol& n) : ASTNode(AST_IDENTIFIER), name(n) {
 }
 void IdentifierNode::accept(Visitor& visitor) {
     visitor.visitIdentifier(*this);
 }
 std::string IdentifierNode::toString() const {
-    return "Identifier(" + name + ")";
+    return "Identifier(" + name.str() + ")";
 }
 IntegerNode::IntegerNode(int val) : ASTNode(AST_INTEGER), value(val) {
 }
@@ -261,27 +472,20 @@ void PointNode::accept(Visitor& visitor) {
 std::string PointNode::toString() const {
     return "Point" + point.toString();
 }
-BinaryOpNode::BinaryOpNode(const std::string& op, ASTNode* l, ASTNode* r)
+BinaryOpNode::BinaryOpNode(const Symbol& op, ASTNode* l, ASTNode* r)
     : ASTNode(AST_BINARY_OP), operator_(op), left(l), right(r) {
 }
-BinaryOpNode::~BinaryOpNode() {
-    delete left;
-    delete right;
-}
 void BinaryOpNode::accept(Visitor& visitor) {
     visitor.visitBinaryOp(*this);
 }
 std::string BinaryOpNode::toString() const {
-    return "BinaryOp(" + operator_ + ")";
+    return "BinaryOp(" + operator_.str() + ")";
 }
-void printAST(ASTNode* root, int indent) {
+void printAST(ASTNode* root, int indent, std::ostream& out) {
     if (!root) return;
     for (int i = 0; i < indent; ++i) {
-        std::cout << "  ";
+        out << "  ";
     }
-    std::cout << root->toString() << std::endl;
-}
-void deleteAST(ASTNode* root) {
-    delete root;
+    out << root->toString() << std::endl;
 }
 } 
@@ -1,9 +1,11 @@
 #ifndef AST_HPP
 #define AST_HPP
 
+#include "arena.hpp"
+#include "source.hpp"
+#include "string_interner.hpp"
+#include <iostream>
 #include <string>
-#include <vector>
-#include <memory>
 
 namespace brick {
 
@@ -33,7 +35,16 @@ enum ASTNodeType {
     AST_INTEGER,
     AST_HEXCOLOR,
     AST_BOOLEAN,
-    AST_POINT
+    AST_POINT,
+    AST_CALL_STMT,
+    AST_SET_STMT,
+    AST_SPAWN_STMT,
+    AST_REMOVE_STMT,
+    AST_PRESS_STMT,
+    AST_RELEASE_STMT,
+    AST_IF_STMT,
+    AST_EVERY_STMT,
+    AST_ON_STMT
 };
 
 struct Point {
@@ -45,6 +56,75 @@ struct Point {
     std::string toString() const;
 };
 
+// Lista de hijos cuyo almacenamiento vive en el AstArena del nodo.
+class NodeList {
+private:
+    AstArena* arena;
+    ASTNode** items;
+    size_t count;
+    size_t capacity;
+    
+public:
+    explicit NodeList(AstArena& a);
+    
+    void push_back(ASTNode* node);
+    void insert(size_t index, ASTNode* node);
+    void erase(size_t index, size_t n = 1);
+    void set(size_t index, ASTNode* node) { items[index] = node; }
+    // Busca hacia atrás desde 'from': un bloque nunca está en su lista por
+    // tipo más adelante que en GameNode::blocks.
+    size_t indexOf(const ASTNode* node, size_t from) const;
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    ASTNode* operator[](size_t index) const { return items[index]; }
+};
+
+// Rango [begin, end) de un elemento en el texto fuente: begin es el offset de
+// su primer token y end el del final del último. line/column corresponden a
+// begin y endLine/endColumn a end.
+struct SourceSpan {
+    size_t begin;
+    size_t end;
+    int line;
+    int column;
+    int endLine;
+    int endColumn;
+    
+    SourceSpan();
+};
+
+// Elemento de primer nivel del juego (ajuste, entidad, controles o regla).
+struct GameBlock {
+    ASTNode* node;
+    SourceSpan span;
+};
+
+// Como NodeList, pero de GameBlock: los elementos del juego en orden de
+// aparición, para reparsear solo los que toca una edición.
+class BlockList {
+private:
+    AstArena* arena;
+    GameBlock* items;
+    size_t count;
+    size_t capacity;
+    
+    bool reserve(size_t n);
+    
+public:
+    explicit BlockList(AstArena& a);
+    
+    void push_back(const GameBlock& block);
+    void insert(size_t index, const GameBlock& block);
+    void erase(size_t index, size_t n = 1);
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    GameBlock& operator[](size_t index) { return items[index]; }
+    const GameBlock& operator[](size_t index) const { return items[index]; }
+};
+
+// Los nodos se crean siempre con new (arena) y nunca se destruyen uno a uno:
+// sus listas de hijos viven en el mismo AstArena, que libera el árbol completo
+// de una vez. Los nombres son símbolos del StringInterner del parser.
 class ASTNode {
 public:
     ASTNodeType type;
@@ -52,7 +132,9 @@ public:
     int column;
     
     explicit ASTNode(ASTNodeType t, int l = 0, int c = 0);
-    virtual ~ASTNode();
+    
+    static void* operator new(size_t size, AstArena& arena);
+    static void operator delete(void* memory, AstArena& arena);
     
     virtual void accept(Visitor& visitor) = 0;
     
@@ -60,16 +142,20 @@ public:
     virtual std::string toString() const = 0;
     
 protected:
+    ~ASTNode() {}
     static std::string nodeTypeName(ASTNodeType type);
+    
+private:
+    static void* operator new(size_t size);
+    static void operator delete(void* memory);
 };
 
 class ProgramNode : public ASTNode {
 public:
-    std::string gameName;
+    Symbol gameName;
     ASTNode* gameBody;
     
-    ProgramNode(const std::string& name, ASTNode* body);
-    ~ProgramNode();
+    ProgramNode(const Symbol& name, ASTNode* body);
     
     void accept(Visitor& visitor);
     std::string toString() const;
@@ -77,19 +163,33 @@ public:
 
 class GameNode : public ASTNode {
 public:
-    std::string name;
-    std::vector<ASTNode*> settings;
-    std::vector<ASTNode*> entities;
-    std::vector<ASTNode*> controls;
-    std::vector<ASTNode*> rules;
-    
-    explicit GameNode(const std::string& gameName);
-    ~GameNode();
+    Symbol name;
+    NodeList settings;
+    NodeList entities;
+    NodeList controls;
+    NodeList rules;
+    // Los mismos elementos en orden de aparición, con su rango en el fuente.
+    // body va del final de '{' al '}' de cierre (o al fin del archivo).
+    BlockList blocks;
+    SourceSpan body;
+    
+    GameNode(AstArena& arena, const Symbol& gameName);
     
     void addSetting(ASTNode* setting);
     void addEntity(ASTNode* entity);
     void addControl(ASTNode* control);
     void addRule(ASTNode* rule);
+    // Agrega el elemento a blocks y a la lista de su tipo.
+    void addBlock(ASTNode* node, const SourceSpan& span);
+    // Cambia blocks[first, first + count) por 'replacement' y mantiene las
+    // listas por tipo en el mismo orden que blocks.
+    void replaceBlocks(size_t first, size_t count, const GameBlock* replacement, size_t replacementCount);
+    NodeList* listFor(const ASTNode* node);
+    
+private:
+    size_t listPosition(size_t blockIndex, NodeList* list);
+    
+public:
     
     void accept(Visitor& visitor);
     std::string toString() const;
@@ -97,11 +197,10 @@ public:
 
 class SettingNode : public ASTNode {
 public:
-    std::string key;
+    Symbol key;
     ASTNode* value;
     
-    SettingNode(const std::string& k, ASTNode* v);
-    ~SettingNode();
+    SettingNode(const Symbol& k, ASTNode* v);
     
     void accept(Visitor& visitor);
     std::string toString() const;
@@ -109,11 +208,10 @@ public:
 
 class EntityNode : public ASTNode {
 public:
-    std::string name;
-    std::vector<ASTNode*> properties;
+    Symbol name;
+    NodeList properties;
     
-    explicit EntityNode(const std::string& entityName);
-    ~EntityNode();
+    EntityNode(AstArena& arena, const Symbol& entityName);
     
     void addProperty(ASTNode* property);
     
@@ -123,10 +221,10 @@ public:
 
 class ControlNode : public ASTNode {
 public:
-    std::string input;
-    std::string action;
+    Symbol input;
+    Symbol action;
     
-    ControlNode(const std::string& inp, const std::string& act);
+    ControlNode(const Symbol& inp, const Symbol& act);
     
     void accept(Visitor& visitor);
     std::string toString() const;
@@ -134,11 +232,10 @@ public:
 
 class RuleNode : public ASTNode {
 public:
-    std::string name;
-    std::vector<ASTNode*> statements;
+    Symbol name;
+    NodeList statements;
     
-    explicit RuleNode(const std::string& ruleName);
-    ~RuleNode();
+    RuleNode(AstArena& arena, const Symbol& ruleName);
     
     void addStatement(ASTNode* stmt);
     
@@ -148,11 +245,10 @@ public:
 
 class TickStmtNode : public ASTNode {
 public:
-    std::string action;
-    std::vector<ASTNode*> args;
+    Symbol action;
+    NodeList args;
     
-    explicit TickStmtNode(const std::string& act);
-    ~TickStmtNode();
+    TickStmtNode(AstArena& arena, const Symbol& act);
     
     void addArg(ASTNode* arg);
     
@@ -162,15 +258,11 @@ public:
 
 class CollideStmtNode : public ASTNode {
 public:
-    std::string entity1;
-    std::string entity2;
-    std::string action;
-    std::vector<ASTNode*> args;
+    Symbol entity1;
+    Symbol entity2;
+    ASTNode* action;
     
-    CollideStmtNode(const std::string& e1, const std::string& e2, const std::string& act);
-    ~CollideStmtNode();
-    
-    void addArg(ASTNode* arg);
+    CollideStmtNode(const Symbol& e1, const Symbol& e2, ASTNode* act);
     
     void accept(Visitor& visitor);
     std::string toString() const;
@@ -195,11 +287,97 @@ public:
     std::string toString() const;
 };
 
+// Acción del juego: nombre(args) o solo nombre.
+class CallStmtNode : public ASTNode {
+public:
+    Symbol name;
+    NodeList args;
+    
+    CallStmtNode(AstArena& arena, const Symbol& callName);
+    
+    void addArg(ASTNode* arg);
+    
+    void accept(Visitor& visitor);
+    std::string toString() const;
+};
+
+// Asignación a una variable del juego: "lives: +1" (op '+'/'-') o "speed: 14" (op '=').
+class SetStmtNode : public ASTNode {
+public:
+    Symbol key;
+    char op;
+    ASTNode* value;
+    
+    SetStmtNode(const Symbol& k, char o, ASTNode* v);
+    
+    void accept(Visitor& visitor);
+    std::string toString() const;
+};
+
+// "spawn: X" (AST_SPAWN_STMT) o "remove: X" (AST_REMOVE_STMT).
+class EntityStmtNode : public ASTNode {
+public:
+    Symbol entity;
+    
+    EntityStmtNode(ASTNodeType t, const Symbol& e);
+    
+    void accept(Visitor& visitor);
+    std::string toString() const;
+};
+
+// "on press K: acción" (AST_PRESS_STMT) o "on release K: acción" (AST_RELEASE_STMT).
+class InputStmtNode : public ASTNode {
+public:
+    Symbol key;
+    ASTNode* action;
+    
+    InputStmtNode(ASTNodeType t, const Symbol& k, ASTNode* act);
+    
+    void accept(Visitor& visitor);
+    std::string toString() const;
+};
+
+class IfStmtNode : public ASTNode {
+public:
+    ASTNode* condition;
+    ASTNode* action;
+    
+    IfStmtNode(ASTNode* cond, ASTNode* act);
+    
+    void accept(Visitor& visitor);
+    std::string toString() const;
+};
+
+// "every: N ticks": el resto de la regla solo corre uno de cada N ticks.
+class EveryStmtNode : public ASTNode {
+public:
+    int ticks;
+    
+    explicit EveryStmtNode(int n);
+    
+    void accept(Visitor& visitor);
+    std::string toString() const;
+};
+
+// "on: evento(args)": el resto de la regla solo corre si el evento ocurrió.
+class OnStmtNode : public ASTNode {
+public:
+    Symbol event;
+    NodeList args;
+    
+    OnStmtNode(AstArena& arena, const Symbol& ev);
+    
+    void addArg(ASTNode* arg);
+    
+    void accept(Visitor& visitor);
+    std::string toString() const;
+};
+
 class IdentifierNode : public ASTNode {
 public:
-    std::string name;
+    Symbol name;
     
-    explicit IdentifierNode(const std::string& n);
+    explicit IdentifierNode(const Symbol& n);
     
     void accept(Visitor& visitor);
     std::string toString() const;
@@ -252,12 +430,11 @@ public:
 
 class BinaryOpNode : public ASTNode {
 public:
-    std::string operator_;
+    Symbol operator_;
     ASTNode* left;
     ASTNode* right;
     
-    BinaryOpNode(const std::string& op, ASTNode* l, ASTNode* r);
-    ~BinaryOpNode();
+    BinaryOpNode(const Symbol& op, ASTNode* l, ASTNode* r);
     
     void accept(Visitor& visitor);
     std::string toString() const;
@@ -283,10 +460,16 @@ public:
     virtual void visitBoolean(BooleanNode& node) = 0;
     virtual void visitPoint(PointNode& node) = 0;
     virtual void visitBinaryOp(BinaryOpNode& node) = 0;
+    virtual void visitCallStmt(CallStmtNode& node) = 0;
+    virtual void visitSetStmt(SetStmtNode& node) = 0;
+    virtual void visitEntityStmt(EntityStmtNode& node) = 0;
+    virtual void visitInputStmt(InputStmtNode& node) = 0;
+    virtual void visitIfStmt(IfStmtNode& node) = 0;
+    virtual void visitEveryStmt(EveryStmtNode& node) = 0;
+    virtual void visitOnStmt(OnStmtNode& node) = 0;
 };
 
-void printAST(ASTNode* root, int indent = 0);
-void deleteAST(ASTNode* root);
+void printAST(ASTNode* root, int indent = 0, std::ostream& out = std::cout);
 
 } 
 #endif 
@@ -0,0 +1,436 @@
+#include "brick_image.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <map>
+namespace brick {
+namespace {
+enum HeaderField {
+    H_MAGIC = 0,
+    H_VERSION = 4,
+    H_FLAGS = 6,
+    H_FILE_SIZE = 8,
+    H_CHECKSUM = 12,
+    H_SOURCE_HASH = 16,
+    H_SETTINGS = 24,
+    H_SPEED = 28,
+    H_GRID_WIDTH = 32,
+    H_GRID_HEIGHT = 36,
+    H_COLOR = 40,
+    H_LIVES = 44,
+    H_SCORE = 48,
+    H_GAME_NAME = 52,
+    H_SECTIONS = 60
+};
+enum Section {
+    SEC_STRINGS,
+    SEC_SYMBOLS,
+    SEC_ENTITIES,
+    SEC_INDEX,
+    SEC_CONTROLS,
+    SEC_RULES,
+    SEC_CODE,
+    SECTION_COUNT
+};
+enum SettingFlag {
+    HAS_SPEED = 1 << 0,
+    HAS_GRID = 1 << 1,
+    HAS_COLOR = 1 << 2,
+    HAS_LIVES = 1 << 3,
+    HAS_SCORE = 1 << 4
+};
+const size_t HEADER_SIZE = H_SECTIONS + SECTION_COUNT * 8;
+// Bytes por elemento de cada sección (strings y code se miden en bytes).
+const size_t RECORD_SIZE[SECTION_COUNT] = { 1, 8, 24, 4, 16, 20, 1 };
+const char MAGIC[4] = { 'B', 'R', 'K', 'B' };
+uint32_t checksum(const uint8_t* data, size_t size) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < size; ++i) {
+        h ^= data[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+void put32(std::vector<uint8_t>& out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+}
+void set32(std::vector<uint8_t>& out, size_t offset, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        out[offset + i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+}
+// Arma las secciones por separado y las concatena al final.
+class ImageWriter {
+public:
+    std::vector<uint8_t> sections[SECTION_COUNT];
+    std::map<std::string, uint32_t> stringOffsets;
+    std::map<SymbolId, uint32_t> symbolIndex;
+    void putString(std::vector<uint8_t>& out, const std::string& text) {
+        std::map<std::string, uint32_t>::iterator it = stringOffsets.find(text);
+        uint32_t offset;
+        if (it != stringOffsets.end()) {
+            offset = it->second;
+        } else {
+            offset = static_cast<uint32_t>(sections[SEC_STRINGS].size());
+            sections[SEC_STRINGS].insert(sections[SEC_STRINGS].end(), text.begin(), text.end());
+            stringOffsets[text] = offset;
+        }
+        put32(out, offset);
+        put32(out, static_cast<uint32_t>(text.size()));
+    }
+    uint32_t imageSymbol(SymbolId id, const StringInterner& names) {
+        std::map<SymbolId, uint32_t>::iterator it = symbolIndex.find(id);
+        if (it != symbolIndex.end()) {
+            return it->second;
+        }
+        uint32_t index = static_cast<uint32_t>(symbolIndex.size() + 1);
+        symbolIndex[id] = index;
+        putString(sections[SEC_SYMBOLS], names.str(id));
+        return index;
+    }
+};
+}
+BrickImage::BrickImage() : base(NULL) {
+}
+bool BrickImage::fail(const std::string& message) {
+    error = message;
+    base = NULL;
+    buffer.release();
+    return false;
+}
+void BrickImage::close() {
+    base = NULL;
+    buffer.release();
+}
+bool BrickImage::isOpen() const {
+    return base != NULL;
+}
+const std::string& BrickImage::getError() const {
+    return error;
+}
+uint32_t BrickImage::u32(size_t offset) const {
+    const uint8_t* p = base + offset;
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+uint32_t BrickImage::section(int index) const {
+    return u32(H_SECTIONS + index * 8);
+}
+uint32_t BrickImage::sectionCount(int index) const {
+    return u32(H_SECTIONS + index * 8 + 4);
+}
+StringRef BrickImage::stringAt(size_t offset) const {
+    return StringRef(reinterpret_cast<const char*>(base) + section(SEC_STRINGS) + u32(offset), u32(offset + 4));
+}
+bool BrickImage::checkString(size_t offset) const {
+    uint32_t start = u32(offset);
+    uint32_t length = u32(offset + 4);
+    return start <= sectionCount(SEC_STRINGS) && length <= sectionCount(SEC_STRINGS) - start;
+}
+bool BrickImage::open(const std::string& filename) {
+    close();
+    error.clear();
+    if (!buffer.openFile(filename)) {
+        return fail("no se pudo abrir " + filename);
+    }
+    base = reinterpret_cast<const uint8_t*>(buffer.data());
+    size_t size = buffer.size();
+    if (size < HEADER_SIZE || std::memcmp(base, MAGIC, sizeof(MAGIC)) != 0) {
+        return fail("no es una imagen .brickb");
+    }
+    if ((base[H_VERSION] | (base[H_VERSION + 1] << 8)) != VERSION) {
+        return fail("versión de imagen no soportada");
+    }
+    if (u32(H_FILE_SIZE) != size) {
+        return fail("imagen truncada");
+    }
+    if (checksum(base + H_SOURCE_HASH, size - H_SOURCE_HASH) != u32(H_CHECKSUM)) {
+        return fail("checksum incorrecto");
+    }
+    for (int s = 0; s < SECTION_COUNT; ++s) {
+        uint64_t end = static_cast<uint64_t>(section(s)) + static_cast<uint64_t>(sectionCount(s)) * RECORD_SIZE[s];
+        if (section(s) < HEADER_SIZE || end > size) {
+            return fail("sección fuera del archivo");
+        }
+    }
+    bool valid = checkString(H_GAME_NAME);
+    for (uint32_t i = 0; i < sectionCount(SEC_SYMBOLS) && valid; ++i) {
+        valid = checkString(section(SEC_SYMBOLS) + i * RECORD_SIZE[SEC_SYMBOLS]);
+    }
+    for (uint32_t i = 0; i < entityCount() && valid; ++i) {
+        valid = checkString(section(SEC_ENTITIES) + i * RECORD_SIZE[SEC_ENTITIES]);
+    }
+    valid = valid && sectionCount(SEC_INDEX) == entityCount();
+    for (uint32_t i = 0; i < sectionCount(SEC_INDEX) && valid; ++i) {
+        valid = u32(section(SEC_INDEX) + i * 4) < entityCount();
+    }
+    for (uint32_t i = 0; i < controlCount() && valid; ++i) {
+        size_t record = section(SEC_CONTROLS) + i * RECORD_SIZE[SEC_CONTROLS];
+        valid = checkString(record) && checkString(record + 8);
+    }
+    for (uint32_t i = 0; i < ruleCount() && valid; ++i) {
+        size_t record = section(SEC_RULES) + i * RECORD_SIZE[SEC_RULES];
+        uint32_t start = u32(record + 8);
+        uint32_t length = u32(record + 12);
+        valid = checkString(record) && start <= sectionCount(SEC_CODE) &&
+                length <= sectionCount(SEC_CODE) - start;
+    }
+    if (!valid) {
+        return fail("referencia fuera de su sección");
+    }
+    return true;
+}
+uint64_t BrickImage::sourceHash() const {
+    return static_cast<uint64_t>(u32(H_SOURCE_HASH)) | (static_cast<uint64_t>(u32(H_SOURCE_HASH + 4)) << 32);
+}
+StringRef BrickImage::gameName() const {
+    return stringAt(H_GAME_NAME);
+}
+bool BrickImage::hasSpeed() const {
+    return (u32(H_SETTINGS) & HAS_SPEED) != 0;
+}
+bool BrickImage::hasGrid() const {
+    return (u32(H_SETTINGS) & HAS_GRID) != 0;
+}
+bool BrickImage::hasColor() const {
+    return (u32(H_SETTINGS) & HAS_COLOR) != 0;
+}
+bool BrickImage::hasLives() const {
+    return (u32(H_SETTINGS) & HAS_LIVES) != 0;
+}
+bool BrickImage::hasScore() const {
+    return (u32(H_SETTINGS) & HAS_SCORE) != 0;
+}
+int BrickImage::speed() const {
+    return static_cast<int>(u32(H_SPEED));
+}
+int BrickImage::gridWidth() const {
+    return static_cast<int>(u32(H_GRID_WIDTH));
+}
+int BrickImage::gridHeight() const {
+    return static_cast<int>(u32(H_GRID_HEIGHT));
+}
+unsigned int BrickImage::gameColor() const {
+    return u32(H_COLOR);
+}
+int BrickImage::lives() const {
+    return static_cast<int>(u32(H_LIVES));
+}
+int BrickImage::score() const {
+    return static_cast<int>(u32(H_SCORE));
+}
+uint32_t BrickImage::entityCount() const {
+    return sectionCount(SEC_ENTITIES);
+}
+BrickImage::EntityRecord BrickImage::entity(uint32_t i) const {
+    size_t record = section(SEC_ENTITIES) + i * RECORD_SIZE[SEC_ENTITIES];
+    EntityRecord entity;
+    entity.name = stringAt(record);
+    entity.spawn = Point(static_cast<int>(u32(record + 8)), static_cast<int>(u32(record + 12)));
+    entity.color = u32(record + 16);
+    entity.solid = (u32(record + 20) & 1) != 0;
+    return entity;
+}
+int BrickImage::findEntity(const StringRef& name) const {
+    std::string key = name.str();
+    uint32_t low = 0;
+    uint32_t high = sectionCount(SEC_INDEX);
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        uint32_t index = u32(section(SEC_INDEX) + mid * 4);
+        int order = stringAt(section(SEC_ENTITIES) + index * RECORD_SIZE[SEC_ENTITIES]).str().compare(key);
+        if (order == 0) {
+            return static_cast<int>(index);
+        }
+        if (order < 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return -1;
+}
+uint32_t BrickImage::controlCount() const {
+    return sectionCount(SEC_CONTROLS);
+}
+StringRef BrickImage::controlInput(uint32_t i) const {
+    return stringAt(section(SEC_CONTROLS) + i * RECORD_SIZE[SEC_CONTROLS]);
+}
+StringRef BrickImage::controlAction(uint32_t i) const {
+    return stringAt(section(SEC_CONTROLS) + i * RECORD_SIZE[SEC_CONTROLS] + 8);
+}
+uint32_t BrickImage::symbolCount() const {
+    return sectionCount(SEC_SYMBOLS);
+}
+StringRef BrickImage::symbol(uint32_t i) const {
+    return stringAt(section(SEC_SYMBOLS) + i * RECORD_SIZE[SEC_SYMBOLS]);
+}
+uint32_t BrickImage::ruleCount() const {
+    return sectionCount(SEC_RULES);
+}
+BrickImage::RuleRecord BrickImage::rule(uint32_t i) const {
+    size_t record = section(SEC_RULES) + i * RECORD_SIZE[SEC_RULES];
+    RuleRecord rule;
+    rule.name = stringAt(record);
+    rule.code = base + section(SEC_CODE) + u32(record + 8);
+    rule.codeSize = u32(record + 12);
+    rule.maxStack = u32(record + 16);
+    return rule;
+}
+bool BrickImage::populate(SymbolTable& table) const {
+    if (!isOpen()) {
+        return false;
+    }
+    StringInterner& names = *table.getInterner();
+    table.setGameName(gameName().str());
+    if (hasSpeed()) table.setSpeed(speed());
+    if (hasGrid()) table.setGrid(gridWidth(), gridHeight());
+    if (hasColor()) table.setGameColor(gameColor());
+    if (hasLives()) table.setLives(lives());
+    if (hasScore()) table.setScore(score());
+    for (uint32_t i = 0; i < entityCount(); ++i) {
+        EntityRecord record = entity(i);
+        Symbol name = names.symbol(record.name);
+        if (!table.addEntity(name)) {
+            return false;
+        }
+        Entity* target = table.findEntity(name.id);
+        target->setSpawn(record.spawn.x, record.spawn.y);
+        target->setColor(record.color);
+        target->setSolid(record.solid);
+    }
+    for (uint32_t i = 0; i < controlCount(); ++i) {
+        if (!table.addControl(names.symbol(controlInput(i)), names.symbol(controlAction(i)))) {
+            return false;
+        }
+    }
+    std::vector<SymbolId> ids(symbolCount() + 1, NO_SYMBOL);
+    for (uint32_t i = 0; i < symbolCount(); ++i) {
+        ids[i + 1] = names.intern(symbol(i));
+    }
+    std::vector<size_t> operands;
+    for (uint32_t i = 0; i < ruleCount(); ++i) {
+        RuleRecord record = rule(i);
+        Symbol name = names.symbol(record.name);
+        if (!table.addRule(name)) {
+            return false;
+        }
+        Bytecode& code = table.findRule(name.id)->code;
+        code.code.assign(record.code, record.code + record.codeSize);
+        code.maxStack = record.maxStack;
+        if (!symbolOperands(code, operands)) {
+            return false;
+        }
+        for (size_t op = 0; op < operands.size(); ++op) {
+            uint32_t index = code.readU32(operands[op]);
+            if (index == 0 || index >= ids.size()) {
+                return false;
+            }
+            code.writeU32(operands[op], ids[index]);
+        }
+    }
+    return true;
+}
+bool BrickImage::write(const SymbolTable& table, uint64_t sourceHash, const std::string& filename,
+                       std::string* error) {
+    const StringInterner& names = *table.getInterner();
+    ImageWriter writer;
+    std::vector<uint8_t> gameName;
+    writer.putString(gameName, table.getGameName());
+    const std::vector<Entity>& entities = table.getEntities();
+    std::vector<std::pair<std::string, uint32_t> > byName;
+    for (size_t e = 0; e < entities.size(); ++e) {
+        const Entity& entity = entities[e];
+        writer.putString(writer.sections[SEC_ENTITIES], entity.name);
+        put32(writer.sections[SEC_ENTITIES], static_cast<uint32_t>(entity.spawn.x));
+        put32(writer.sections[SEC_ENTITIES], static_cast<uint32_t>(entity.spawn.y));
+        put32(writer.sections[SEC_ENTITIES], entity.color);
+        put32(writer.sections[SEC_ENTITIES], entity.solid ? 1 : 0);
+        byName.push_back(std::make_pair(entity.name, static_cast<uint32_t>(byName.size())));
+    }
+    std::sort(byName.begin(), byName.end());
+    for (size_t i = 0; i < byName.size(); ++i) {
+        put32(writer.sections[SEC_INDEX], byName[i].second);
+    }
+    const std::vector<Control>& controls = table.getControls();
+    for (size_t c = 0; c < controls.size(); ++c) {
+        writer.putString(writer.sections[SEC_CONTROLS], controls[c].input);
+        writer.putString(writer.sections[SEC_CONTROLS], controls[c].action);
+    }
+    const std::vector<Rule>& rules = table.getRules();
+    std::vector<size_t> operands;
+    for (size_t r = 0; r < rules.size(); ++r) {
+        Bytecode code = rules[r].code;
+        if (!symbolOperands(code, operands)) {
+            if (error) *error = "bytecode inválido en la regla " + rules[r].name;
+            return false;
+        }
+        for (size_t op = 0; op < operands.size(); ++op) {
+            code.writeU32(operands[op], writer.imageSymbol(code.readU32(operands[op]), names));
+        }
+        std::vector<uint8_t>& out = writer.sections[SEC_RULES];
+        writer.putString(out, rules[r].name);
+        put32(out, static_cast<uint32_t>(writer.sections[SEC_CODE].size()));
+        put32(out, static_cast<uint32_t>(code.size()));
+        put32(out, code.maxStack);
+        writer.sections[SEC_CODE].insert(writer.sections[SEC_CODE].end(), code.code.begin(), code.code.end());
+    }
+    std::vector<uint8_t> image(HEADER_SIZE, 0);
+    std::copy(MAGIC, MAGIC + sizeof(MAGIC), image.begin());
+    image[H_VERSION] = static_cast<uint8_t>(VERSION);
+    image[H_VERSION + 1] = static_cast<uint8_t>(VERSION >> 8);
+    set32(image, H_SOURCE_HASH, static_cast<uint32_t>(sourceHash));
+    set32(image, H_SOURCE_HASH + 4, static_cast<uint32_t>(sourceHash >> 32));
+    uint32_t settings = (table.hasSpeedSetting() ? HAS_SPEED : 0) | (table.hasGridSetting() ? HAS_GRID : 0) |
+                        (table.hasColorSetting() ? HAS_COLOR : 0) | (table.hasLivesSetting() ? HAS_LIVES : 0) |
+                        (table.hasScoreSetting() ? HAS_SCORE : 0);
+    set32(image, H_SETTINGS, settings);
+    set32(image, H_SPEED, static_cast<uint32_t>(table.getSpeed()));
+    set32(image, H_GRID_WIDTH, static_cast<uint32_t>(table.getGridWidth()));
+    set32(image, H_GRID_HEIGHT, static_cast<uint32_t>(table.getGridHeight()));
+    set32(image, H_COLOR, table.getGameColor());
+    set32(image, H_LIVES, static_cast<uint32_t>(table.getLives()));
+    set32(image, H_SCORE, static_cast<uint32_t>(table.getScore()));
+    std::copy(gameName.begin(), gameName.end(), image.begin() + H_GAME_NAME);
+    for (int s = 0; s < SECTION_COUNT; ++s) {
+        while (image.size() % 4 != 0) {
+            image.push_back(0);
+        }
+        set32(image, H_SECTIONS + s * 8, static_cast<uint32_t>(image.size()));
+        set32(image, H_SECTIONS + s * 8 + 4, static_cast<uint32_t>(writer.sections[s].size() / RECORD_SIZE[s]));
+        image.insert(image.end(), writer.sections[s].begin(), writer.sections[s].end());
+    }
+    set32(image, H_FILE_SIZE, static_cast<uint32_t>(image.size()));
+    set32(image, H_CHECKSUM, checksum(&image[H_SOURCE_HASH], image.size() - H_SOURCE_HASH));
+    FILE* file = std::fopen(filename.c_str(), "wb");
+    if (!file) {
+        if (error) *error = "no se pudo crear " + filename;
+        return false;
+    }
+    bool written = std::fwrite(&image[0], 1, image.size(), file) == image.size();
+    written = std::fclose(file) == 0 && written;
+    if (!written) {
+        std::remove(filename.c_str());
+        if (error) *error = "no se pudo escribir " + filename;
+    }
+    return written;
+}
+uint64_t BrickImage::hashSource(const char* data, size_t size) {
+    uint64_t h = 14695981039346656037ULL;
+    for (size_t i = 0; i < size; ++i) {
+        h ^= static_cast<unsigned char>(data[i]);
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+std::string BrickImage::pathFor(const std::string& sourceFile) {
+    const std::string extension = ".brick";
+    if (sourceFile.size() >= extension.size() &&
+        sourceFile.compare(sourceFile.size() - extension.size(), extension.size(), extension) == 0) {
+        return sourceFile + "b";
+    }
+    return sourceFile + ".brickb";
+}
+}
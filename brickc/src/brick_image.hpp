@@ -0,0 +1,95 @@
+#ifndef BRICK_IMAGE_HPP
+#define BRICK_IMAGE_HPP
+#include "source.hpp"
+#include "symbols.hpp"
+#include <stdint.h>
+#include <string>
+namespace brick {
+// Imagen binaria (.brickb) de una SymbolTable ya validada. Todo va en
+// little-endian y las referencias son desplazamientos, así que los accesores
+// leen los registros directamente del buffer, sin decodificar:
+//   cabecera  "BRKB", versión, tamaño, checksum FNV-1a del resto, hash del
+//             fuente, ajustes del juego y una tabla de secciones
+//   strings   bytes de todos los nombres; se citan como (offset, longitud)
+//   symbols   nombres que usa el bytecode; sus operandos SYM son índices
+//             (desde 1) en esta lista y se reubican al cargar
+//   entities  registros de 24 bytes en el orden de la tabla
+//   index     índices de entidades ordenados por nombre (búsqueda binaria)
+//   controls  registros de 16 bytes
+//   rules     registros de 20 bytes que apuntan a la sección code
+class BrickImage {
+public:
+    struct EntityRecord {
+        StringRef name;
+        Point spawn;
+        unsigned int color;
+        bool solid;
+    };
+    struct RuleRecord {
+        StringRef name;
+        const uint8_t* code;
+        uint32_t codeSize;
+        uint32_t maxStack;
+    };
+    static const uint16_t VERSION = 1;
+    BrickImage();
+    // Lee y comprueba el archivo completo: cabecera, checksum y que toda
+    // referencia caiga dentro de su sección. Sin errores no hace falta volver
+    // a comprobar nada al leer. Se copia a un bloque propio en vez de
+    // mapearlo porque el runtime lo abre mientras brickc puede reescribirlo.
+    bool open(const std::string& filename);
+    void close();
+    bool isOpen() const;
+    const std::string& getError() const;
+    uint64_t sourceHash() const;
+    StringRef gameName() const;
+    bool hasSpeed() const;
+    bool hasGrid() const;
+    bool hasColor() const;
+    bool hasLives() const;
+    bool hasScore() const;
+    int speed() const;
+    int gridWidth() const;
+    int gridHeight() const;
+    unsigned int gameColor() const;
+    int lives() const;
+    int score() const;
+    uint32_t entityCount() const;
+    EntityRecord entity(uint32_t i) const;
+    // Índice de la entidad o -1 si no existe.
+    int findEntity(const StringRef& name) const;
+    uint32_t controlCount() const;
+    StringRef controlInput(uint32_t i) const;
+    StringRef controlAction(uint32_t i) const;
+    uint32_t symbolCount() const;
+    StringRef symbol(uint32_t i) const;
+    uint32_t ruleCount() const;
+    RuleRecord rule(uint32_t i) const;
+    // Llena 'table' sin pasar por el front-end. Los nombres se internan en el
+    // interner de la tabla y el bytecode se reubica a esos ids; después hay
+    // que llamar a table.validate() para verificarlo. BrickLoader carga la
+    // imagen por acá: los juegos y la recarga en caliente trabajan sobre una
+    // SymbolTable, así que la imagen no se sirve como vista. Lo que se ahorra
+    // es lexer, parser y análisis; queda una copia lineal de los registros.
+    bool populate(SymbolTable& table) const;
+    static bool write(const SymbolTable& table, uint64_t sourceHash, const std::string& filename,
+                      std::string* error = NULL);
+    // FNV-1a de 64 bits: decide si la imagen corresponde al fuente actual.
+    static uint64_t hashSource(const char* data, size_t size);
+    // "juego.brick" -> "juego.brickb".
+    static std::string pathFor(const std::string& sourceFile);
+private:
+    SourceBuffer buffer;
+    const uint8_t* base;
+    std::string error;
+    bool fail(const std::string& message);
+    uint32_t u32(size_t offset) const;
+    uint32_t section(int index) const;
+    uint32_t sectionCount(int index) const;
+    StringRef stringAt(size_t offset) const;
+    bool checkString(size_t offset) const;
+    BrickImage(const BrickImage&);
+    BrickImage& operator=(const BrickImage&);
+};
+}
+#endif
@@ -0,0 +1,421 @@
+#include "bytecode.hpp"
+#include <cstdio>
+#include <sstream>
+namespace brick {
+namespace {
+#define BRICK_OPCODE_INFO(op, name, format, pops, pushes) { name, format, pops, pushes },
+const OpInfo OP_TABLE[OP_COUNT] = {
+    BRICK_OPCODES(BRICK_OPCODE_INFO)
+};
+#undef BRICK_OPCODE_INFO
+const size_t MAX_TARGET = 0xFFFF;
+std::string hexOffset(size_t offset) {
+    char text[8];
+    std::snprintf(text, sizeof(text), "%04x", static_cast<unsigned int>(offset));
+    return text;
+}
+std::string symbolText(const StringInterner& names, uint32_t id) {
+    if (id > names.size()) {
+        std::ostringstream oss;
+        oss << "#" << id;
+        return oss.str();
+    }
+    return names.str(id);
+}
+}
+const OpInfo* opInfo(uint8_t op) {
+    return op < OP_COUNT ? &OP_TABLE[op] : NULL;
+}
+size_t instructionSize(OperandFormat format) {
+    switch (format) {
+        case FMT_INT:
+        case FMT_SYM: return 5;
+        case FMT_SYM_SYM: return 9;
+        case FMT_SYM_ARGC: return 6;
+        case FMT_TARGET: return 3;
+        default: return 1;
+    }
+}
+Bytecode::Bytecode() : maxStack(0) {
+}
+bool Bytecode::empty() const {
+    return code.empty();
+}
+size_t Bytecode::size() const {
+    return code.size();
+}
+void Bytecode::clear() {
+    code.clear();
+    maxStack = 0;
+}
+int32_t Bytecode::readInt(size_t offset) const {
+    return static_cast<int32_t>(readU32(offset));
+}
+uint32_t Bytecode::readU32(size_t offset) const {
+    return static_cast<uint32_t>(code[offset]) |
+           (static_cast<uint32_t>(code[offset + 1]) << 8) |
+           (static_cast<uint32_t>(code[offset + 2]) << 16) |
+           (static_cast<uint32_t>(code[offset + 3]) << 24);
+}
+uint16_t Bytecode::readU16(size_t offset) const {
+    return static_cast<uint16_t>(code[offset] | (code[offset + 1] << 8));
+}
+void Bytecode::writeU32(size_t offset, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        code[offset + i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+}
+bool symbolOperands(const Bytecode& code, std::vector<size_t>& offsets) {
+    offsets.clear();
+    for (size_t pc = 0; pc < code.size(); ) {
+        const OpInfo* info = opInfo(code.code[pc]);
+        if (!info || pc + instructionSize(info->format) > code.size()) {
+            return false;
+        }
+        if (info->format == FMT_SYM || info->format == FMT_SYM_ARGC || info->format == FMT_SYM_SYM) {
+            offsets.push_back(pc + 1);
+        }
+        if (info->format == FMT_SYM_SYM) {
+            offsets.push_back(pc + 5);
+        }
+        pc += instructionSize(info->format);
+    }
+    return true;
+}
+RuleCompiler::RuleCompiler(StringInterner& names)
+    : interner(&names), ast(NULL), out(NULL), scoreSymbol(NO_SYMBOL) {
+}
+const std::string& RuleCompiler::getError() const {
+    return error;
+}
+bool RuleCompiler::fail(const std::string& message) {
+    if (error.empty()) {
+        error = message;
+    }
+    return false;
+}
+void RuleCompiler::emitOp(OpCode op) {
+    out->code.push_back(static_cast<uint8_t>(op));
+}
+void RuleCompiler::emitU8(uint8_t value) {
+    out->code.push_back(value);
+}
+void RuleCompiler::emitU16(uint16_t value) {
+    out->code.push_back(static_cast<uint8_t>(value));
+    out->code.push_back(static_cast<uint8_t>(value >> 8));
+}
+void RuleCompiler::emitU32(uint32_t value) {
+    for (int shift = 0; shift < 32; shift += 8) {
+        out->code.push_back(static_cast<uint8_t>(value >> shift));
+    }
+}
+// Emite un salto con destino pendiente y devuelve dónde parchearlo.
+size_t RuleCompiler::emitJump(OpCode op) {
+    emitOp(op);
+    emitU16(0);
+    return out->code.size() - 2;
+}
+bool RuleCompiler::patchJump(size_t at) {
+    size_t target = out->code.size();
+    if (target > MAX_TARGET) {
+        return fail("la regla supera el tamaño máximo de código");
+    }
+    out->code[at] = static_cast<uint8_t>(target);
+    out->code[at + 1] = static_cast<uint8_t>(target >> 8);
+    return true;
+}
+bool RuleCompiler::compile(const FlatAst& tree, NodeIndex rule, Bytecode& code) {
+    ast = &tree;
+    out = &code;
+    error.clear();
+    code.clear();
+    scoreSymbol = interner->intern("score");
+    if (!compileBlock(rule)) {
+        code.clear();
+        return false;
+    }
+    emitOp(OP_END);
+    return true;
+}
+bool RuleCompiler::compileBlock(NodeIndex block) {
+    std::vector<size_t> scopeExits;
+    for (uint32_t i = 0; i < ast->childCount(block); ++i) {
+        if (!compileStatement(ast->child(block, i), scopeExits)) {
+            return false;
+        }
+    }
+    for (size_t i = 0; i < scopeExits.size(); ++i) {
+        if (!patchJump(scopeExits[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+bool RuleCompiler::compileStatement(NodeIndex statement, std::vector<size_t>& scopeExits) {
+    switch (ast->kind(statement)) {
+        case AST_RULE:
+            // Compilada aparte por la SymbolTable como 'padre.hija'.
+            return true;
+        case AST_EVERY_STMT:
+            emitOp(OP_EVERY);
+            emitU32(ast->payload(statement));
+            scopeExits.push_back(emitJump(OP_JUMP_IF_FALSE));
+            return true;
+        case AST_ON_STMT:
+            if (!compileCall(OP_EVENT, statement)) {
+                return false;
+            }
+            scopeExits.push_back(emitJump(OP_JUMP_IF_FALSE));
+            return true;
+        case AST_COLLIDE_STMT:
+            emitOp(OP_COLLIDE);
+            emitU32(ast->operand(statement, 0));
+            emitU32(ast->operand(statement, 1));
+            return ast->childCount(statement) == 1 && compileGuarded(ast->child(statement, 0));
+        case AST_PRESS_STMT:
+        case AST_RELEASE_STMT:
+            emitOp(ast->kind(statement) == AST_PRESS_STMT ? OP_PRESSED : OP_RELEASED);
+            emitU32(ast->payload(statement));
+            return ast->childCount(statement) == 1 && compileGuarded(ast->child(statement, 0));
+        case AST_IF_STMT:
+            if (ast->childCount(statement) != 2 || !compileExpression(ast->child(statement, 0))) {
+                return fail("condición 'if' inválida");
+            }
+            return compileGuarded(ast->child(statement, 1));
+        default:
+            return compileAction(statement);
+    }
+}
+// La condición ya está en la pila: la acción solo corre si es verdadera.
+bool RuleCompiler::compileGuarded(NodeIndex action) {
+    size_t skip = emitJump(OP_JUMP_IF_FALSE);
+    return compileAction(action) && patchJump(skip);
+}
+bool RuleCompiler::compileAction(NodeIndex action) {
+    switch (ast->kind(action)) {
+        case AST_TICK_STMT:
+        case AST_CALL_STMT:
+            return compileCall(OP_CALL, action);
+        case AST_SCORE_STMT: {
+            int32_t value = static_cast<int32_t>(ast->payload(action) >> 1);
+            emitOp(OP_PUSH);
+            emitU32(static_cast<uint32_t>((ast->payload(action) & 1) ? value : -value));
+            emitOp(OP_ADD_VAR);
+            emitU32(scoreSymbol);
+            return true;
+        }
+        case AST_SET_STMT: {
+            if (ast->childCount(action) != 1) {
+                return fail("falta el valor de " + ast->operandSymbol(action, 0).str());
+            }
+            NodeIndex value = ast->child(action, 0);
+            char op = static_cast<char>(ast->operand(action, 1));
+            if (ast->kind(value) == AST_INTEGER) {
+                emitOp(OP_PUSH);
+                emitU32(static_cast<uint32_t>(op == '-' ? -ast->intValue(value) : ast->intValue(value)));
+            } else if (op == '-') {
+                emitOp(OP_PUSH);
+                emitU32(0);
+                if (!compileExpression(value)) {
+                    return false;
+                }
+                emitOp(OP_SUB);
+            } else if (!compileExpression(value)) {
+                return false;
+            }
+            emitOp(op == '=' ? OP_SET_VAR : OP_ADD_VAR);
+            emitU32(ast->operand(action, 0));
+            return true;
+        }
+        case AST_SPAWN_STMT:
+        case AST_REMOVE_STMT:
+            emitOp(ast->kind(action) == AST_SPAWN_STMT ? OP_SPAWN : OP_REMOVE);
+            emitU32(ast->payload(action));
+            return true;
+        case AST_LOSE_STMT:
+            emitOp(OP_LOSE);
+            return true;
+        default:
+            return fail("sentencia no soportada en una regla");
+    }
+}
+// Los argumentos se apilan en orden y la instrucción guarda cuántos son.
+bool RuleCompiler::compileCall(OpCode op, NodeIndex node) {
+    uint32_t argc = ast->childCount(node);
+    if (argc > 0xFF) {
+        return fail("demasiados argumentos para " + ast->name(node).str());
+    }
+    for (uint32_t i = 0; i < argc; ++i) {
+        if (!compileExpression(ast->child(node, i))) {
+            return false;
+        }
+    }
+    emitOp(op);
+    emitU32(ast->payload(node));
+    emitU8(static_cast<uint8_t>(argc));
+    return true;
+}
+bool RuleCompiler::compileExpression(NodeIndex expression) {
+    switch (ast->kind(expression)) {
+        case AST_INTEGER:
+            emitOp(OP_PUSH);
+            emitU32(ast->payload(expression));
+            return true;
+        case AST_IDENTIFIER:
+            emitOp(OP_LOAD);
+            emitU32(ast->payload(expression));
+            return true;
+        case AST_BINARY_OP: {
+            static const struct { const char* text; OpCode op; } OPERATORS[] = {
+                { "+", OP_ADD }, { "-", OP_SUB }, { "*", OP_MUL }, { "/", OP_DIV },
+                { "==", OP_EQ }, { "!=", OP_NE }, { "<", OP_LT }, { ">", OP_GT },
+                { "<=", OP_LE }, { ">=", OP_GE }
+            };
+            if (ast->childCount(expression) != 2 ||
+                !compileExpression(ast->child(expression, 0)) ||
+                !compileExpression(ast->child(expression, 1))) {
+                return false;
+            }
+            StringRef text = ast->name(expression);
+            for (size_t i = 0; i < sizeof(OPERATORS) / sizeof(OPERATORS[0]); ++i) {
+                if (text == OPERATORS[i].text) {
+                    emitOp(OPERATORS[i].op);
+                    return true;
+                }
+            }
+            return fail("operador desconocido: " + text.str());
+        }
+        default:
+            return fail("expresión no soportada en una regla");
+    }
+}
+bool verifyBytecode(const Bytecode& code, size_t symbolCount, std::string* error, uint32_t* maxStack) {
+    std::ostringstream message;
+    size_t size = code.size();
+    std::vector<bool> starts(size, false);
+    for (size_t pc = 0; pc < size; ) {
+        const OpInfo* info = opInfo(code.code[pc]);
+        if (!info) {
+            message << hexOffset(pc) << ": instrucción desconocida " << static_cast<int>(code.code[pc]);
+            break;
+        }
+        if (pc + instructionSize(info->format) > size) {
+            message << hexOffset(pc) << ": operandos truncados en '" << info->name << "'";
+            break;
+        }
+        starts[pc] = true;
+        pc += instructionSize(info->format);
+    }
+    // Profundidad de pila con que llega cada salto; -1 si ninguno llega ahí.
+    std::vector<int> depthAt(size, -1);
+    int depth = 0;
+    int deepest = 0;
+    bool reachable = true;
+    for (size_t pc = 0; pc < size && message.str().empty(); ) {
+        const OpInfo* info = opInfo(code.code[pc]);
+        if (depthAt[pc] >= 0) {
+            if (reachable && depthAt[pc] != depth) {
+                message << hexOffset(pc) << ": la pila llega con profundidades distintas";
+                break;
+            }
+            depth = depthAt[pc];
+            reachable = true;
+        } else if (!reachable) {
+            message << hexOffset(pc) << ": código inalcanzable";
+            break;
+        }
+        if (info->format == FMT_SYM || info->format == FMT_SYM_SYM || info->format == FMT_SYM_ARGC) {
+            int symbols = info->format == FMT_SYM_SYM ? 2 : 1;
+            for (int i = 0; i < symbols; ++i) {
+                uint32_t id = code.readU32(pc + 1 + 4 * i);
+                if (id == NO_SYMBOL || id > symbolCount) {
+                    message << hexOffset(pc) << ": símbolo inválido " << id << " en '" << info->name << "'";
+                }
+            }
+        }
+        if (code.code[pc] == OP_EVERY && code.readInt(pc + 1) <= 0) {
+            message << hexOffset(pc) << ": 'every' necesita un número de ticks positivo";
+            break;
+        }
+        int pops = info->pops == POPS_ARGC ? code.code[pc + 5] : info->pops;
+        if (depth < pops) {
+            message << hexOffset(pc) << ": pila vacía en '" << info->name << "'";
+            break;
+        }
+        depth += info->pushes - pops;
+        if (depth > deepest) {
+            deepest = depth;
+        }
+        if (info->format == FMT_TARGET) {
+            size_t target = code.readU16(pc + 1);
+            if (target <= pc || target >= size || !starts[target]) {
+                message << hexOffset(pc) << ": destino de salto inválido " << hexOffset(target);
+                break;
+            }
+            if (depthAt[target] >= 0 && depthAt[target] != depth) {
+                message << hexOffset(pc) << ": la pila llega con profundidades distintas";
+                break;
+            }
+            depthAt[target] = depth;
+        }
+        if (code.code[pc] == OP_END) {
+            if (depth != 0) {
+                message << hexOffset(pc) << ": la pila no queda vacía al terminar";
+                break;
+            }
+            reachable = false;
+        } else if (code.code[pc] == OP_JUMP) {
+            reachable = false;
+        }
+        pc += instructionSize(info->format);
+    }
+    if (message.str().empty() && reachable) {
+        message << "la regla no termina en 'end'";
+    }
+    if (!message.str().empty()) {
+        if (error) {
+            *error = message.str();
+        }
+        return false;
+    }
+    if (maxStack) {
+        *maxStack = static_cast<uint32_t>(deepest);
+    }
+    return true;
+}
+void disassemble(const Bytecode& code, const StringInterner& names, std::ostream& out) {
+    for (size_t pc = 0; pc < code.size(); ) {
+        const OpInfo* info = opInfo(code.code[pc]);
+        if (!info || pc + instructionSize(info->format) > code.size()) {
+            out << "  " << hexOffset(pc) << "  ?? " << static_cast<int>(code.code[pc]) << "\n";
+            return;
+        }
+        std::string name = info->name;
+        out << "  " << hexOffset(pc) << "  " << name;
+        if (info->format != FMT_NONE) {
+            out << std::string(name.size() < 14 ? 14 - name.size() : 1, ' ');
+        }
+        switch (info->format) {
+            case FMT_INT:
+                out << code.readInt(pc + 1);
+                break;
+            case FMT_SYM:
+                out << symbolText(names, code.readU32(pc + 1));
+                break;
+            case FMT_SYM_SYM:
+                out << symbolText(names, code.readU32(pc + 1)) << ", " << symbolText(names, code.readU32(pc + 5));
+                break;
+            case FMT_SYM_ARGC:
+                out << symbolText(names, code.readU32(pc + 1)) << "/" << static_cast<int>(code.code[pc + 5]);
+                break;
+            case FMT_TARGET:
+                out << hexOffset(code.readU16(pc + 1));
+                break;
+            default:
+                break;
+        }
+        out << "\n";
+        pc += instructionSize(info->format);
+    }
+}
+}
@@ -0,0 +1,127 @@
+#ifndef BYTECODE_HPP
+#define BYTECODE_HPP
+#include "flat_ast.hpp"
+#include "string_interner.hpp"
+#include <stdint.h>
+#include <iostream>
+#include <string>
+#include <vector>
+namespace brick {
+// Formato de los operandos que siguen al byte de la instrucción. Todos se
+// guardan en little-endian: INT es un entero con signo de 32 bits, SYM un
+// SymbolId de 32 bits, ARGC un byte y TARGET un desplazamiento de 16 bits
+// desde el inicio de la regla.
+enum OperandFormat {
+    FMT_NONE,
+    FMT_INT,
+    FMT_SYM,
+    FMT_SYM_SYM,
+    FMT_SYM_ARGC,
+    FMT_TARGET
+};
+// Las instrucciones que sacan tantos valores como indica su ARGC usan POPS_ARGC.
+const int POPS_ARGC = -1;
+// Tabla única de instrucciones: (código, nombre, formato, saca, mete).
+// La usan el compilador, el verificador y el desensamblador.
+#define BRICK_OPCODES(X) \
+    X(OP_END, "end", FMT_NONE, 0, 0) \
+    X(OP_PUSH, "push", FMT_INT, 0, 1) \
+    X(OP_LOAD, "load", FMT_SYM, 0, 1) \
+    X(OP_ADD, "add", FMT_NONE, 2, 1) \
+    X(OP_SUB, "sub", FMT_NONE, 2, 1) \
+    X(OP_MUL, "mul", FMT_NONE, 2, 1) \
+    X(OP_DIV, "div", FMT_NONE, 2, 1) \
+    X(OP_EQ, "eq", FMT_NONE, 2, 1) \
+    X(OP_NE, "ne", FMT_NONE, 2, 1) \
+    X(OP_LT, "lt", FMT_NONE, 2, 1) \
+    X(OP_GT, "gt", FMT_NONE, 2, 1) \
+    X(OP_LE, "le", FMT_NONE, 2, 1) \
+    X(OP_GE, "ge", FMT_NONE, 2, 1) \
+    X(OP_JUMP, "jump", FMT_TARGET, 0, 0) \
+    X(OP_JUMP_IF_FALSE, "jump_if_false", FMT_TARGET, 1, 0) \
+    X(OP_EVERY, "every", FMT_INT, 0, 1) \
+    X(OP_COLLIDE, "collide", FMT_SYM_SYM, 0, 1) \
+    X(OP_PRESSED, "pressed", FMT_SYM, 0, 1) \
+    X(OP_RELEASED, "released", FMT_SYM, 0, 1) \
+    X(OP_EVENT, "event", FMT_SYM_ARGC, POPS_ARGC, 1) \
+    X(OP_CALL, "call", FMT_SYM_ARGC, POPS_ARGC, 0) \
+    X(OP_ADD_VAR, "add_var", FMT_SYM, 1, 0) \
+    X(OP_SET_VAR, "set_var", FMT_SYM, 1, 0) \
+    X(OP_SPAWN, "spawn", FMT_SYM, 0, 0) \
+    X(OP_REMOVE, "remove", FMT_SYM, 0, 0) \
+    X(OP_LOSE, "lose", FMT_NONE, 0, 0)
+#define BRICK_OPCODE_ENUM(op, name, format, pops, pushes) op,
+enum OpCode {
+    BRICK_OPCODES(BRICK_OPCODE_ENUM)
+    OP_COUNT
+};
+#undef BRICK_OPCODE_ENUM
+struct OpInfo {
+    const char* name;
+    OperandFormat format;
+    int pops;
+    int pushes;
+};
+// Devuelve NULL si 'op' no es una instrucción válida.
+const OpInfo* opInfo(uint8_t op);
+// Bytes que ocupa una instrucción con ese formato, incluido el código.
+size_t instructionSize(OperandFormat format);
+// Código de una regla para una máquina de pila. Los saltos solo van hacia
+// adelante, así que cada ejecución de la regla termina en a lo sumo
+// code.size() instrucciones. Los símbolos son ids del interner con el que se
+// compiló. maxStack lo calcula el verificador.
+class Bytecode {
+public:
+    std::vector<uint8_t> code;
+    uint32_t maxStack;
+    Bytecode();
+    bool empty() const;
+    size_t size() const;
+    void clear();
+    int32_t readInt(size_t offset) const;
+    uint32_t readU32(size_t offset) const;
+    uint16_t readU16(size_t offset) const;
+    void writeU32(size_t offset, uint32_t value);
+};
+// Guarda en 'offsets' la posición de cada operando SYM, para reubicar los ids
+// al cambiar de interner. Devuelve false si el código está truncado o tiene
+// instrucciones desconocidas.
+bool symbolOperands(const Bytecode& code, std::vector<size_t>& offsets);
+// Traduce el cuerpo de una regla del AST plano. Las condiciones de
+// 'collide', 'if' y 'on press/release' protegen solo su acción; 'every' y
+// 'on: evento' protegen el resto de la regla. Las reglas anidadas se saltan:
+// la SymbolTable las compila como reglas aparte.
+class RuleCompiler {
+private:
+    StringInterner* interner;
+    const FlatAst* ast;
+    Bytecode* out;
+    std::string error;
+    SymbolId scoreSymbol;
+    void emitOp(OpCode op);
+    void emitU8(uint8_t value);
+    void emitU16(uint16_t value);
+    void emitU32(uint32_t value);
+    size_t emitJump(OpCode op);
+    bool patchJump(size_t at);
+    bool fail(const std::string& message);
+    bool compileBlock(NodeIndex block);
+    bool compileStatement(NodeIndex statement, std::vector<size_t>& scopeExits);
+    bool compileGuarded(NodeIndex action);
+    bool compileAction(NodeIndex action);
+    bool compileCall(OpCode op, NodeIndex node);
+    bool compileExpression(NodeIndex expression);
+public:
+    explicit RuleCompiler(StringInterner& names);
+    bool compile(const FlatAst& tree, NodeIndex rule, Bytecode& code);
+    const std::string& getError() const;
+};
+// Comprueba antes de ejecutar que el código está bien formado: instrucciones
+// y símbolos válidos (0 < id <= symbolCount), 'every' con N > 0, saltos hacia
+// adelante a un inicio de instrucción, pila sin desbordes por abajo, misma
+// profundidad en cada punto de unión y vacía al llegar a OP_END. Guarda la
+// profundidad máxima en *maxStack.
+bool verifyBytecode(const Bytecode& code, size_t symbolCount, std::string* error, uint32_t* maxStack = NULL);
+void disassemble(const Bytecode& code, const StringInterner& names, std::ostream& out = std::cout);
+}
+#endif
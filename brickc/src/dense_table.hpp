@@ -0,0 +1,72 @@
+#ifndef DENSE_TABLE_HPP
+#define DENSE_TABLE_HPP
+#include "string_interner.hpp"
+#include <stdint.h>
+#include <vector>
+namespace brick {
+// Elementos contiguos en orden de inserción, cada uno con una posición densa
+// que no cambia mientras no se borre nada antes. Un índice de
+// direccionamiento abierto (sondeo lineal, a lo sumo medio lleno) lleva del
+// SymbolId del nombre a esa posición. Borrar corre los elementos siguientes
+// y reconstruye el índice: es lineal, pero solo ocurre al editar.
+template <typename T>
+class DenseTable {
+private:
+    std::vector<T> items;
+    std::vector<SymbolId> keys;
+    // Posición + 1; 0 es una ranura libre.
+    std::vector<uint32_t> slots;
+    size_t findSlot(SymbolId key) const {
+        size_t mask = slots.size() - 1;
+        size_t slot = (key * 2654435761u) & mask;
+        while (slots[slot] != 0 && keys[slots[slot] - 1] != key) {
+            slot = (slot + 1) & mask;
+        }
+        return slot;
+    }
+    void rehash(size_t capacity) {
+        slots.assign(capacity, 0);
+        for (size_t i = 0; i < keys.size(); ++i) {
+            slots[findSlot(keys[i])] = static_cast<uint32_t>(i + 1);
+        }
+    }
+public:
+    static const uint32_t NONE = 0xFFFFFFFFu;
+    DenseTable() : slots(16, 0) {}
+    uint32_t find(SymbolId key) const {
+        uint32_t slot = slots[findSlot(key)];
+        return slot ? slot - 1 : NONE;
+    }
+    // La clave no debe estar ya en la tabla.
+    uint32_t insert(SymbolId key, const T& item) {
+        if ((keys.size() + 1) * 2 > slots.size()) {
+            rehash(slots.size() * 2);
+        }
+        items.push_back(item);
+        keys.push_back(key);
+        slots[findSlot(key)] = static_cast<uint32_t>(keys.size());
+        return static_cast<uint32_t>(keys.size() - 1);
+    }
+    bool erase(SymbolId key) {
+        uint32_t index = find(key);
+        if (index == NONE) {
+            return false;
+        }
+        items.erase(items.begin() + index);
+        keys.erase(keys.begin() + index);
+        rehash(slots.size());
+        return true;
+    }
+    T& operator[](uint32_t index) { return items[index]; }
+    const T& operator[](uint32_t index) const { return items[index]; }
+    size_t size() const { return items.size(); }
+    bool empty() const { return items.empty(); }
+    const std::vector<T>& values() const { return items; }
+    void clear() {
+        items.clear();
+        keys.clear();
+        slots.assign(16, 0);
+    }
+};
+}
+#endif
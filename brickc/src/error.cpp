@@ -3,7 +3,89 @@
 #include <sstream>
 #include <cstdarg>
 #include <cstdio>
+#include <cstring>
 namespace brick {
+namespace {
+// Indexada por MessageId; debe seguir el orden del enum.
+const char* const MESSAGES[] = {
+    "%0",
+    "Se omitieron %0 error(es) más",
+    "No se pudo abrir el archivo: %0",
+    "Se esperaba 'game'",
+    "Se esperaba nombre del juego",
+    "Se esperaba '{' después del nombre del juego",
+    "Elemento inesperado en el cuerpo del juego",
+    "Se esperaba '}' al final del juego",
+    "Se esperaba ':' después del nombre de configuración",
+    "Se esperaba '(' para configuración de grilla",
+    "Se esperaba número entero para ancho de grilla",
+    "Se esperaba ',' entre dimensiones de grilla",
+    "Se esperaba número entero para alto de grilla",
+    "Se esperaba ')' al final de configuración de grilla",
+    "Se esperaba número entero para %0",
+    "Color hexadecimal inválido",
+    "Se esperaba color hexadecimal",
+    "Se esperaba ';' al final de configuración",
+    "Se esperaba 'entity'",
+    "Se esperaba nombre de entidad",
+    "Se esperaba '{' después del nombre de entidad",
+    "Se esperaba '}' al final de entidad",
+    "Se esperaba ':' después de propiedad de entidad",
+    "Se esperaba '(' para posición de spawn",
+    "Se esperaba coordenada X para spawn",
+    "Se esperaba ',' entre coordenadas",
+    "Se esperaba coordenada Y para spawn",
+    "Se esperaba ')' al final de spawn",
+    "Se esperaba 'true' o 'false' para solid",
+    "Se esperaba ';' al final de propiedad",
+    "Propiedad de entidad no reconocida",
+    "Se esperaba 'controls'",
+    "Se esperaba '{' después de 'controls'",
+    "Se esperaba '}' al final de controls",
+    "Se esperaba 'rule'",
+    "Se esperaba nombre de regla",
+    "Se esperaba '{' después del nombre de regla",
+    "Se esperaba '}' al final de regla",
+    "Se esperaba ')' al final de la expresión",
+    "Se esperaba número, identificador o '('",
+    "División por cero en expresión constante",
+    "Desbordamiento en expresión constante",
+    "Se esperaba ';' al final de la sentencia",
+    "Se esperaba entidad después de 'spawn:'",
+    "Se esperaba entidad después de 'remove:'",
+    "Se esperaba una acción",
+    "Se esperaba '('",
+    "Se esperaba ')' al final de los argumentos",
+    "Se esperaba 'tick'",
+    "Se esperaba ':' después de 'tick'",
+    "Se esperaba acción después de 'tick:'",
+    "Se esperaba 'collide'",
+    "Se esperaba ':' después de 'collide'",
+    "Se esperaba primera entidad de la colisión",
+    "Se esperaba ',' entre entidades de la colisión",
+    "Se esperaba segunda entidad de la colisión",
+    "Se esperaba ':' antes de la acción de la colisión",
+    "Se esperaba 'score'",
+    "Se esperaba ':' después de 'score'",
+    "Se esperaba número entero para score",
+    "Se esperaba 'lose'",
+    "Se esperaba ':' después de 'every'",
+    "Se esperaba un número de ticks positivo",
+    "Se esperaba 'ticks'",
+    "Se esperaba una tecla",
+    "Se esperaba ':' después de la tecla",
+    "Se esperaba ':', 'press' o 'release' después de 'on'",
+    "Se esperaba nombre de evento",
+    "Se esperaba ':' después de la condición",
+    "Entidad '%0' ya fue definida",
+    "Control '%0' ya fue mapeado",
+    "Regla '%0' ya fue definida",
+    "Regla '%0': %1",
+    "El juego debe tener un nombre",
+    "Regla '%0': bytecode inválido: %1"
+};
+typedef char MessagesMatchEnum[sizeof(MESSAGES) / sizeof(MESSAGES[0]) == MSG_COUNT ? 1 : -1];
+}
 ErrorHandler* g_errorHandler = NULL;
 void setGlobalErrorHandler(ErrorHandler* handler) {
     g_errorHandler = handler;
@@ -11,15 +93,61 @@ void setGlobalErrorHandler(ErrorHandler* handler) {
 ErrorHandler* getGlobalErrorHandler() {
     return g_errorHandler;
 }
+MessageArg::MessageArg() : number(0), isNumber(false) {
+}
+MessageArg::MessageArg(const StringRef& t) : text(t), number(0), isNumber(false) {
+}
+MessageArg::MessageArg(const std::string& t) : text(t.data(), t.size()), number(0), isNumber(false) {
+}
+MessageArg::MessageArg(const char* t) : text(t, std::strlen(t)), number(0), isNumber(false) {
+}
+MessageArg::MessageArg(int n) : number(n), isNumber(true) {
+}
+Error::Error(ErrorType t, int l, int c, MessageId messageId, const MessageArg& first, const MessageArg& second)
+    : type(t), line(l), column(c), id(messageId) {
+    const MessageArg* args[MAX_ARGS] = { &first, &second };
+    for (int i = 0; i < MAX_ARGS; ++i) {
+        if (!args[i]->isNumber && args[i]->text.length > 0) {
+            text[i].assign(args[i]->text.data, args[i]->text.length);
+        }
+        number[i] = args[i]->number;
+        isNumber[i] = args[i]->isNumber;
+    }
+}
 Error::Error(ErrorType t, int l, int c, const std::string& msg, const std::string& file)
-    : type(t), line(l), column(c), message(msg), filename(file) {
+    : type(t), line(l), column(c), id(MSG_TEXT), filename(file) {
+    text[0] = msg;
+    for (int i = 0; i < MAX_ARGS; ++i) {
+        number[i] = 0;
+        isNumber[i] = false;
+    }
+}
+// Reemplaza %0 y %1 de la plantilla por los argumentos.
+std::string Error::message() const {
+    std::string result;
+    for (const char* at = messageText(id); *at; ++at) {
+        if (at[0] == '%' && at[1] >= '0' && at[1] < '0' + MAX_ARGS) {
+            int index = at[1] - '0';
+            if (isNumber[index]) {
+                char buffer[16];
+                std::snprintf(buffer, sizeof(buffer), "%d", number[index]);
+                result += buffer;
+            } else {
+                result += text[index];
+            }
+            ++at;
+        } else {
+            result += *at;
+        }
+    }
+    return result;
 }
 std::string Error::toString() const {
     std::ostringstream oss;
     if (!filename.empty()) {
         oss << filename << ":";
     }
-    oss << "L" << line << ":C" << column << ": " << message;
+    oss << "L" << line << ":C" << column << ": " << message();
     return oss.str();
 }
 std::string Error::getTypeName() const {
@@ -35,11 +163,32 @@ std::string Error::errorTypeName(ErrorType type) {
         default:            return "Error Desconocido";
     }
 }
-ErrorHandler::ErrorHandler() : hasErrors_(false) {
+const char* Error::messageText(MessageId id) {
+    return id >= 0 && id < MSG_COUNT ? MESSAGES[id] : "";
 }
-void ErrorHandler::reportError(ErrorType type, int line, int column, const std::string& message) {
-    errors.push_back(Error(type, line, column, message, currentFile));
+ErrorHandler::ErrorHandler() : hasErrors_(false), maxErrors(DEFAULT_MAX_ERRORS), dropped(0) {
+}
+void ErrorHandler::report(ErrorType type, int line, int column, MessageId id, const MessageArg& first,
+                          const MessageArg& second) {
     hasErrors_ = true;
+    if (errors.size() >= maxErrors) {
+        ++dropped;
+        return;
+    }
+    errors.push_back(Error(type, line, column, id, first, second));
+    errors.back().filename = currentFile;
+}
+void ErrorHandler::reportError(const Error& error) {
+    hasErrors_ = true;
+    if (errors.size() >= maxErrors) {
+        ++dropped;
+        return;
+    }
+    errors.push_back(error);
+    errors.back().filename = currentFile;
+}
+void ErrorHandler::reportError(ErrorType type, int line, int column, const std::string& message) {
+    report(type, line, column, MSG_TEXT, message);
 }
 void ErrorHandler::reportLexicalError(int line, int column, const std::string& message) {
     reportError(ERROR_LEXICAL, line, column, message);
@@ -62,6 +211,18 @@ bool ErrorHandler::hasErrors() const {
 size_t ErrorHandler::getErrorCount() const {
     return errors.size();
 }
+size_t ErrorHandler::getReportedCount() const {
+    return errors.size() + dropped;
+}
+size_t ErrorHandler::getDroppedCount() const {
+    return dropped;
+}
+void ErrorHandler::setMaxErrors(size_t limit) {
+    maxErrors = limit;
+}
+size_t ErrorHandler::getMaxErrors() const {
+    return maxErrors;
+}
 const std::vector<Error>& ErrorHandler::getErrors() const {
     return errors;
 }
@@ -72,13 +233,16 @@ void ErrorHandler::printAll(std::ostream& out) const {
     for (size_t i = 0; i < errors.size(); ++i) {
         out << errors[i].toString() << std::endl;
     }
+    if (dropped > 0) {
+        out << Error(ERROR_SYNTAX, 0, 0, MSG_ERRORS_DROPPED, static_cast<int>(dropped)).message() << std::endl;
+    }
 }
 void ErrorHandler::printSummary(std::ostream& out) const {
-    if (errors.empty()) {
+    if (getReportedCount() == 0) {
         out << "No hay errores." << std::endl;
         return;
     }
-    out << "Total de errores: " << errors.size() << std::endl;
+    out << "Total de errores: " << getReportedCount() << std::endl;
     int lexical = getLexicalErrorCount();
     int syntax = getSyntaxErrorCount();
     int semantic = getSemanticErrorCount();
@@ -89,10 +253,14 @@ void ErrorHandler::printSummary(std::ostream& out) const {
     if (semantic > 0) out << "  Errores semánticos: " << semantic << std::endl;
     if (symbol > 0)  out << "  Errores de símbolos: " << symbol << std::endl;
     if (io > 0)      out << "  Errores de E/S: " << io << std::endl;
+    if (dropped > 0) {
+        out << "  " << Error(ERROR_SYNTAX, 0, 0, MSG_ERRORS_DROPPED, static_cast<int>(dropped)).message() << std::endl;
+    }
 }
 void ErrorHandler::clear() {
     errors.clear();
     hasErrors_ = false;
+    dropped = 0;
 }
 void ErrorHandler::setCurrentFile(const std::string& filename) {
     currentFile = filename;
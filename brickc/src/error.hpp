@@ -1,5 +1,6 @@
 #ifndef ERROR_HPP
 #define ERROR_HPP
+#include "source.hpp"
 #include <string>
 #include <vector>
 #include <iostream>
@@ -11,25 +12,139 @@ enum ErrorType {
     ERROR_SYMBOL,
     ERROR_IO
 };
+// Mensajes de diagnóstico. El texto de cada uno está en la tabla de
+// error.cpp, con %0 y %1 en lugar de sus argumentos: quien reporta pasa solo
+// el id, y el texto se arma recién al imprimir.
+enum MessageId {
+    MSG_TEXT,
+    MSG_ERRORS_DROPPED,
+    MSG_FILE_NOT_OPENED,
+    // Sintácticos
+    MSG_EXPECTED_GAME,
+    MSG_EXPECTED_GAME_NAME,
+    MSG_EXPECTED_GAME_LBRACE,
+    MSG_UNEXPECTED_GAME_ITEM,
+    MSG_EXPECTED_GAME_RBRACE,
+    MSG_EXPECTED_SETTING_COLON,
+    MSG_EXPECTED_GRID_LPAREN,
+    MSG_EXPECTED_GRID_WIDTH,
+    MSG_EXPECTED_GRID_COMMA,
+    MSG_EXPECTED_GRID_HEIGHT,
+    MSG_EXPECTED_GRID_RPAREN,
+    MSG_EXPECTED_INTEGER_FOR,
+    MSG_INVALID_HEX_COLOR,
+    MSG_EXPECTED_HEX_COLOR,
+    MSG_EXPECTED_SETTING_SEMICOLON,
+    MSG_EXPECTED_ENTITY,
+    MSG_EXPECTED_ENTITY_NAME,
+    MSG_EXPECTED_ENTITY_LBRACE,
+    MSG_EXPECTED_ENTITY_RBRACE,
+    MSG_EXPECTED_PROPERTY_COLON,
+    MSG_EXPECTED_SPAWN_LPAREN,
+    MSG_EXPECTED_SPAWN_X,
+    MSG_EXPECTED_SPAWN_COMMA,
+    MSG_EXPECTED_SPAWN_Y,
+    MSG_EXPECTED_SPAWN_RPAREN,
+    MSG_EXPECTED_SOLID_BOOLEAN,
+    MSG_EXPECTED_PROPERTY_SEMICOLON,
+    MSG_UNKNOWN_PROPERTY,
+    MSG_EXPECTED_CONTROLS,
+    MSG_EXPECTED_CONTROLS_LBRACE,
+    MSG_EXPECTED_CONTROLS_RBRACE,
+    MSG_EXPECTED_RULE,
+    MSG_EXPECTED_RULE_NAME,
+    MSG_EXPECTED_RULE_LBRACE,
+    MSG_EXPECTED_RULE_RBRACE,
+    MSG_EXPECTED_EXPRESSION_RPAREN,
+    MSG_EXPECTED_OPERAND,
+    MSG_DIVISION_BY_ZERO,
+    MSG_CONSTANT_OVERFLOW,
+    MSG_EXPECTED_STATEMENT_SEMICOLON,
+    MSG_EXPECTED_SPAWN_ENTITY,
+    MSG_EXPECTED_REMOVE_ENTITY,
+    MSG_EXPECTED_ACTION,
+    MSG_EXPECTED_LPAREN,
+    MSG_EXPECTED_ARGUMENTS_RPAREN,
+    MSG_EXPECTED_TICK,
+    MSG_EXPECTED_TICK_COLON,
+    MSG_EXPECTED_TICK_ACTION,
+    MSG_EXPECTED_COLLIDE,
+    MSG_EXPECTED_COLLIDE_COLON,
+    MSG_EXPECTED_COLLIDE_FIRST,
+    MSG_EXPECTED_COLLIDE_COMMA,
+    MSG_EXPECTED_COLLIDE_SECOND,
+    MSG_EXPECTED_COLLIDE_ACTION_COLON,
+    MSG_EXPECTED_SCORE,
+    MSG_EXPECTED_SCORE_COLON,
+    MSG_EXPECTED_SCORE_INTEGER,
+    MSG_EXPECTED_LOSE,
+    MSG_EXPECTED_EVERY_COLON,
+    MSG_EXPECTED_POSITIVE_TICKS,
+    MSG_EXPECTED_TICKS,
+    MSG_EXPECTED_KEY,
+    MSG_EXPECTED_KEY_COLON,
+    MSG_EXPECTED_ON_COLON,
+    MSG_EXPECTED_EVENT_NAME,
+    MSG_EXPECTED_CONDITION_COLON,
+    // Semánticos
+    MSG_ENTITY_REDEFINED,
+    MSG_CONTROL_REDEFINED,
+    MSG_RULE_REDEFINED,
+    MSG_RULE_NOT_COMPILED,
+    MSG_GAME_WITHOUT_NAME,
+    MSG_RULE_INVALID_BYTECODE,
+    MSG_COUNT
+};
+// Argumento de un mensaje: texto o entero. No copia el texto, así que un
+// diagnóstico que no llega a reportarse no reserva memoria.
+class MessageArg {
+public:
+    StringRef text;
+    int number;
+    bool isNumber;
+    MessageArg();
+    MessageArg(const StringRef& t);
+    MessageArg(const std::string& t);
+    MessageArg(const char* t);
+    MessageArg(int n);
+};
 class Error {
 public:
+    static const int MAX_ARGS = 2;
     ErrorType type;
     int line;
     int column;
-    std::string message;
+    MessageId id;
+    // Copia de los argumentos; los enteros se convierten al imprimir.
+    std::string text[MAX_ARGS];
+    int number[MAX_ARGS];
+    bool isNumber[MAX_ARGS];
     std::string filename;
+    Error(ErrorType t, int l, int c, MessageId messageId, const MessageArg& first = MessageArg(),
+          const MessageArg& second = MessageArg());
     Error(ErrorType t, int l, int c, const std::string& msg, const std::string& file = "");
+    std::string message() const;
     std::string toString() const;
     std::string getTypeName() const;
     static std::string errorTypeName(ErrorType type);
+    static const char* messageText(MessageId id);
 };
+// Guarda hasta getMaxErrors() errores; los siguientes solo se cuentan, para
+// que una entrada desbocada no ocupe memoria sin límite.
 class ErrorHandler {
 private:
     std::vector<Error> errors;
     bool hasErrors_;
+    size_t maxErrors;
+    size_t dropped;
     std::string currentFile;
 public:
+    static const size_t DEFAULT_MAX_ERRORS = 256;
     ErrorHandler();
+    void report(ErrorType type, int line, int column, MessageId id, const MessageArg& first = MessageArg(),
+                const MessageArg& second = MessageArg());
+    // Vuelve a reportar un error ya armado (con el archivo actual).
+    void reportError(const Error& error);
     void reportError(ErrorType type, int line, int column, const std::string& message);
     void reportLexicalError(int line, int column, const std::string& message);
     void reportSyntaxError(int line, int column, const std::string& message);
@@ -37,7 +152,12 @@ public:
     void reportSymbolError(int line, int column, const std::string& message);
     void reportIOError(const std::string& message);
     bool hasErrors() const;
+    // Errores guardados; getReportedCount() suma los descartados por el tope.
     size_t getErrorCount() const;
+    size_t getReportedCount() const;
+    size_t getDroppedCount() const;
+    void setMaxErrors(size_t limit);
+    size_t getMaxErrors() const;
     const std::vector<Error>& getErrors() const;
     const Error& getError(size_t index) const;
     void printAll(std::ostream& out = std::cerr) const;
@@ -0,0 +1,307 @@
+#include "flat_ast.hpp"
+namespace brick {
+FlatAst::FlatAst() : names(&StringInterner::global()) {
+}
+void FlatAst::clear() {
+    kinds.clear();
+    firstChildren.clear();
+    childCounts.clear();
+    payloads.clear();
+    points.clear();
+    operands.clear();
+    pendingBlocks.clear();
+}
+bool FlatAst::build(const ASTNode* rootNode, const StringInterner& interner) {
+    clear();
+    names = &interner;
+    if (!rootNode) {
+        return false;
+    }
+    NodeIndex first;
+    uint32_t count;
+    addNode(rootNode);
+    addDescendants(rootNode, &first, &count);
+    firstChildren[0] = first;
+    childCounts[0] = count;
+    return true;
+}
+void FlatAst::addDescendants(const ASTNode* node, NodeIndex* first, uint32_t* count) {
+    std::vector<const ASTNode*> order;
+    std::vector<const ASTNode*> children;
+    NodeIndex base = static_cast<NodeIndex>(kinds.size());
+    collectChildren(node, order);
+    for (size_t c = 0; c < order.size(); ++c) {
+        addNode(order[c]);
+    }
+    *first = base;
+    *count = static_cast<uint32_t>(order.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        children.clear();
+        collectChildren(order[i], children);
+        firstChildren[base + i] = static_cast<NodeIndex>(base + order.size());
+        childCounts[base + i] = static_cast<uint32_t>(children.size());
+        for (size_t c = 0; c < children.size(); ++c) {
+            order.push_back(children[c]);
+            addNode(children[c]);
+        }
+    }
+}
+void FlatAst::beginGame(const Symbol& gameName, const StringInterner& interner) {
+    clear();
+    names = &interner;
+    addRecord(AST_PROGRAM, gameName.id);
+    addRecord(AST_GAME, gameName.id);
+    firstChildren[0] = 1;
+    childCounts[0] = 1;
+}
+void FlatAst::addBlock(const ASTNode* block) {
+    PendingBlock pending;
+    pending.kind = static_cast<unsigned char>(block->type);
+    pending.payload = payloadOf(block);
+    addDescendants(block, &pending.firstChild, &pending.childCount);
+    pendingBlocks.push_back(pending);
+}
+void FlatAst::finishGame() {
+    // Los mismos grupos que GameNode::listFor().
+    const int SETTINGS = 0, ENTITIES = 1, CONTROLS = 2, RULES = 3;
+    firstChildren[1] = static_cast<NodeIndex>(kinds.size());
+    childCounts[1] = static_cast<uint32_t>(pendingBlocks.size());
+    for (int group = SETTINGS; group <= RULES; ++group) {
+        for (size_t i = 0; i < pendingBlocks.size(); ++i) {
+            const PendingBlock& pending = pendingBlocks[i];
+            int blockGroup = pending.kind == AST_SETTING ? SETTINGS :
+                             pending.kind == AST_ENTITY ? ENTITIES :
+                             pending.kind == AST_RULE ? RULES : CONTROLS;
+            if (blockGroup == group) {
+                NodeIndex index = addRecord(pending.kind, pending.payload);
+                firstChildren[index] = pending.firstChild;
+                childCounts[index] = pending.childCount;
+            }
+        }
+    }
+    pendingBlocks.clear();
+}
+void FlatAst::collectChildren(const ASTNode* node, std::vector<const ASTNode*>& out) const {
+    const NodeList* lists[4] = { NULL, NULL, NULL, NULL };
+    switch (node->type) {
+        case AST_PROGRAM:
+            if (static_cast<const ProgramNode*>(node)->gameBody) {
+                out.push_back(static_cast<const ProgramNode*>(node)->gameBody);
+            }
+            return;
+        case AST_SETTING:
+            if (static_cast<const SettingNode*>(node)->value) {
+                out.push_back(static_cast<const SettingNode*>(node)->value);
+            }
+            return;
+        case AST_SET_STMT:
+            if (static_cast<const SetStmtNode*>(node)->value) {
+                out.push_back(static_cast<const SetStmtNode*>(node)->value);
+            }
+            return;
+        case AST_COLLIDE_STMT:
+            if (static_cast<const CollideStmtNode*>(node)->action) {
+                out.push_back(static_cast<const CollideStmtNode*>(node)->action);
+            }
+            return;
+        case AST_PRESS_STMT:
+        case AST_RELEASE_STMT:
+            if (static_cast<const InputStmtNode*>(node)->action) {
+                out.push_back(static_cast<const InputStmtNode*>(node)->action);
+            }
+            return;
+        case AST_IF_STMT: {
+            const IfStmtNode* ifNode = static_cast<const IfStmtNode*>(node);
+            if (ifNode->condition) out.push_back(ifNode->condition);
+            if (ifNode->action) out.push_back(ifNode->action);
+            return;
+        }
+        case AST_BINARY_OP: {
+            const BinaryOpNode* op = static_cast<const BinaryOpNode*>(node);
+            if (op->left) out.push_back(op->left);
+            if (op->right) out.push_back(op->right);
+            return;
+        }
+        case AST_GAME: {
+            const GameNode* game = static_cast<const GameNode*>(node);
+            lists[0] = &game->settings;
+            lists[1] = &game->entities;
+            lists[2] = &game->controls;
+            lists[3] = &game->rules;
+            break;
+        }
+        case AST_ENTITY:
+            lists[0] = &static_cast<const EntityNode*>(node)->properties;
+            break;
+        case AST_RULE:
+            lists[0] = &static_cast<const RuleNode*>(node)->statements;
+            break;
+        case AST_TICK_STMT:
+            lists[0] = &static_cast<const TickStmtNode*>(node)->args;
+            break;
+        case AST_CALL_STMT:
+            lists[0] = &static_cast<const CallStmtNode*>(node)->args;
+            break;
+        case AST_ON_STMT:
+            lists[0] = &static_cast<const OnStmtNode*>(node)->args;
+            break;
+        default:
+            return;
+    }
+    for (size_t l = 0; l < 4 && lists[l]; ++l) {
+        for (size_t i = 0; i < lists[l]->size(); ++i) {
+            out.push_back((*lists[l])[i]);
+        }
+    }
+}
+uint32_t FlatAst::payloadOf(const ASTNode* node) {
+    uint32_t value = 0;
+    switch (node->type) {
+        case AST_PROGRAM:
+            value = static_cast<const ProgramNode*>(node)->gameName.id;
+            break;
+        case AST_GAME:
+            value = static_cast<const GameNode*>(node)->name.id;
+            break;
+        case AST_SETTING:
+            value = static_cast<const SettingNode*>(node)->key.id;
+            break;
+        case AST_ENTITY:
+            value = static_cast<const EntityNode*>(node)->name.id;
+            break;
+        case AST_RULE:
+            value = static_cast<const RuleNode*>(node)->name.id;
+            break;
+        case AST_IDENTIFIER:
+            value = static_cast<const IdentifierNode*>(node)->name.id;
+            break;
+        case AST_TICK_STMT:
+            value = static_cast<const TickStmtNode*>(node)->action.id;
+            break;
+        case AST_BINARY_OP:
+            value = static_cast<const BinaryOpNode*>(node)->operator_.id;
+            break;
+        case AST_CONTROL: {
+            const ControlNode* control = static_cast<const ControlNode*>(node);
+            value = static_cast<uint32_t>(operands.size());
+            operands.push_back(control->input.id);
+            operands.push_back(control->action.id);
+            break;
+        }
+        case AST_COLLIDE_STMT: {
+            const CollideStmtNode* collide = static_cast<const CollideStmtNode*>(node);
+            value = static_cast<uint32_t>(operands.size());
+            operands.push_back(collide->entity1.id);
+            operands.push_back(collide->entity2.id);
+            break;
+        }
+        case AST_SET_STMT: {
+            const SetStmtNode* set = static_cast<const SetStmtNode*>(node);
+            value = static_cast<uint32_t>(operands.size());
+            operands.push_back(set->key.id);
+            operands.push_back(static_cast<unsigned char>(set->op));
+            break;
+        }
+        case AST_CALL_STMT:
+            value = static_cast<const CallStmtNode*>(node)->name.id;
+            break;
+        case AST_SPAWN_STMT:
+        case AST_REMOVE_STMT:
+            value = static_cast<const EntityStmtNode*>(node)->entity.id;
+            break;
+        case AST_PRESS_STMT:
+        case AST_RELEASE_STMT:
+            value = static_cast<const InputStmtNode*>(node)->key.id;
+            break;
+        case AST_ON_STMT:
+            value = static_cast<const OnStmtNode*>(node)->event.id;
+            break;
+        case AST_EVERY_STMT:
+            value = static_cast<uint32_t>(static_cast<const EveryStmtNode*>(node)->ticks);
+            break;
+        case AST_INTEGER:
+            value = static_cast<uint32_t>(static_cast<const IntegerNode*>(node)->value);
+            break;
+        case AST_HEXCOLOR:
+            value = static_cast<const HexColorNode*>(node)->color;
+            break;
+        case AST_BOOLEAN:
+            value = static_cast<const BooleanNode*>(node)->value ? 1 : 0;
+            break;
+        case AST_POINT:
+            value = static_cast<uint32_t>(points.size());
+            points.push_back(static_cast<const PointNode*>(node)->point);
+            break;
+        case AST_SCORE_STMT: {
+            const ScoreStmtNode* score = static_cast<const ScoreStmtNode*>(node);
+            value = (static_cast<uint32_t>(score->value) << 1) | (score->isPositive ? 1 : 0);
+            break;
+        }
+        default:
+            break;
+    }
+    return value;
+}
+NodeIndex FlatAst::addRecord(unsigned char kind, uint32_t payload) {
+    kinds.push_back(kind);
+    firstChildren.push_back(INVALID_NODE);
+    childCounts.push_back(0);
+    payloads.push_back(payload);
+    return static_cast<NodeIndex>(kinds.size() - 1);
+}
+NodeIndex FlatAst::addNode(const ASTNode* node) {
+    uint32_t value = payloadOf(node);
+    return addRecord(static_cast<unsigned char>(node->type), value);
+}
+size_t FlatAst::nodeCount() const {
+    return kinds.size();
+}
+size_t FlatAst::memoryUsage() const {
+    return kinds.capacity() * sizeof(unsigned char) +
+           firstChildren.capacity() * sizeof(NodeIndex) +
+           childCounts.capacity() * sizeof(uint32_t) +
+           payloads.capacity() * sizeof(uint32_t) +
+           points.capacity() * sizeof(Point) +
+           operands.capacity() * sizeof(SymbolId);
+}
+NodeIndex FlatAst::root() const {
+    return kinds.empty() ? INVALID_NODE : 0;
+}
+ASTNodeType FlatAst::kind(NodeIndex node) const {
+    return static_cast<ASTNodeType>(kinds[node]);
+}
+uint32_t FlatAst::childCount(NodeIndex node) const {
+    return childCounts[node];
+}
+NodeIndex FlatAst::child(NodeIndex node, uint32_t i) const {
+    return firstChildren[node] + i;
+}
+uint32_t FlatAst::payload(NodeIndex node) const {
+    return payloads[node];
+}
+Symbol FlatAst::symbol(NodeIndex node) const {
+    return Symbol(payloads[node], names->text(payloads[node]));
+}
+uint32_t FlatAst::operand(NodeIndex node, uint32_t i) const {
+    return operands[payloads[node] + i];
+}
+Symbol FlatAst::operandSymbol(NodeIndex node, uint32_t i) const {
+    SymbolId id = operands[payloads[node] + i];
+    return Symbol(id, names->text(id));
+}
+StringRef FlatAst::name(NodeIndex node) const {
+    return names->text(payloads[node]);
+}
+int FlatAst::intValue(NodeIndex node) const {
+    if (kind(node) == AST_SCORE_STMT) {
+        return static_cast<int>(payloads[node] >> 1);
+    }
+    return static_cast<int>(payloads[node]);
+}
+bool FlatAst::boolValue(NodeIndex node) const {
+    return (payloads[node] & 1) != 0;
+}
+const Point& FlatAst::point(NodeIndex node) const {
+    return points[payloads[node]];
+}
+}
@@ -0,0 +1,74 @@
+#ifndef FLAT_AST_HPP
+#define FLAT_AST_HPP
+#include "ast.hpp"
+#include "source.hpp"
+#include "string_interner.hpp"
+#include <stdint.h>
+#include <vector>
+namespace brick {
+typedef uint32_t NodeIndex;
+const NodeIndex INVALID_NODE = 0xFFFFFFFFu;
+// AST plano: los nodos viven en arreglos paralelos y se referencian por
+// índice de 32 bits. Se recorre el árbol por niveles al construirlo, así que
+// los hijos de cada nodo quedan contiguos en [firstChild, firstChild + count).
+// El dato de cada nodo (payload) depende de su tipo:
+//   Program, Game, Entity, Rule, Setting, Identifier, Tick, BinaryOp, Call,
+//   Spawn, Remove, Press, Release, On -> SymbolId
+//   Control -> posición en la lista de operandos: entrada, acción
+//   Collide -> posición en la lista de operandos: entidad 1, entidad 2
+//   Set -> posición en la lista de operandos: clave, operador ('+', '-', '=')
+//   Integer -> valor; HexColor -> color; Boolean -> 0/1; Every -> ticks
+//   Point -> índice en la tabla de puntos
+//   Score -> (valor << 1) | positivo
+// Al construirlo por bloques (beginGame/addBlock/finishGame) cada bloque deja
+// sus descendientes por niveles y su propio nodo espera al final, para que los
+// hijos del juego queden contiguos.
+class FlatAst {
+private:
+    struct PendingBlock {
+        unsigned char kind;
+        uint32_t payload;
+        NodeIndex firstChild;
+        uint32_t childCount;
+    };
+    std::vector<unsigned char> kinds;
+    std::vector<NodeIndex> firstChildren;
+    std::vector<uint32_t> childCounts;
+    std::vector<uint32_t> payloads;
+    std::vector<Point> points;
+    std::vector<uint32_t> operands;
+    std::vector<PendingBlock> pendingBlocks;
+    const StringInterner* names;
+    uint32_t payloadOf(const ASTNode* node);
+    NodeIndex addRecord(unsigned char kind, uint32_t payload);
+    NodeIndex addNode(const ASTNode* node);
+    void addDescendants(const ASTNode* node, NodeIndex* first, uint32_t* count);
+    void collectChildren(const ASTNode* node, std::vector<const ASTNode*>& out) const;
+public:
+    FlatAst();
+    // 'interner' es el que usó el parser y debe vivir tanto como el FlatAst.
+    bool build(const ASTNode* root, const StringInterner& interner);
+    // Program y Game sin el árbol de punteros: addBlock() copia el bloque, que
+    // puede liberarse enseguida, y finishGame() agrega los nodos de bloque en
+    // el orden de GameNode (settings, entities, controls, rules).
+    void beginGame(const Symbol& gameName, const StringInterner& interner);
+    void addBlock(const ASTNode* block);
+    void finishGame();
+    void clear();
+    size_t nodeCount() const;
+    size_t memoryUsage() const;
+    NodeIndex root() const;
+    ASTNodeType kind(NodeIndex node) const;
+    uint32_t childCount(NodeIndex node) const;
+    NodeIndex child(NodeIndex node, uint32_t i) const;
+    uint32_t payload(NodeIndex node) const;
+    Symbol symbol(NodeIndex node) const;
+    uint32_t operand(NodeIndex node, uint32_t i) const;
+    Symbol operandSymbol(NodeIndex node, uint32_t i) const;
+    StringRef name(NodeIndex node) const;
+    int intValue(NodeIndex node) const;
+    bool boolValue(NodeIndex node) const;
+    const Point& point(NodeIndex node) const;
+};
+}
+#endif
@@ -0,0 +1,490 @@
+#include "incremental.hpp"
+#include "flat_ast.hpp"
+#include "lexer.hpp"
+#include <algorithm>
+namespace brick {
+namespace {
+// Posición en la que termina 'text' si empieza en (*line, *column); cuenta
+// igual que el Lexer (un byte, una columna).
+void advancePosition(const std::string& text, int* line, int* column) {
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (text[i] == '\n') {
+            ++*line;
+            *column = 1;
+        } else {
+            ++*column;
+        }
+    }
+}
+// La primera línea de 'text' no tiene tokens, así que el bloque siguiente no
+// empieza en la misma línea en la que termina el anterior.
+bool firstLineBlank(const std::string& text) {
+    for (size_t i = 0; i < text.size() && text[i] != '\n'; ++i) {
+        if (!(charClass(text[i]) & CHAR_SPACE)) {
+            return false;
+        }
+    }
+    return true;
+}
+const size_t NO_BLOCK = static_cast<size_t>(-1);
+SymbolId blockName(const ASTNode* node) {
+    if (node->type == AST_ENTITY) {
+        return static_cast<const EntityNode*>(node)->name.id;
+    }
+    if (node->type == AST_RULE) {
+        return static_cast<const RuleNode*>(node)->name.id;
+    }
+    return NO_SYMBOL;
+}
+}
+IncrementalDocument::IncrementalDocument(StringInterner* interner)
+    : names(interner ? interner : &ownNames), program(NULL), game(NULL),
+      table(NULL, interner ? interner : &ownNames), tailLine(0), length(0), errorCount(0),
+      staleBytes(0), reparsedBlocks(0), fullReparses(0) {
+}
+IncrementalDocument::~IncrementalDocument() {
+    reset();
+}
+void IncrementalDocument::reset() {
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        delete chunks[i];
+    }
+    chunks.clear();
+    header.clear();
+    tail.clear();
+    headerErrors.clear();
+    tailErrors.clear();
+    entityDefinitions.clear();
+    ruleDefinitions.clear();
+    duplicatedEntities.clear();
+    duplicatedRules.clear();
+    table.clear();
+    program = NULL;
+    game = NULL;
+    length = 0;
+    errorCount = 0;
+    staleBytes = 0;
+    arena.reset();
+}
+void IncrementalDocument::load(const std::string& source) {
+    reparseAll(source);
+}
+void IncrementalDocument::reparseAll(const std::string& source) {
+    reset();
+    ++fullReparses;
+    length = source.size();
+    Lexer lexer;
+    lexer.setInterner(names);
+    lexer.init(source);
+    ErrorHandler errors;
+    Parser parser(&lexer, &errors, &arena);
+    game = parser.parseGameHeader();
+    headerErrors = errors.getErrors();
+    errorCount = headerErrors.size();
+    if (!game) {
+        header = source;
+        reparsedBlocks = 0;
+        return;
+    }
+    header = source.substr(0, game->body.begin);
+    std::vector<GameBlock> blocks;
+    Rest rest;
+    parseItems(lexer, parser, errors, source, 0, game->body.begin, blocks, chunks, rest);
+    program = parser.finishGame(game);
+    tail = source.substr(rest.begin);
+    tailErrors.assign(errors.getErrors().begin() + rest.firstError, errors.getErrors().end());
+    tailLine = game->body.endLine;
+    errorCount += tailErrors.size();
+    table.setGameName(game->name.str());
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        game->addBlock(blocks[i].node, blocks[i].span);
+        errorCount += chunks[i]->errors.size();
+        ASTNode* node = blocks[i].node;
+        SymbolId name = blockName(node);
+        if (node->type == AST_SETTING) {
+            define(i);
+        } else if (name != NO_SYMBOL) {
+            bool entity = node->type == AST_ENTITY;
+            int& count = (entity ? entityDefinitions : ruleDefinitions)[name];
+            if (count++ == 0) {
+                define(i);
+            } else {
+                (entity ? duplicatedEntities : duplicatedRules).insert(name);
+            }
+        }
+    }
+    reparsedBlocks = blocks.size();
+}
+// Parsea elementos del cuerpo hasta '}' o el fin de 'source' (que empieza en
+// el offset 'origin' del documento). Cada bloque se lleva el texto desde el
+// final del anterior ('from' para el primero) y los errores reportados desde
+// entonces, incluidos los de elementos que no produjeron nodo.
+void IncrementalDocument::parseItems(Lexer& lexer, Parser& parser, ErrorHandler& errors, const std::string& source,
+                                     size_t origin, size_t from, std::vector<GameBlock>& blocks,
+                                     std::vector<Chunk*>& pieces, Rest& rest) {
+    size_t chunkBegin = from;
+    size_t firstError = errors.getErrorCount();
+    size_t bytes = arena.getBytesUsed();
+    rest.hasItems = false;
+    while (!parser.atGameEnd()) {
+        GameBlock block;
+        block.node = parser.parseGameItem(&block.span);
+        if (!block.node) {
+            rest.hasItems = true;
+            continue;
+        }
+        Chunk* chunk = new Chunk();
+        chunk->text = source.substr(chunkBegin - origin, block.span.end - chunkBegin);
+        chunk->errors.assign(errors.getErrors().begin() + firstError, errors.getErrors().end());
+        chunk->parsedLine = block.span.line;
+        chunk->lookahead = lexer.position() - block.span.end;
+        chunk->arenaBytes = arena.getBytesUsed() - bytes;
+        blocks.push_back(block);
+        pieces.push_back(chunk);
+        chunkBegin = block.span.end;
+        firstError = errors.getErrorCount();
+        bytes = arena.getBytesUsed();
+        rest.hasItems = false;
+    }
+    rest.begin = chunkBegin;
+    rest.firstError = firstError;
+}
+// Primer trozo cuyo rango cerrado [inicio, fin] contiene 'offset'; el del
+// final (tras el último bloque) tiene índice blocks.size().
+size_t IncrementalDocument::chunkAt(size_t offset) const {
+    size_t low = 0;
+    size_t high = game->blocks.size();
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        if (game->blocks[middle].span.end < offset) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+// Primer bloque cuyo parseo miró 'offset' (el texto o lo escaneado después).
+size_t IncrementalDocument::firstAffected(size_t offset) const {
+    size_t low = 0;
+    size_t high = game->blocks.size();
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        if (game->blocks[middle].span.end + chunks[middle]->lookahead < offset) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+void IncrementalDocument::chunkStart(size_t index, SourceSpan* start) const {
+    if (index == 0) {
+        start->begin = game->body.begin;
+        start->line = game->body.line;
+        start->column = game->body.column;
+    } else {
+        const SourceSpan& previous = game->blocks[index - 1].span;
+        start->begin = previous.end;
+        start->line = previous.endLine;
+        start->column = previous.endColumn;
+    }
+}
+std::string IncrementalDocument::regionText(size_t first, size_t last) const {
+    std::string text;
+    for (size_t i = first; i <= last && i < chunks.size(); ++i) {
+        text += chunks[i]->text;
+    }
+    if (last == chunks.size()) {
+        text += tail;
+    }
+    return text;
+}
+bool IncrementalDocument::edit(size_t begin, size_t end, const std::string& replacement) {
+    if (end > length) end = length;
+    if (begin > end) begin = end;
+    // Un error en el encabezado puede depender del primer bloque.
+    if (!game || !headerErrors.empty() || begin < game->body.begin || staleBytes * 2 > arena.getBytesUsed()) {
+        std::string source = text();
+        reparseAll(source.replace(begin, end - begin, replacement));
+        return false;
+    }
+    size_t n = game->blocks.size();
+    size_t first = firstAffected(begin);
+    size_t last = chunkAt(end);
+    SourceSpan start;
+    chunkStart(first, &start);
+    std::string oldText;
+    std::string newText;
+    std::vector<GameBlock> blocks;
+    std::vector<Chunk*> pieces;
+    Rest rest;
+    ErrorHandler errors;
+    bool full = false;
+    while (true) {
+        // El bloque siguiente debe empezar en otra línea (las columnas no se
+        // corren) y no puede ser un ajuste (la recuperación de errores de la
+        // región podría tragárselo).
+        if (last < n) {
+            const std::string& next = last + 1 < n ? chunks[last + 1]->text : tail;
+            if (!firstLineBlank(next) || (last + 1 < n && game->blocks[last + 1].node->type == AST_SETTING)) {
+                ++last;
+                continue;
+            }
+        }
+        for (size_t i = first; i <= last && i < n && !full; ++i) {
+            full = game->blocks[i].node->type == AST_SETTING;
+        }
+        if (full) {
+            break;
+        }
+        oldText = regionText(first, last);
+        newText = oldText.substr(0, begin - start.begin) + replacement + oldText.substr(end - start.begin);
+        Lexer lexer;
+        lexer.setInterner(names);
+        lexer.init(newText, start.begin, start.line, start.column);
+        errors.clear();
+        Parser parser(&lexer, &errors, &arena);
+        size_t bytes = arena.getBytesUsed();
+        parseItems(lexer, parser, errors, newText, start.begin, start.begin, blocks, pieces, rest);
+        for (size_t i = 0; i < blocks.size() && !full; ++i) {
+            full = blocks[i].node->type == AST_SETTING;
+        }
+        bool extend = false;
+        if (last == n) {
+            parser.finishGame(game);
+        } else if (parser.currentToken().type != T_EOF) {
+            // Una '}' de más: cambió dónde termina el juego.
+            full = true;
+        } else if (rest.hasItems) {
+            extend = true;
+        } else {
+            // Un error en el fin de la región quiere decir que al último
+            // bloque le falta texto que está en el trozo siguiente.
+            const Token& eof = parser.currentToken();
+            for (size_t i = 0; i < errors.getErrorCount() && !extend; ++i) {
+                extend = errors.getError(i).line == eof.line && errors.getError(i).column == eof.column;
+            }
+        }
+        if (!full && !extend) {
+            break;
+        }
+        staleBytes += arena.getBytesUsed() - bytes;
+        for (size_t i = 0; i < pieces.size(); ++i) {
+            delete pieces[i];
+        }
+        pieces.clear();
+        blocks.clear();
+        if (full) {
+            break;
+        }
+        ++last;
+    }
+    if (full) {
+        std::string source = text();
+        reparseAll(source.replace(begin, end - begin, replacement));
+        return false;
+    }
+    // Empalmar: sale [first, removedEnd), entran los bloques nuevos.
+    size_t removedEnd = last < n ? last + 1 : n;
+    int oldEndLine = last < n ? game->blocks[last].span.endLine : 0;
+    std::map<std::pair<int, SymbolId>, size_t> touched;
+    for (size_t i = first; i < removedEnd; ++i) {
+        ASTNode* node = game->blocks[i].node;
+        SymbolId name = blockName(node);
+        if (name != NO_SYMBOL) {
+            --(node->type == AST_ENTITY ? entityDefinitions : ruleDefinitions)[name];
+            touched.insert(std::make_pair(std::make_pair(static_cast<int>(node->type), name), NO_BLOCK));
+        }
+        staleBytes += chunks[i]->arenaBytes;
+        errorCount -= chunks[i]->errors.size() + chunks[i]->semanticErrors.size();
+        delete chunks[i];
+    }
+    if (removedEnd - first == pieces.size()) {
+        std::copy(pieces.begin(), pieces.end(), chunks.begin() + first);
+    } else {
+        chunks.erase(chunks.begin() + first, chunks.begin() + removedEnd);
+        chunks.insert(chunks.begin() + first, pieces.begin(), pieces.end());
+    }
+    game->replaceBlocks(first, removedEnd - first, blocks.empty() ? NULL : &blocks[0], blocks.size());
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        errorCount += pieces[i]->errors.size();
+        SymbolId name = blockName(blocks[i].node);
+        if (name != NO_SYMBOL) {
+            ++(blocks[i].node->type == AST_ENTITY ? entityDefinitions : ruleDefinitions)[name];
+            touched[std::make_pair(static_cast<int>(blocks[i].node->type), name)] = first + i;
+        }
+    }
+    if (last == n) {
+        errorCount -= tailErrors.size();
+        tail = newText.substr(rest.begin - start.begin);
+        tailErrors.assign(errors.getErrors().begin() + rest.firstError, errors.getErrors().end());
+        tailLine = game->body.endLine;
+        errorCount += tailErrors.size();
+    } else {
+        // La trivia después del último bloque nuevo pasa al trozo siguiente;
+        // lo que sigue a la región se corre en bytes y en líneas.
+        size_t next = first + blocks.size();
+        std::string trailing = newText.substr(rest.begin - start.begin);
+        if (next < chunks.size()) {
+            chunks[next]->text.insert(0, trailing);
+        } else {
+            tail.insert(0, trailing);
+        }
+        int endLine = start.line;
+        int endColumn = start.column;
+        advancePosition(newText, &endLine, &endColumn);
+        long byteDelta = static_cast<long>(newText.size()) - static_cast<long>(oldText.size());
+        int lineDelta = endLine - oldEndLine;
+        for (size_t i = next; i < game->blocks.size(); ++i) {
+            SourceSpan& span = game->blocks[i].span;
+            span.begin += byteDelta;
+            span.end += byteDelta;
+            span.line += lineDelta;
+            span.endLine += lineDelta;
+        }
+        game->body.end += byteDelta;
+        game->body.endLine += lineDelta;
+    }
+    length = length - (end - begin) + replacement.size();
+    for (std::map<std::pair<int, SymbolId>, size_t>::iterator it = touched.begin(); it != touched.end(); ++it) {
+        resolve(static_cast<ASTNodeType>(it->first.first), it->first.second, it->second);
+    }
+    reparsedBlocks = blocks.size();
+    return true;
+}
+// Carga el bloque 'index' en la tabla; los errores de compilar la regla
+// quedan en su trozo.
+void IncrementalDocument::define(size_t index) {
+    FlatAst flat;
+    flat.build(game->blocks[index].node, *names);
+    ErrorHandler errors;
+    table.setErrorHandler(&errors);
+    table.defineBlock(flat, flat.root());
+    table.setErrorHandler(NULL);
+    setSemanticErrors(chunks[index], errors.getErrors());
+}
+void IncrementalDocument::setSemanticErrors(Chunk* chunk, const std::vector<Error>& errors) {
+    errorCount -= chunk->semanticErrors.size();
+    chunk->semanticErrors = errors;
+    errorCount += errors.size();
+}
+// Deja en la tabla la primera definición de 'id' en el texto. 'hint' es el
+// bloque que la define si se sabe (uno recién parseado); si no, o si hay
+// duplicados, se busca recorriendo los bloques.
+void IncrementalDocument::resolve(ASTNodeType kind, SymbolId id, size_t hint) {
+    std::map<SymbolId, int>& definitions = kind == AST_ENTITY ? entityDefinitions : ruleDefinitions;
+    std::set<SymbolId>& duplicated = kind == AST_ENTITY ? duplicatedEntities : duplicatedRules;
+    int count = definitions[id];
+    if (count <= 0) {
+        definitions.erase(id);
+        duplicated.erase(id);
+        if (kind == AST_ENTITY) {
+            table.removeEntity(id);
+        } else {
+            table.removeRule(id);
+        }
+        return;
+    }
+    if (count == 1) {
+        duplicated.erase(id);
+        if (hint < game->blocks.size()) {
+            define(hint);
+            return;
+        }
+    } else {
+        duplicated.insert(id);
+    }
+    bool defined = false;
+    for (size_t i = 0; i < game->blocks.size(); ++i) {
+        const ASTNode* node = game->blocks[i].node;
+        if (node->type != kind || blockName(node) != id) {
+            continue;
+        }
+        if (!defined) {
+            define(i);
+            defined = true;
+        } else {
+            setSemanticErrors(chunks[i], std::vector<Error>());
+        }
+    }
+}
+std::string IncrementalDocument::text() const {
+    std::string source;
+    source.reserve(length);
+    source += header;
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        source += chunks[i]->text;
+    }
+    source += tail;
+    return source;
+}
+size_t IncrementalDocument::size() const {
+    return length;
+}
+ASTNode* IncrementalDocument::getProgram() const {
+    return program;
+}
+GameNode* IncrementalDocument::getGame() const {
+    return game;
+}
+const SymbolTable& IncrementalDocument::getSymbols() const {
+    return table;
+}
+StringInterner* IncrementalDocument::getInterner() const {
+    return names;
+}
+bool IncrementalDocument::hasErrors() const {
+    return getErrorCount() > 0;
+}
+size_t IncrementalDocument::getErrorCount() const {
+    size_t count = errorCount;
+    for (std::set<SymbolId>::const_iterator it = duplicatedEntities.begin(); it != duplicatedEntities.end(); ++it) {
+        count += entityDefinitions.find(*it)->second - 1;
+    }
+    for (std::set<SymbolId>::const_iterator it = duplicatedRules.begin(); it != duplicatedRules.end(); ++it) {
+        count += ruleDefinitions.find(*it)->second - 1;
+    }
+    return count;
+}
+void IncrementalDocument::report(ErrorHandler& out, const std::vector<Error>& errors, int lineShift) const {
+    for (size_t i = 0; i < errors.size(); ++i) {
+        Error error = errors[i];
+        if (error.line) {
+            error.line += lineShift;
+        }
+        out.reportError(error);
+    }
+}
+void IncrementalDocument::diagnostics(ErrorHandler& out) const {
+    report(out, headerErrors, 0);
+    if (!game) {
+        return;
+    }
+    // Si ningún bloque tiene errores no hace falta recorrerlos.
+    bool blockErrors = errorCount > headerErrors.size() + tailErrors.size();
+    for (size_t i = 0; blockErrors && i < chunks.size(); ++i) {
+        report(out, chunks[i]->errors, game->blocks[i].span.line - chunks[i]->parsedLine);
+    }
+    report(out, tailErrors, game->body.endLine - tailLine);
+    for (size_t i = 0; blockErrors && i < chunks.size(); ++i) {
+        report(out, chunks[i]->semanticErrors, 0);
+    }
+    for (std::set<SymbolId>::const_iterator it = duplicatedEntities.begin(); it != duplicatedEntities.end(); ++it) {
+        for (int i = 1; i < entityDefinitions.find(*it)->second; ++i) {
+            out.report(ERROR_SEMANTIC, 0, 0, MSG_ENTITY_REDEFINED, names->text(*it));
+        }
+    }
+    for (std::set<SymbolId>::const_iterator it = duplicatedRules.begin(); it != duplicatedRules.end(); ++it) {
+        for (int i = 1; i < ruleDefinitions.find(*it)->second; ++i) {
+            out.report(ERROR_SEMANTIC, 0, 0, MSG_RULE_REDEFINED, names->text(*it));
+        }
+    }
+}
+size_t IncrementalDocument::getReparsedBlocks() const {
+    return reparsedBlocks;
+}
+size_t IncrementalDocument::getFullReparses() const {
+    return fullReparses;
+}
+}
@@ -0,0 +1,104 @@
+#ifndef INCREMENTAL_HPP
+#define INCREMENTAL_HPP
+#include "arena.hpp"
+#include "ast.hpp"
+#include "error.hpp"
+#include "parser.hpp"
+#include "string_interner.hpp"
+#include "symbols.hpp"
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+namespace brick {
+// Programa abierto en un editor. El texto se guarda partido en los bloques de
+// primer nivel del GameNode (cada uno con la trivia que lo precede); ante una
+// edición se vuelven a lexear y parsear solo los bloques que toca, se
+// empalman en el árbol y la tabla de símbolos se actualiza nombre por nombre.
+// El costo de una edición depende de los bloques editados y no del archivo,
+// salvo un recorrido de enteros para correr los rangos que siguen al cambio.
+// Se reparsea el archivo entero si la edición toca el encabezado 'game' o un
+// ajuste, si cambia el anidamiento de llaves del juego, o cuando los nodos
+// descartados ya ocupan la mitad del arena.
+class IncrementalDocument {
+private:
+    // Texto [fin del bloque anterior, fin de este bloque) y sus errores. Los
+    // sintácticos conservan la línea que tenían al parsear (parsedLine es la
+    // del bloque en ese momento); al listarlos se corren lo que se corrió el
+    // bloque. Los semánticos (compilar la regla) no tienen posición.
+    // lookahead es cuántos bytes después del bloque llegó a escanear el
+    // lexer mientras se parseaba: editarlos también obliga a reparsearlo.
+    struct Chunk {
+        std::string text;
+        std::vector<Error> errors;
+        std::vector<Error> semanticErrors;
+        int parsedLine;
+        size_t lookahead;
+        size_t arenaBytes;
+    };
+    // Lo que queda después del último bloque de un parseo.
+    struct Rest {
+        size_t begin;
+        size_t firstError;
+        bool hasItems;
+    };
+    StringInterner ownNames;
+    StringInterner* names;
+    AstArena arena;
+    ASTNode* program;
+    GameNode* game;
+    SymbolTable table;
+    std::string header;
+    std::vector<Chunk*> chunks;
+    std::string tail;
+    std::vector<Error> headerErrors;
+    std::vector<Error> tailErrors;
+    int tailLine;
+    // Cuántos bloques definen cada nombre; más de uno es un duplicado.
+    std::map<SymbolId, int> entityDefinitions;
+    std::map<SymbolId, int> ruleDefinitions;
+    std::set<SymbolId> duplicatedEntities;
+    std::set<SymbolId> duplicatedRules;
+    size_t length;
+    size_t errorCount;
+    size_t staleBytes;
+    size_t reparsedBlocks;
+    size_t fullReparses;
+    IncrementalDocument(const IncrementalDocument&);
+    IncrementalDocument& operator=(const IncrementalDocument&);
+    void reset();
+    void reparseAll(const std::string& source);
+    void parseItems(Lexer& lexer, Parser& parser, ErrorHandler& errors, const std::string& source, size_t origin,
+                    size_t from, std::vector<GameBlock>& blocks, std::vector<Chunk*>& pieces, Rest& rest);
+    size_t chunkAt(size_t offset) const;
+    size_t firstAffected(size_t offset) const;
+    void chunkStart(size_t index, SourceSpan* start) const;
+    std::string regionText(size_t first, size_t last) const;
+    void define(size_t index);
+    void setSemanticErrors(Chunk* chunk, const std::vector<Error>& errors);
+    void resolve(ASTNodeType kind, SymbolId id, size_t hint);
+    void report(ErrorHandler& out, const std::vector<Error>& errors, int lineShift) const;
+public:
+    // Sin 'interner' el documento usa uno propio.
+    explicit IncrementalDocument(StringInterner* interner = NULL);
+    ~IncrementalDocument();
+    void load(const std::string& source);
+    // Reemplaza los bytes [begin, end) del texto por 'text'. Devuelve false si
+    // hubo que reparsear el archivo entero.
+    bool edit(size_t begin, size_t end, const std::string& text);
+    std::string text() const;
+    size_t size() const;
+    ASTNode* getProgram() const;
+    GameNode* getGame() const;
+    const SymbolTable& getSymbols() const;
+    StringInterner* getInterner() const;
+    bool hasErrors() const;
+    size_t getErrorCount() const;
+    // Diagnósticos actuales: primero los sintácticos en orden de aparición,
+    // después los semánticos.
+    void diagnostics(ErrorHandler& out) const;
+    size_t getReparsedBlocks() const;
+    size_t getFullReparses() const;
+};
+}
+#endif
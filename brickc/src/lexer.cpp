@@ -1,176 +1,294 @@
 #include "lexer.hpp"
 #include "util.hpp"
-#include <cctype>
 #include <cstdlib>
+#include <climits>
+#include <cstring>
+#include <cstdio>
 namespace brick {
-Token::Token() : type(T_EOF), line(0), column(0) {
+namespace {
+// Hash perfecto sobre (segunda letra, última letra, longitud) para las
+// palabras de BRICK_KEYWORDS: cada una cae en una ranura distinta de 32.
+const size_t KEYWORD_MIN_LENGTH = 4;
+const size_t KEYWORD_MAX_LENGTH = 8;
+const size_t KEYWORD_SLOTS = 32;
+inline size_t keywordHash(const char* text, size_t length) {
+    return (static_cast<unsigned char>(text[1]) +
+            static_cast<unsigned char>(text[length - 1]) * 8 + length * 5) & (KEYWORD_SLOTS - 1);
 }
-Token::Token(TokenType t, const std::string& lex, int l, int c)
-    : type(t), lexeme(lex), line(l), column(c) {
+struct KeywordSlot {
+    const char* text;
+    size_t length;
+    TokenType type;
+};
+class KeywordTable {
+public:
+    KeywordSlot slots[KEYWORD_SLOTS];
+    KeywordTable() {
+        for (size_t i = 0; i < KEYWORD_SLOTS; ++i) {
+            slots[i].text = "";
+            slots[i].length = 0;
+            slots[i].type = T_IDENT;
+        }
+#define BRICK_KEYWORD_SLOT(type, text, name) insert(type, text, sizeof(text) - 1);
+        BRICK_KEYWORDS(BRICK_KEYWORD_SLOT)
+#undef BRICK_KEYWORD_SLOT
+    }
+private:
+    void insert(TokenType type, const char* text, size_t length) {
+        // Se comprueba también con NDEBUG: una palabra clave que choca con otra
+        // dejaría de reconocerse sin ningún aviso.
+        KeywordSlot& slot = slots[keywordHash(text, length)];
+        if (slot.length != 0 || length < KEYWORD_MIN_LENGTH || length > KEYWORD_MAX_LENGTH) {
+            std::fprintf(stderr, "brickc: la palabra clave '%s' no cabe en la tabla de palabras clave\n", text);
+            std::abort();
+        }
+        slot.text = text;
+        slot.length = length;
+        slot.type = type;
+    }
+};
+const KeywordTable keywordTable;
+}
+// Clases de carácter precalculadas (sin locale) para los bucles del lexer.
+#define BRICK_CC_SPACE(c) ((c) == ' ' || (c) == '\t' || (c) == '\n' || (c) == '\v' || (c) == '\f' || (c) == '\r')
+#define BRICK_CC_ALPHA(c) (((c) >= 'a' && (c) <= 'z') || ((c) >= 'A' && (c) <= 'Z'))
+#define BRICK_CC_DIGIT(c) ((c) >= '0' && (c) <= '9')
+#define BRICK_CC_HEX(c) (BRICK_CC_DIGIT(c) || ((c) >= 'a' && (c) <= 'f') || ((c) >= 'A' && (c) <= 'F'))
+#define BRICK_CC_OPERATOR(c) ((c) == '{' || (c) == '}' || (c) == '(' || (c) == ')' || (c) == ':' || \
+    (c) == ';' || (c) == ',' || (c) == '=' || (c) == '+' || (c) == '-' || (c) == '*' || (c) == '/' || \
+    (c) == '<' || (c) == '>' || (c) == '!')
+#define BRICK_CC(c) static_cast<unsigned char>( \
+    (BRICK_CC_SPACE(c) ? CHAR_SPACE : 0) | \
+    (BRICK_CC_ALPHA(c) ? CHAR_ALPHA : 0) | \
+    (BRICK_CC_ALPHA(c) || (c) == '_' ? CHAR_IDENT_START : 0) | \
+    (BRICK_CC_ALPHA(c) || BRICK_CC_DIGIT(c) || (c) == '_' ? CHAR_IDENT_CONT : 0) | \
+    (BRICK_CC_DIGIT(c) ? CHAR_DIGIT : 0) | \
+    (BRICK_CC_HEX(c) ? CHAR_HEX : 0) | \
+    (BRICK_CC_OPERATOR(c) ? CHAR_OPERATOR : 0))
+#define BRICK_CC4(c) BRICK_CC(c), BRICK_CC(c + 1), BRICK_CC(c + 2), BRICK_CC(c + 3)
+#define BRICK_CC16(c) BRICK_CC4(c), BRICK_CC4(c + 4), BRICK_CC4(c + 8), BRICK_CC4(c + 12)
+#define BRICK_CC64(c) BRICK_CC16(c), BRICK_CC16(c + 16), BRICK_CC16(c + 32), BRICK_CC16(c + 48)
+const unsigned char CHAR_CLASS_TABLE[256] = {
+    BRICK_CC64(0), BRICK_CC64(64), BRICK_CC64(128), BRICK_CC64(192)
+};
+#undef BRICK_CC64
+#undef BRICK_CC16
+#undef BRICK_CC4
+#undef BRICK_CC
+#undef BRICK_CC_OPERATOR
+#undef BRICK_CC_HEX
+#undef BRICK_CC_DIGIT
+#undef BRICK_CC_ALPHA
+#undef BRICK_CC_SPACE
+Token::Token() : type(T_EOF), symbol(NO_SYMBOL), offset(0), line(0), column(0) {
+}
+Token::Token(TokenType t, const StringRef& lex, size_t off, int l, int c)
+    : type(t), lexeme(lex), symbol(NO_SYMBOL), offset(off), line(l), column(c) {
+}
+std::string Token::text() const {
+    return lexeme.str();
+}
+bool Token::intValue(int* value) const {
+    long long result = 0;
+    for (size_t i = 0; i < lexeme.length; ++i) {
+        char c = lexeme.data[i];
+        if (c < '0' || c > '9') {
+            break;
+        }
+        result = result * 10 + (c - '0');
+        if (result > INT_MAX) {
+            *value = INT_MAX;
+            return false;
+        }
+    }
+    *value = static_cast<int>(result);
+    return true;
 }
 std::string Token::toString() const {
-    return Lexer::tokenTypeName(type) + "(" + lexeme + ")";
+    return Lexer::tokenTypeName(type) + "(" + lexeme.str() + ")";
 }
-Lexer::Lexer() : pos(0), line(1), column(1) {
+Lexer::Lexer()
+    : interner(&StringInterner::global()), source(""), length(0), pos(0), origin(0), line(1), column(1), hasLookahead(false) {
 }
-Lexer::Lexer(const std::string& src) : source(src), pos(0), line(1), column(1) {
+Lexer::Lexer(const std::string& src)
+    : interner(&StringInterner::global()), source(""), length(0), pos(0), origin(0), line(1), column(1), hasLookahead(false) {
+    init(src);
 }
 void Lexer::init(const std::string& src) {
-    source = src;
+    buffer.assign(src.data(), src.length());
+    reset();
+}
+void Lexer::init(const std::string& src, size_t offset, int firstLine, int firstColumn) {
+    init(src);
+    origin = offset;
+    line = firstLine;
+    column = firstColumn;
+    current = Token(T_EOF, StringRef(source, 0), origin, line, column);
+}
+bool Lexer::openFile(const std::string& filename, bool mapFile) {
+    bool ok = buffer.openFile(filename, mapFile);
+    reset();
+    return ok;
+}
+void Lexer::setInterner(StringInterner* table) {
+    interner = table ? table : &StringInterner::global();
+}
+StringInterner* Lexer::getInterner() const {
+    return interner;
+}
+void Lexer::reset() {
+    source = buffer.data();
+    length = buffer.size();
     pos = 0;
+    origin = 0;
     line = 1;
     column = 1;
-    current = Token();
+    current = Token(T_EOF, StringRef(source, 0), 0, 1, 1);
+    hasLookahead = false;
 }
-char Lexer::currentChar() const {
-    if (pos >= source.length()) {
-        return '\0';
-    }
-    return source[pos];
+const SourceBuffer& Lexer::getBuffer() const {
+    return buffer;
 }
-char Lexer::nextChar() {
-    if (pos >= source.length()) {
-        return '\0';
-    }
-    char c = source[pos++];
-    if (c == '\n') {
-        line++;
-        column = 1;
-    } else {
-        column++;
-    }
-    return c;
+size_t Lexer::position() const {
+    return origin + pos;
 }
 void Lexer::skipWhitespace() {
-    while (pos < source.length() && std::isspace(currentChar())) {
-        nextChar();
+    const char* p = source + pos;
+    while (charClass(*p) & CHAR_SPACE) {
+        if (*p == '\n') {
+            line++;
+            column = 1;
+        } else {
+            column++;
+        }
+        ++p;
     }
+    pos = p - source;
 }
 void Lexer::skipComment() {
-    if (pos + 1 < source.length() && source[pos] == '/' && source[pos + 1] == '/') {
-        while (pos < source.length() && currentChar() != '\n') {
-            nextChar();
-        }
+    const char* p = source + pos;
+    const char* end = source + length;
+    while (*p != '\n' && (*p != '\0' || p < end)) {
+        ++p;
     }
+    column += static_cast<int>(p - (source + pos));
+    pos = p - source;
 }
-Token Lexer::makeToken(TokenType type, const std::string& lexeme) {
-    return Token(type, lexeme, line, column - lexeme.length());
+size_t Lexer::scan(unsigned char mask) {
+    const char* start = source + pos;
+    const char* p = start;
+    while (charClass(*p) & mask) {
+        ++p;
+    }
+    size_t count = p - start;
+    pos += count;
+    column += static_cast<int>(count);
+    return count;
+}
+Token Lexer::makeToken(TokenType type, size_t start, int startLine, int startColumn) const {
+    return Token(type, StringRef(source + start, pos - start), origin + start, startLine, startColumn);
 }
 Token Lexer::makeIdentifierOrKeyword() {
     int startLine = line;
     int startColumn = column;
-    std::string lexeme;
-    while (pos < source.length() && (std::isalnum(currentChar()) || currentChar() == '_')) {
-        lexeme += nextChar();
-    }
-    TokenType type = T_IDENT;
-    if (isKeyword(lexeme)) {
-        if (lexeme == "game") type = T_GAME;
-        else if (lexeme == "speed") type = T_SPEED;
-        else if (lexeme == "grid") type = T_GRID;
-        else if (lexeme == "color") type = T_COLOR;
-        else if (lexeme == "entity") type = T_ENTITY;
-        else if (lexeme == "spawn") type = T_SPAWN;
-        else if (lexeme == "solid") type = T_SOLID;
-        else if (lexeme == "controls") type = T_CONTROLS;
-        else if (lexeme == "rule") type = T_RULE;
-        else if (lexeme == "tick") type = T_TICK;
-        else if (lexeme == "collide") type = T_COLLIDE;
-        else if (lexeme == "score") type = T_SCORE;
-        else if (lexeme == "lose") type = T_LOSE;
-        else if (lexeme == "true") type = T_TRUE;
-        else if (lexeme == "false") type = T_FALSE;
+    size_t start = pos;
+    scan(CHAR_IDENT_CONT);
+    Token token = makeToken(T_IDENT, start, startLine, startColumn);
+    token.type = keywordType(token.lexeme.data, token.lexeme.length);
+    if (token.type == T_IDENT) {
+        token.symbol = interner->intern(token.lexeme);
     }
-    return Token(type, lexeme, startLine, startColumn);
+    return token;
 }
 Token Lexer::makeNumber() {
     int startLine = line;
     int startColumn = column;
-    std::string lexeme;
-    while (pos < source.length() && std::isdigit(currentChar())) {
-        lexeme += nextChar();
+    size_t start = pos;
+    scan(CHAR_DIGIT);
+    if (charClass(source[pos]) & CHAR_ALPHA) {
+        scan(CHAR_IDENT_CONT);
+        return makeToken(T_ERROR, start, startLine, startColumn);
     }
-    if (pos < source.length() && std::isalpha(currentChar())) {
-        while (pos < source.length() && (std::isalnum(currentChar()) || currentChar() == '_')) {
-            lexeme += nextChar();
-        }
-        return Token(T_ERROR, lexeme, startLine, startColumn);
-    }
-    return Token(T_INT, lexeme, startLine, startColumn);
+    return makeToken(T_INT, start, startLine, startColumn);
 }
 Token Lexer::makeHexColor() {
     int startLine = line;
     int startColumn = column;
-    std::string lexeme;
-    lexeme += nextChar(); 
+    size_t start = pos;
+    pos++;
+    column++;
     int hexCount = 0;
-    while (pos < source.length() && std::isxdigit(currentChar()) && hexCount < 6) {
-        lexeme += nextChar();
+    while (hexCount < 6 && (charClass(source[pos]) & CHAR_HEX)) {
+        pos++;
+        column++;
         hexCount++;
     }
     if (hexCount != 6) {
-        while (pos < source.length() && (std::isalnum(currentChar()) || currentChar() == '_')) {
-            lexeme += nextChar();
-        }
-        return Token(T_ERROR, lexeme, startLine, startColumn);
+        scan(CHAR_IDENT_CONT);
+        return makeToken(T_ERROR, start, startLine, startColumn);
     }
-    return Token(T_HEXCOLOR, lexeme, startLine, startColumn);
+    return makeToken(T_HEXCOLOR, start, startLine, startColumn);
 }
-Token Lexer::makeTwoCharOperator(char first, char second, TokenType type) {
+Token Lexer::makeTwoCharOperator(TokenType type) {
     int startLine = line;
     int startColumn = column;
-    std::string lexeme;
-    lexeme += nextChar(); 
-    lexeme += nextChar(); 
-    return Token(type, lexeme, startLine, startColumn);
+    size_t start = pos;
+    pos += 2;
+    column += 2;
+    return makeToken(type, start, startLine, startColumn);
 }
 Token Lexer::nextToken() {
+    if (hasLookahead) {
+        hasLookahead = false;
+        current = lookahead;
+    } else {
+        current = scanToken();
+    }
+    return current;
+}
+Token Lexer::scanToken() {
     while (true) {
         skipWhitespace();
-        if (pos + 1 < source.length() && source[pos] == '/' && source[pos + 1] == '/') {
+        if (source[pos] == '/' && source[pos + 1] == '/') {
             skipComment();
             continue; 
         }
         break; 
     }
-    if (pos >= source.length()) {
-        current = Token(T_EOF, "", line, column);
-        return current;
+    if (pos >= length) {
+        return Token(T_EOF, StringRef(source + pos, 0), origin + pos, line, column);
     }
-    char c = currentChar();
-    if (std::isalpha(c) || c == '_') {
-        current = makeIdentifierOrKeyword();
-        return current;
+    char c = source[pos];
+    unsigned char cls = charClass(c);
+    if (cls & CHAR_IDENT_START) {
+        return makeIdentifierOrKeyword();
     }
-    if (std::isdigit(c)) {
-        current = makeNumber();
-        return current;
+    if (cls & CHAR_DIGIT) {
+        return makeNumber();
     }
     if (c == '#') {
-        current = makeHexColor();
-        return current;
+        return makeHexColor();
     }
-    if (pos + 1 < source.length()) {
+    if (cls & CHAR_OPERATOR) {
         char next = source[pos + 1];
         if (c == '<' && next == '=') {
-            current = makeTwoCharOperator(c, next, T_LESSEQ);
-            return current;
+            return makeTwoCharOperator(T_LESSEQ);
         }
         if (c == '>' && next == '=') {
-            current = makeTwoCharOperator(c, next, T_GREATEREQ);
-            return current;
+            return makeTwoCharOperator(T_GREATEREQ);
         }
         if (c == '=' && next == '=') {
-            current = makeTwoCharOperator(c, next, T_EQUAL);
-            return current;
+            return makeTwoCharOperator(T_EQUAL);
         }
         if (c == '!' && next == '=') {
-            current = makeTwoCharOperator(c, next, T_NOTEQUAL);
-            return current;
+            return makeTwoCharOperator(T_NOTEQUAL);
         }
     }
-    std::string lexeme;
-    lexeme += nextChar();
+    int startLine = line;
+    int startColumn = column;
+    size_t start = pos;
+    pos++;
+    column++;
     TokenType type = T_ERROR;
     switch (c) {
         case '{': type = T_LBRACE; break;
@@ -191,18 +309,14 @@ Token Lexer::nextToken() {
             type = T_ERROR;
             break;
     }
-    current = Token(type, lexeme, line, column - 1);
-    return current;
+    return makeToken(type, start, startLine, startColumn);
 }
 Token Lexer::peekToken() {
-    size_t savedPos = pos;
-    int savedLine = line;
-    int savedColumn = column;
-    Token peek = nextToken();
-    pos = savedPos;
-    line = savedLine;
-    column = savedColumn;
-    return peek;
+    if (!hasLookahead) {
+        lookahead = scanToken();
+        hasLookahead = true;
+    }
+    return lookahead;
 }
 const Token& Lexer::getCurrentToken() const {
     return current;
@@ -214,21 +328,9 @@ std::string Lexer::tokenTypeName(TokenType type) {
         case T_IDENT: return "IDENT";
         case T_INT: return "INT";
         case T_HEXCOLOR: return "HEXCOLOR";
-        case T_TRUE: return "TRUE";
-        case T_FALSE: return "FALSE";
-        case T_GAME: return "GAME";
-        case T_SPEED: return "SPEED";
-        case T_GRID: return "GRID";
-        case T_COLOR: return "COLOR";
-        case T_ENTITY: return "ENTITY";
-        case T_SPAWN: return "SPAWN";
-        case T_SOLID: return "SOLID";
-        case T_CONTROLS: return "CONTROLS";
-        case T_RULE: return "RULE";
-        case T_TICK: return "TICK";
-        case T_COLLIDE: return "COLLIDE";
-        case T_SCORE: return "SCORE";
-        case T_LOSE: return "LOSE";
+#define BRICK_KEYWORD_NAME(type, text, name) case type: return name;
+        BRICK_KEYWORDS(BRICK_KEYWORD_NAME)
+#undef BRICK_KEYWORD_NAME
         case T_LIVES: return "LIVES";
         case T_LBRACE: return "LBRACE";
         case T_RBRACE: return "RBRACE";
@@ -252,17 +354,24 @@ std::string Lexer::tokenTypeName(TokenType type) {
     }
 }
 bool Lexer::isKeyword(const std::string& word) {
-    return word == "game" || word == "speed" || word == "grid" || word == "color" ||
-           word == "entity" || word == "spawn" || word == "solid" || word == "controls" ||
-           word == "rule" || word == "tick" || word == "collide" || word == "score" ||
-           word == "lose" || word == "true" || word == "false";
+    return keywordType(word.data(), word.length()) != T_IDENT;
+}
+TokenType Lexer::keywordType(const char* text, size_t length) {
+    if (length < KEYWORD_MIN_LENGTH || length > KEYWORD_MAX_LENGTH) {
+        return T_IDENT;
+    }
+    const KeywordSlot& slot = keywordTable.slots[keywordHash(text, length)];
+    if (slot.length == length && std::memcmp(slot.text, text, length) == 0) {
+        return slot.type;
+    }
+    return T_IDENT;
 }
 bool Lexer::hasError() const {
     return current.type == T_ERROR;
 }
 std::string Lexer::getErrorMessage() const {
     if (current.type == T_ERROR) {
-        return "Token inválido: '" + current.lexeme + "'";
+        return "Token inválido: '" + current.lexeme.str() + "'";
     }
     return "";
 }
@@ -1,5 +1,7 @@
 #ifndef LEXER_HPP
 #define LEXER_HPP
+#include "source.hpp"
+#include "string_interner.hpp"
 #include <string>
 #include <vector>
 namespace brick {
@@ -44,14 +46,53 @@ enum TokenType {
     T_EQUAL,
     T_NOTEQUAL
 };
+// Tabla única de palabras reservadas: (tipo, lexema, nombre del token).
+// La usan el reconocimiento de keywords, isKeyword y tokenTypeName.
+#define BRICK_KEYWORDS(X) \
+    X(T_GAME, "game", "GAME") \
+    X(T_SPEED, "speed", "SPEED") \
+    X(T_GRID, "grid", "GRID") \
+    X(T_COLOR, "color", "COLOR") \
+    X(T_ENTITY, "entity", "ENTITY") \
+    X(T_SPAWN, "spawn", "SPAWN") \
+    X(T_SOLID, "solid", "SOLID") \
+    X(T_CONTROLS, "controls", "CONTROLS") \
+    X(T_RULE, "rule", "RULE") \
+    X(T_TICK, "tick", "TICK") \
+    X(T_COLLIDE, "collide", "COLLIDE") \
+    X(T_SCORE, "score", "SCORE") \
+    X(T_LOSE, "lose", "LOSE") \
+    X(T_TRUE, "true", "TRUE") \
+    X(T_FALSE, "false", "FALSE")
+enum CharClass {
+    CHAR_SPACE = 1 << 0,
+    CHAR_ALPHA = 1 << 1,
+    CHAR_IDENT_START = 1 << 2,
+    CHAR_IDENT_CONT = 1 << 3,
+    CHAR_DIGIT = 1 << 4,
+    CHAR_HEX = 1 << 5,
+    CHAR_OPERATOR = 1 << 6
+};
+extern const unsigned char CHAR_CLASS_TABLE[256];
+inline unsigned char charClass(char c) {
+    return CHAR_CLASS_TABLE[static_cast<unsigned char>(c)];
+}
+// El lexema es una vista (offset, longitud) sobre el SourceBuffer del Lexer:
+// solo es válido mientras ese Lexer exista. Usar text() para conservarlo.
+// Los identificadores llevan además su id en el interner del Lexer.
 class Token {
 public:
     TokenType type;
-    std::string lexeme;
+    StringRef lexeme;
+    SymbolId symbol;
+    size_t offset;
     int line;
     int column;
     Token();
-    Token(TokenType t, const std::string& lex, int l, int c);
+    Token(TokenType t, const StringRef& lex, size_t off, int l, int c);
+    std::string text() const;
+    // false si el literal no cabe en un int.
+    bool intValue(int* value) const;
     std::string toString() const;
     bool isKeyword() const;
     bool isLiteral() const;
@@ -59,29 +100,52 @@ public:
 };
 class Lexer {
 private:
-    std::string source;
+    SourceBuffer buffer;
+    StringInterner* interner;
+    const char* source;
+    size_t length;
     size_t pos;
+    // Offset de source[0] en el documento: se suma al offset de cada token.
+    size_t origin;
     int line;
     int column;
     Token current;
-    char currentChar() const;
-    char nextChar();
+    Token lookahead;
+    bool hasLookahead;
+    Token scanToken();
     void skipWhitespace();
     void skipComment();
-    Token makeToken(TokenType type, const std::string& lexeme);
+    size_t scan(unsigned char mask);
+    Token makeToken(TokenType type, size_t start, int startLine, int startColumn) const;
     Token makeIdentifierOrKeyword();
     Token makeNumber();
     Token makeHexColor();
-    Token makeTwoCharOperator(char first, char second, TokenType type);
+    Token makeTwoCharOperator(TokenType type);
+    void reset();
+    Lexer(const Lexer&);
+    Lexer& operator=(const Lexer&);
 public:
     Lexer();
     explicit Lexer(const std::string& src);
     void init(const std::string& src);
+    // 'src' es un fragmento de un documento mayor que empieza en 'offset',
+    // línea 'firstLine' y columna 'firstColumn': los tokens llevan posiciones
+    // del documento, no del fragmento.
+    void init(const std::string& src, size_t offset, int firstLine, int firstColumn);
+    // mapFile como en SourceBuffer::openFile.
+    bool openFile(const std::string& filename, bool mapFile = false);
+    const SourceBuffer& getBuffer() const;
+    // Offset del documento hasta donde se escaneó (incluye lo que se miró por
+    // adelantado).
+    size_t position() const;
+    void setInterner(StringInterner* table);
+    StringInterner* getInterner() const;
     Token nextToken();
     Token peekToken();
     const Token& getCurrentToken() const;
     static std::string tokenTypeName(TokenType type);
     static bool isKeyword(const std::string& word);
+    static TokenType keywordType(const char* text, size_t length);
     bool hasError() const;
     std::string getErrorMessage() const;
 };
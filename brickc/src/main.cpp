@@ -1,41 +1,64 @@
 #include "lexer.hpp"
 #include "parser.hpp"
 #include "ast.hpp"
+#include "flat_ast.hpp"
 #include "symbols.hpp"
+#include "bytecode.hpp"
+#include "brick_image.hpp"
 #include "error.hpp"
+#include "pass_timer.hpp"
+#include "thread_pool.hpp"
 #include "util.hpp"
 #include <iostream>
 #include <fstream>
+#include <sstream>
 #include <string>
+#include <vector>
 #include <cstdlib>
 using namespace brick;
 using namespace std;
-const char* VERSION = "1.0.0";
+const char* VERSION = BRICKC_VERSION;
 const char* BUILD_DATE = __DATE__ " " __TIME__;
+enum TimePassesMode {
+    TIME_PASSES_OFF,
+    TIME_PASSES_TABLE,
+    TIME_PASSES_JSON
+};
 struct Options {
-    string inputFile;
+    vector<string> inputs;
+    unsigned int jobs;
+    int timePasses;
     bool showHelp;
     bool showVersion;
     bool verbose;
     bool jsonOutput;
     bool debugMode;
-    Options() : showHelp(false), showVersion(false), verbose(false), 
-                jsonOutput(false), debugMode(false) {}
+    bool disasm;
+    bool emitBinary;
+    Options() : jobs(1), timePasses(TIME_PASSES_OFF), showHelp(false), showVersion(false), verbose(false), 
+                jsonOutput(false), debugMode(false), disasm(false), emitBinary(false) {}
 };
 void printUsage(const char* programName) {
     cout << "BrickC - Compilador para BrickLang v" << VERSION << "\n";
     cout << "Motor de Juegos de Ladrillos - Entrega 1\n\n";
-    cout << "Uso: " << programName << " [opciones] <archivo.brick>\n\n";
+    cout << "Uso: " << programName << " [opciones] <archivo.brick>\n";
+    cout << "     " << programName << " [opciones] --jobs N <archivo.brick | directorio>...\n\n";
     cout << "Opciones:\n";
     cout << "  -h, --help      Mostrar esta ayuda\n";
     cout << "  -v, --version   Mostrar información de versión\n";
     cout << "  --verbose       Mostrar información detallada del análisis\n";
     cout << "  --json          Generar salida en formato JSON\n";
-    cout << "  --debug         Mostrar información de debug\n\n";
+    cout << "  --debug         Mostrar información de debug\n";
+    cout << "  --disasm        Mostrar el bytecode compilado de cada regla\n";
+    cout << "  --emit-binary   Escribir la imagen precompilada <archivo>.brickb\n";
+    cout << "  -j, --jobs N    Compilar varios archivos con N hilos (0 = uno por CPU)\n";
+    cout << "  --time-passes   Medir tiempo, asignaciones y memoria de cada fase\n";
+    cout << "  --time-passes=json  Lo mismo en JSON (en la salida de error)\n\n";
     cout << "Ejemplos:\n";
     cout << "  " << programName << " examples/snake.brick\n";
     cout << "  " << programName << " --verbose examples/tetris.brick\n";
-    cout << "  " << programName << " --json examples/snake.brick > output.json\n\n";
+    cout << "  " << programName << " --json examples/snake.brick > output.json\n";
+    cout << "  " << programName << " --jobs 4 examples/ tests/\n\n";
     cout << "Archivos de prueba incluidos:\n";
     cout << "  examples/snake.brick    - Juego Snake completo\n";
     cout << "  examples/tetris.brick   - Juego Tetris completo\n";
@@ -63,137 +86,311 @@ Options parseCommandLine(int argc, char* argv[]) {
             opts.jsonOutput = true;
         } else if (arg == "--debug") {
             opts.debugMode = true;
+        } else if (arg == "--disasm") {
+            opts.disasm = true;
+        } else if (arg == "--emit-binary") {
+            opts.emitBinary = true;
+        } else if (arg == "--time-passes") {
+            opts.timePasses = TIME_PASSES_TABLE;
+        } else if (arg == "--time-passes=json") {
+            opts.timePasses = TIME_PASSES_JSON;
+        } else if (arg == "-j" || arg == "--jobs") {
+            bool valid = false;
+            int jobs = i + 1 < argc ? StringUtils::toInt(argv[++i], &valid) : 0;
+            if (!valid || jobs < 0) {
+                cerr << "Se esperaba un número de hilos después de " << arg << "\n";
+                exit(1);
+            }
+            opts.jobs = jobs > 0 ? static_cast<unsigned int>(jobs) : WorkStealingPool::hardwareThreads();
         } else if (arg[0] == '-') {
             cerr << "Opción desconocida: " << arg << "\n";
             cerr << "Use -h o --help para ver opciones disponibles.\n";
             exit(1);
         } else {
-            if (opts.inputFile.empty()) {
-                opts.inputFile = arg;
-            } else {
-                cerr << "Solo se puede especificar un archivo de entrada.\n";
-                exit(1);
-            }
+            opts.inputs.push_back(arg);
         }
     }
     return opts;
 }
-int main(int argc, char* argv[]) {
-    Options opts = parseCommandLine(argc, argv);
-    if (opts.showHelp) {
-        printUsage(argv[0]);
-        return 0;
-    }
-    if (opts.showVersion) {
-        printVersion();
-        return 0;
+// Compila un archivo y devuelve el código de salida. Toda la salida va a
+// 'out' y 'err' para que el modo lote pueda imprimirla en orden.
+int runPasses(const Options& opts, const string& inputFile, ostream& out, ostream& err, PassTimer& timer) {
+    if (opts.verbose) {
+        out << "BrickC v" << VERSION << " - Analizando: " << inputFile << "\n";
+        out << "==========================================\n";
     }
-    if (opts.inputFile.empty()) {
-        cerr << "Error: No se especificó archivo de entrada.\n";
-        cerr << "Use -h o --help para ver instrucciones de uso.\n";
+    // Un interner por archivo: en modo lote cada hilo compila por su cuenta.
+    StringInterner names;
+    Lexer lexer;
+    lexer.setInterner(&names);
+    timer.begin("lectura");
+    if (!lexer.openFile(inputFile, true)) {
+        err << "Error: No se pudo abrir el archivo: " << inputFile << "\n";
         return 1;
     }
-    Debug::setEnabled(opts.debugMode);
+    timer.end();
     if (opts.verbose) {
-        cout << "BrickC v" << VERSION << " - Analizando: " << opts.inputFile << "\n";
-        cout << "==========================================\n";
+        out << "Archivo leído exitosamente (" << lexer.getBuffer().size() << " caracteres"
+            << (lexer.getBuffer().isMapped() ? ", mapeado en memoria" : "") << ")\n";
     }
-    try {
-        string sourceCode = FileUtils::readFile(opts.inputFile);
-        if (opts.verbose) {
-            cout << "Archivo leído exitosamente (" << sourceCode.length() << " caracteres)\n";
-        }
-        ErrorHandler errorHandler;
-        errorHandler.setCurrentFile(opts.inputFile);
-        if (opts.verbose) {
-            cout << "\n1. Análisis Léxico...\n";
-        }
-        Lexer lexer(sourceCode);
-        if (opts.verbose) {
-            cout << "2. Análisis Sintáctico...\n";
-        }
-        Parser parser(&lexer, &errorHandler);
-        ASTNode* ast = parser.parseProgram();
-        if (errorHandler.hasErrors()) {
-            cerr << "\nERRORES ENCONTRADOS:\n";
-            cerr << "====================\n";
-            errorHandler.printAll(cerr);
-            if (ast) {
-                deleteAST(ast);
-            }
-            cerr << "\nEl análisis falló con " << errorHandler.getErrorCount() 
-                 << " error(es).\n";
-            return 1;
+    ErrorHandler errorHandler;
+    errorHandler.setCurrentFile(inputFile);
+    if (opts.verbose) {
+        out << "\n1. Análisis Léxico...\n";
+    }
+    if (timer.isEnabled()) {
+        // El parser lexea bajo demanda; para medir el léxico por separado se
+        // hace antes una pasada solo de tokens sobre una copia del fuente.
+        StringInterner lexNames;
+        Lexer lexOnly;
+        lexOnly.setInterner(&lexNames);
+        lexOnly.init(string(lexer.getBuffer().data(), lexer.getBuffer().size()));
+        timer.begin("lexico");
+        size_t tokens = 0;
+        while (lexOnly.nextToken().type != T_EOF) {
+            ++tokens;
         }
-        if (!ast) {
-            cerr << "Error: No se pudo construir el árbol sintáctico.\n";
+        timer.end();
+        timer.setTokens(tokens);
+    }
+    if (opts.verbose) {
+        out << "2. Análisis Sintáctico...\n";
+    }
+    AstArena arena;
+    timer.begin("sintactico");
+    Parser parser(&lexer, &errorHandler, &arena);
+    FlatAst flatAst;
+    ASTNode* ast = NULL;
+    bool parsed;
+    if (opts.debugMode) {
+        // --debug imprime el árbol de punteros: se conserva entero.
+        ast = parser.parseProgram();
+        parsed = flatAst.build(ast, *lexer.getInterner());
+    } else {
+        parsed = parser.parseProgram(flatAst);
+    }
+    if (errorHandler.hasErrors()) {
+        err << "\nERRORES ENCONTRADOS:\n";
+        err << "====================\n";
+        errorHandler.printAll(err);
+        err << "\nEl análisis falló con " << errorHandler.getReportedCount() 
+            << " error(es).\n";
+        return 1;
+    }
+    if (!parsed) {
+        err << "Error: No se pudo construir el árbol sintáctico.\n";
+        return 1;
+    }
+    if (opts.verbose) {
+        out << "3. Construcción de Tabla de Símbolos...\n";
+    }
+    timer.end();
+    timer.setNodes(flatAst.nodeCount());
+    if (opts.verbose) {
+        out << "   AST plano: " << flatAst.nodeCount() << " nodos, "
+            << flatAst.memoryUsage() << " bytes\n";
+    }
+    timer.begin("simbolos");
+    SymbolTable symbolTable(&errorHandler, lexer.getInterner());
+    bool success = symbolTable.populateFromAST(flatAst);
+    timer.end();
+    if (!success || errorHandler.hasErrors()) {
+        err << "\nERRORES SEMÁNTICOS:\n";
+        err << "===================\n";
+        errorHandler.printAll(err);
+        err << "\nEl análisis semántico falló con " 
+            << errorHandler.getReportedCount() << " error(es).\n";
+        return 1;
+    }
+    if (opts.verbose) {
+        out << "4. Validación Semántica...\n";
+    }
+    timer.begin("validacion");
+    bool valid = symbolTable.validate();
+    timer.end();
+    if (!valid || errorHandler.hasErrors()) {
+        err << "\nERRORES DE VALIDACIÓN:\n";
+        err << "======================\n";
+        errorHandler.printAll(err);
+        err << "\nLa validación falló con " 
+            << errorHandler.getReportedCount() << " error(es).\n";
+        return 1;
+    }
+    if (opts.verbose) {
+        out << "5. Generando Resultados...\n\n";
+    }
+    timer.begin("emision");
+    out << "OK: juego '" << symbolTable.getGameName() 
+        << "' analizado correctamente\n";
+    if (opts.emitBinary) {
+        string imagePath = BrickImage::pathFor(inputFile);
+        string message;
+        const SourceBuffer& source = lexer.getBuffer();
+        if (!BrickImage::write(symbolTable, BrickImage::hashSource(source.data(), source.size()),
+                               imagePath, &message)) {
+            err << "Error: " << message << "\n";
             return 1;
         }
         if (opts.verbose) {
-            cout << "3. Construcción de Tabla de Símbolos...\n";
-        }
-        SymbolTable symbolTable(&errorHandler);
-        bool success = symbolTable.populateFromAST(ast);
-        if (!success || errorHandler.hasErrors()) {
-            cerr << "\nERRORES SEMÁNTICOS:\n";
-            cerr << "===================\n";
-            errorHandler.printAll(cerr);
-            deleteAST(ast);
-            cerr << "\nEl análisis semántico falló con " 
-                 << errorHandler.getErrorCount() << " error(es).\n";
-            return 1;
+            out << "Imagen binaria escrita en " << imagePath << "\n";
         }
+    }
+    if (opts.jsonOutput) {
         if (opts.verbose) {
-            cout << "4. Validación Semántica...\n";
-        }
-        bool valid = symbolTable.validate();
-        if (!valid || errorHandler.hasErrors()) {
-            cerr << "\nERRORES DE VALIDACIÓN:\n";
-            cerr << "======================\n";
-            errorHandler.printAll(cerr);
-            deleteAST(ast);
-            cerr << "\nLa validación falló con " 
-                 << errorHandler.getErrorCount() << " error(es).\n";
-            return 1;
+            out << "\nTABLA DE SÍMBOLOS (JSON):\n";
+            out << "=========================\n";
         }
+        symbolTable.printJSON(out);
+    } else {
         if (opts.verbose) {
-            cout << "5. Generando Resultados...\n\n";
+            out << "\nTABLA DE SÍMBOLOS:\n";
+            out << "==================\n";
         }
-        cout << "OK: juego '" << symbolTable.getGameName() 
-             << "' analizado correctamente\n";
-        if (opts.jsonOutput) {
-            if (opts.verbose) {
-                cout << "\nTABLA DE SÍMBOLOS (JSON):\n";
-                cout << "=========================\n";
-            }
-            symbolTable.printJSON(cout);
-        } else {
-            if (opts.verbose) {
-                cout << "\nTABLA DE SÍMBOLOS:\n";
-                cout << "==================\n";
-            }
-            symbolTable.print(cout);
+        symbolTable.print(out);
+    }
+    if (opts.verbose) {
+        out << "\nRESUMEN:\n";
+        out << "========\n";
+        symbolTable.printSummary(out);
+        out << "\nESTADÍSTICAS:\n";
+        out << "=============\n";
+        out << "Entidades definidas: " << symbolTable.getEntityCount() << "\n";
+        out << "Controles mapeados: " << symbolTable.getControlCount() << "\n";
+        out << "Reglas definidas: " << symbolTable.getRuleCount() << "\n";
+    }
+    if (opts.disasm) {
+        out << "\nBYTECODE DE REGLAS:\n";
+        out << "===================\n";
+        const vector<Rule>& rules = symbolTable.getRules();
+        for (size_t i = 0; i < rules.size(); ++i) {
+            const Rule& rule = rules[i];
+            out << "rule " << rule.name << " (" << rule.code.size() << " bytes, pila "
+                << rule.code.maxStack << ")\n";
+            disassemble(rule.code, *lexer.getInterner(), out);
         }
-        if (opts.verbose) {
-            cout << "\nRESUMEN:\n";
-            cout << "========\n";
-            symbolTable.printSummary(cout);
-            cout << "\nESTADÍSTICAS:\n";
-            cout << "=============\n";
-            cout << "Entidades definidas: " << symbolTable.getEntityCount() << "\n";
-            cout << "Controles mapeados: " << symbolTable.getControlCount() << "\n";
-            cout << "Reglas definidas: " << symbolTable.getRuleCount() << "\n";
+    }
+    if (opts.debugMode) {
+        out << "\n\nÁRBOL SINTÁCTICO (DEBUG):\n";
+        out << "==========================\n";
+        printAST(ast, 0, out);
+    }
+    if (opts.verbose) {
+        out << "\n✓ Análisis completado exitosamente.\n";
+    }
+    timer.end();
+    return 0;
+}
+// Las mediciones salen también cuando una fase falla: muestran hasta dónde
+// llegó el análisis.
+int compileFile(const Options& opts, const string& inputFile, ostream& out, ostream& err) {
+    PassTimer timer(opts.timePasses != TIME_PASSES_OFF);
+    int status = runPasses(opts, inputFile, out, err, timer);
+    timer.end();
+    if (opts.timePasses == TIME_PASSES_TABLE) {
+        timer.print(err);
+    } else if (opts.timePasses == TIME_PASSES_JSON) {
+        timer.printJSON(err);
+    }
+    return status;
+}
+struct BatchJob {
+    string file;
+    ostringstream out;
+    ostringstream err;
+    int status;
+};
+struct Batch {
+    const Options* opts;
+    vector<BatchJob*> jobs;
+};
+void compileJob(size_t index, void* context) {
+    Batch* batch = static_cast<Batch*>(context);
+    BatchJob& job = *batch->jobs[index];
+    job.status = compileFile(*batch->opts, job.file, job.out, job.err);
+}
+// Los directorios se expanden a sus .brick (recursivamente y en orden), así
+// el orden de la salida depende solo de los argumentos.
+bool expandInputs(const vector<string>& inputs, vector<string>& files, bool* sawDirectory) {
+    *sawDirectory = false;
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        if (!FileUtils::isDirectory(inputs[i])) {
+            files.push_back(inputs[i]);
+            continue;
         }
-        if (opts.debugMode) {
-            cout << "\n\nÁRBOL SINTÁCTICO (DEBUG):\n";
-            cout << "==========================\n";
-            printAST(ast);
+        *sawDirectory = true;
+        if (!FileUtils::listFiles(inputs[i], ".brick", files)) {
+            cerr << "Error: No se pudo leer el directorio: " << inputs[i] << "\n";
+            return false;
         }
-        deleteAST(ast);
-        if (opts.verbose) {
-            cout << "\n✓ Análisis completado exitosamente.\n";
+    }
+    return true;
+}
+// Compila en paralelo y escribe la salida de cada archivo en el orden de la
+// línea de comandos, sin importar qué hilo terminó antes.
+int compileBatch(const Options& opts, const vector<string>& files) {
+    Batch batch;
+    batch.opts = &opts;
+    for (size_t i = 0; i < files.size(); ++i) {
+        BatchJob* job = new BatchJob();
+        job->file = files[i];
+        job->status = 1;
+        batch.jobs.push_back(job);
+    }
+    unsigned int threads = opts.jobs;
+    if (threads > files.size()) {
+        threads = static_cast<unsigned int>(files.size());
+    }
+    WorkStealingPool pool(threads);
+    pool.run(batch.jobs.size(), compileJob, &batch);
+    size_t failed = 0;
+    for (size_t i = 0; i < batch.jobs.size(); ++i) {
+        BatchJob& job = *batch.jobs[i];
+        cout << "==> " << job.file << " <==\n" << job.out.str() << flush;
+        cerr << job.err.str() << flush;
+        if (job.status != 0) {
+            ++failed;
         }
+        delete batch.jobs[i];
+    }
+    cout << "\nLOTE: " << files.size() << " archivo(s), " << files.size() - failed
+         << " correcto(s), " << failed << " con errores (" << pool.threadCount() << " hilo(s))\n";
+    return failed == 0 ? 0 : 1;
+}
+int main(int argc, char* argv[]) {
+    Options opts = parseCommandLine(argc, argv);
+    if (opts.showHelp) {
+        printUsage(argv[0]);
         return 0;
+    }
+    if (opts.showVersion) {
+        printVersion();
+        return 0;
+    }
+    if (opts.inputs.empty()) {
+        cerr << "Error: No se especificó archivo de entrada.\n";
+        cerr << "Use -h o --help para ver instrucciones de uso.\n";
+        return 1;
+    }
+    Debug::setEnabled(opts.debugMode);
+    vector<string> files;
+    bool sawDirectory = false;
+    if (!expandInputs(opts.inputs, files, &sawDirectory)) {
+        return 1;
+    }
+    if (files.empty()) {
+        cerr << "Error: No se encontraron archivos .brick.\n";
+        return 1;
+    }
+    if (files.size() > 1 || sawDirectory) {
+        if (opts.timePasses != TIME_PASSES_OFF) {
+            cerr << "Error: --time-passes mide un solo archivo.\n";
+            return 1;
+        }
+        return compileBatch(opts, files);
+    }
+#ifdef BRICK_EXCEPTIONS
+    try {
+        return compileFile(opts, files[0], cout, cerr);
     } catch (const std::exception& e) {
         cerr << "Error inesperado: " << e.what() << "\n";
         return 1;
@@ -201,4 +398,7 @@ int main(int argc, char* argv[]) {
         cerr << "Error inesperado desconocido.\n";
         return 1;
     }
+#else
+    return compileFile(opts, files[0], cout, cerr);
+#endif
 }
@@ -1,17 +1,21 @@
 #include "parser.hpp"
 #include "util.hpp"
 #include <iostream>
+#include <climits>
 namespace brick {
-Parser::Parser(Lexer* lex, ErrorHandler* errHandler)
-    : lexer(lex), errorHandler(errHandler), hasError(false) {
-    if (lexer) {
-        current = lexer->nextToken();
-    }
+Parser::Parser(Lexer* lex, ErrorHandler* errHandler, AstArena* astArena)
+    : tokens(lex), arena(astArena ? astArena : &localArena), interner(lex->getInterner()),
+      errorHandler(errHandler), hasError(false), previousEnd(0), previousLine(1), previousColumn(1) {
+    current = tokens.next();
+    previousEnd = current.offset;
+    previousLine = current.line;
+    previousColumn = current.column;
 }
 void Parser::advance() {
-    if (lexer) {
-        current = lexer->nextToken();
-    }
+    previousEnd = current.offset + current.lexeme.length;
+    previousLine = current.line;
+    previousColumn = current.column + static_cast<int>(current.lexeme.length);
+    current = tokens.next();
 }
 bool Parser::match(TokenType type) {
     if (check(type)) {
@@ -23,18 +27,30 @@ bool Parser::match(TokenType type) {
 bool Parser::check(TokenType type) const {
     return current.type == type;
 }
-void Parser::consume(TokenType type, const std::string& message) {
+const Token& Parser::peek(size_t k) {
+    return k == 0 ? current : tokens.peek(k - 1);
+}
+bool Parser::checkAhead(size_t k, TokenType type) {
+    return peek(k).type == type;
+}
+void Parser::consume(TokenType type, MessageId message) {
     if (current.type == type) {
         advance();
     } else {
         error(message);
     }
 }
-void Parser::error(const std::string& message) {
+void Parser::error(MessageId message, const MessageArg& argument) {
     hasError = true;
     if (errorHandler) {
-        errorHandler->reportSyntaxError(current.line, current.column, message);
+        errorHandler->report(ERROR_SYNTAX, current.line, current.column, message, argument);
+    }
+}
+Symbol Parser::symbolOf(const Token& token) {
+    if (token.symbol != NO_SYMBOL) {
+        return Symbol(token.symbol, interner->text(token.symbol));
     }
+    return interner->symbol(token.lexeme);
 }
 void Parser::synchronize() {
     hasError = false;
@@ -56,121 +72,168 @@ void Parser::synchronize() {
     }
 }
 ASTNode* Parser::parseProgram() {
+    GameNode* gameNode = parseGameHeader();
+    if (!gameNode) {
+        return NULL;
+    }
+    while (!atGameEnd()) {
+        SourceSpan span;
+        ASTNode* item = parseGameItem(&span);
+        if (item) {
+            gameNode->addBlock(item, span);
+        }
+    }
+    return finishGame(gameNode);
+}
+bool Parser::parseProgram(FlatAst& flat) {
+    GameNode* gameNode = parseGameHeader();
+    if (!gameNode) {
+        flat.clear();
+        return false;
+    }
+    flat.beginGame(gameNode->name, *interner);
+    while (!atGameEnd()) {
+        AstArena::Mark mark = arena->mark();
+        SourceSpan span;
+        ASTNode* item = parseGameItem(&span);
+        if (item) {
+            flat.addBlock(item);
+        }
+        arena->rewind(mark);
+    }
+    finishGame(gameNode);
+    flat.finishGame();
+    return true;
+}
+GameNode* Parser::parseGameHeader() {
     if (!match(T_GAME)) {
-        error("Se esperaba 'game'");
+        error(MSG_EXPECTED_GAME);
         return NULL;
     }
     if (current.type != T_IDENT) {
-        error("Se esperaba nombre del juego");
+        error(MSG_EXPECTED_GAME_NAME);
         return NULL;
     }
-    std::string gameName = current.lexeme;
+    Symbol gameName = symbolOf(current);
     advance();
-    consume(T_LBRACE, "Se esperaba '{' después del nombre del juego");
-    GameNode* gameNode = new GameNode(gameName);
-    while (current.type != T_RBRACE && current.type != T_EOF) {
-        if (current.type == T_SPEED || current.type == T_GRID || current.type == T_COLOR || 
-            current.type == T_SCORE) {
-            ASTNode* setting = parseSetting();
-            if (setting) {
-                gameNode->addSetting(setting);
-            }
-        } else if (current.type == T_IDENT && current.lexeme == "lives") {
-            // Tratar "lives" como configuración especial
-            ASTNode* setting = parseSetting();
-            if (setting) {
-                gameNode->addSetting(setting);
-            }
-        } else if (current.type == T_ENTITY) {
-            ASTNode* entity = parseEntity();
-            if (entity) {
-                gameNode->addEntity(entity);
-            }
-        } else if (current.type == T_CONTROLS) {
-            ASTNode* controls = parseControls();
-            if (controls) {
-                gameNode->addControl(controls);
-            }
-        } else if (current.type == T_RULE) {
-            ASTNode* rule = parseRule();
-            if (rule) {
-                gameNode->addRule(rule);
-            }
-        } else {
-            error("Elemento inesperado en el cuerpo del juego");
-            synchronize();
-        }
-        if (hasError) {
-            synchronize();
+    consume(T_LBRACE, MSG_EXPECTED_GAME_LBRACE);
+    GameNode* gameNode = new (*arena) GameNode(*arena, gameName);
+    gameNode->body.begin = previousEnd;
+    gameNode->body.line = previousLine;
+    gameNode->body.column = previousColumn;
+    return gameNode;
+}
+bool Parser::atGameEnd() const {
+    return current.type == T_RBRACE || current.type == T_EOF;
+}
+ASTNode* Parser::parseGameItem(SourceSpan* span) {
+    span->begin = current.offset;
+    span->line = current.line;
+    span->column = current.column;
+    ASTNode* item = NULL;
+    if (current.type == T_SPEED || current.type == T_GRID || current.type == T_COLOR || 
+        current.type == T_SCORE) {
+        item = parseSetting();
+    } else if (current.type == T_IDENT && current.lexeme == "lives") {
+        // Tratar "lives" como configuración especial
+        item = parseSetting();
+    } else if (current.type == T_ENTITY) {
+        item = parseEntity();
+    } else if (current.type == T_CONTROLS) {
+        item = parseControls();
+    } else if (current.type == T_RULE) {
+        item = parseRule();
+    } else {
+        error(MSG_UNEXPECTED_GAME_ITEM);
+        // synchronize() se detiene en 'game' sin consumirlo.
+        if (current.type == T_GAME) {
+            advance();
         }
+        synchronize();
     }
-    consume(T_RBRACE, "Se esperaba '}' al final del juego");
-    return new ProgramNode(gameName, gameNode);
+    if (hasError) {
+        synchronize();
+    }
+    // El bloque abarca también lo que saltó la recuperación de errores.
+    span->end = previousEnd;
+    span->endLine = previousLine;
+    span->endColumn = previousColumn;
+    return item;
+}
+ASTNode* Parser::finishGame(GameNode* gameNode) {
+    gameNode->body.end = current.offset;
+    gameNode->body.endLine = current.line;
+    gameNode->body.endColumn = current.column;
+    consume(T_RBRACE, MSG_EXPECTED_GAME_RBRACE);
+    return new (*arena) ProgramNode(gameNode->name, gameNode);
+}
+const Token& Parser::currentToken() const {
+    return current;
 }
 ASTNode* Parser::parseGame() {
     return NULL;
 }
 ASTNode* Parser::parseSetting() {
     TokenType settingType = current.type;
-    std::string key = current.lexeme;
+    Symbol key = symbolOf(current);
     advance();
-    consume(T_COLON, "Se esperaba ':' después del nombre de configuración");
+    consume(T_COLON, MSG_EXPECTED_SETTING_COLON);
     ASTNode* value = NULL;
     if (settingType == T_GRID) {
-        consume(T_LPAREN, "Se esperaba '(' para configuración de grilla");
-        if (current.type != T_INT) {
-            error("Se esperaba número entero para ancho de grilla");
+        consume(T_LPAREN, MSG_EXPECTED_GRID_LPAREN);
+        int width = 0;
+        if (!parseConstant(&width, MSG_EXPECTED_GRID_WIDTH)) {
             return NULL;
         }
-        int width = StringUtils::toInt(current.lexeme);
-        advance();
-        consume(T_COMMA, "Se esperaba ',' entre dimensiones de grilla");
-        if (current.type != T_INT) {
-            error("Se esperaba número entero para alto de grilla");
+        consume(T_COMMA, MSG_EXPECTED_GRID_COMMA);
+        int height = 0;
+        if (!parseConstant(&height, MSG_EXPECTED_GRID_HEIGHT)) {
             return NULL;
         }
-        int height = StringUtils::toInt(current.lexeme);
-        advance();
-        consume(T_RPAREN, "Se esperaba ')' al final de configuración de grilla");
-        value = new PointNode(width, height);
+        consume(T_RPAREN, MSG_EXPECTED_GRID_RPAREN);
+        value = new (*arena) PointNode(width, height);
     } else if (settingType == T_SPEED || settingType == T_SCORE || 
-               (settingType == T_IDENT && key == "lives")) {
-        if (current.type == T_INT) {
-            value = new IntegerNode(StringUtils::toInt(current.lexeme));
-            advance();
-        } else {
-            error("Se esperaba número entero para " + key);
+               (settingType == T_IDENT && key.text == "lives")) {
+        int number = 0;
+        if (!parseConstant(&number, MSG_EXPECTED_INTEGER_FOR, key.text)) {
             return NULL;
         }
+        value = new (*arena) IntegerNode(number);
     } else if (settingType == T_COLOR) {
         if (current.type == T_HEXCOLOR) {
             unsigned int color;
-            if (ColorUtils::parseHexColor(current.lexeme, &color)) {
-                value = new HexColorNode(color);
+            if (ColorUtils::parseHexColor(current.text(), &color)) {
+                value = new (*arena) HexColorNode(color);
             } else {
-                error("Color hexadecimal inválido");
+                error(MSG_INVALID_HEX_COLOR);
                 return NULL;
             }
             advance();
         } else {
-            error("Se esperaba color hexadecimal");
+            error(MSG_EXPECTED_HEX_COLOR);
             return NULL;
         }
     }
-    consume(T_SEMICOLON, "Se esperaba ';' al final de configuración");
-    return new SettingNode(key, value);
+    consume(T_SEMICOLON, MSG_EXPECTED_SETTING_SEMICOLON);
+    return new (*arena) SettingNode(key, value);
 }
 ASTNode* Parser::parseEntity() {
-    consume(T_ENTITY, "Se esperaba 'entity'");
+    consume(T_ENTITY, MSG_EXPECTED_ENTITY);
     if (current.type != T_IDENT) {
-        error("Se esperaba nombre de entidad");
+        error(MSG_EXPECTED_ENTITY_NAME);
         return NULL;
     }
-    std::string entityName = current.lexeme;
+    Symbol entityName = symbolOf(current);
     advance();
-    consume(T_LBRACE, "Se esperaba '{' después del nombre de entidad");
-    EntityNode* entityNode = new EntityNode(entityName);
+    consume(T_LBRACE, MSG_EXPECTED_ENTITY_LBRACE);
+    EntityNode* entityNode = new (*arena) EntityNode(*arena, entityName);
     while (current.type != T_RBRACE && current.type != T_EOF) {
+        // Un bloque nuevo cierra la entidad a la que le falta '}': synchronize()
+        // se detiene en él y el bucle no avanzaría.
+        if (current.type == T_ENTITY || current.type == T_CONTROLS || current.type == T_RULE ||
+            current.type == T_GAME) {
+            break;
+        }
         ASTNode* property = parseEntityProperty();
         if (property) {
             entityNode->addProperty(property);
@@ -179,97 +242,211 @@ ASTNode* Parser::parseEntity() {
             synchronize();
         }
     }
-    consume(T_RBRACE, "Se esperaba '}' al final de entidad");
+    consume(T_RBRACE, MSG_EXPECTED_ENTITY_RBRACE);
     return entityNode;
 }
 ASTNode* Parser::parseEntityProperty() {
     if (current.type == T_SPAWN || current.type == T_COLOR || current.type == T_SOLID) {
-        std::string key = current.lexeme;
+        Symbol key = symbolOf(current);
         advance();
-        consume(T_COLON, "Se esperaba ':' después de propiedad de entidad");
+        consume(T_COLON, MSG_EXPECTED_PROPERTY_COLON);
         ASTNode* value = NULL;
-        if (key == "spawn") {
-            consume(T_LPAREN, "Se esperaba '(' para posición de spawn");
-            if (current.type != T_INT) {
-                error("Se esperaba coordenada X para spawn");
+        if (key.text == "spawn") {
+            consume(T_LPAREN, MSG_EXPECTED_SPAWN_LPAREN);
+            int x = 0;
+            if (!parseConstant(&x, MSG_EXPECTED_SPAWN_X)) {
                 return NULL;
             }
-            int x = StringUtils::toInt(current.lexeme);
-            advance();
-            consume(T_COMMA, "Se esperaba ',' entre coordenadas");
-            if (current.type != T_INT) {
-                error("Se esperaba coordenada Y para spawn");
+            consume(T_COMMA, MSG_EXPECTED_SPAWN_COMMA);
+            int y = 0;
+            if (!parseConstant(&y, MSG_EXPECTED_SPAWN_Y)) {
                 return NULL;
             }
-            int y = StringUtils::toInt(current.lexeme);
-            advance();
-            consume(T_RPAREN, "Se esperaba ')' al final de spawn");
-            value = new PointNode(x, y);
-        } else if (key == "color") {
+            consume(T_RPAREN, MSG_EXPECTED_SPAWN_RPAREN);
+            value = new (*arena) PointNode(x, y);
+        } else if (key.text == "color") {
             if (current.type == T_HEXCOLOR) {
                 unsigned int color;
-                if (ColorUtils::parseHexColor(current.lexeme, &color)) {
-                    value = new HexColorNode(color);
+                if (ColorUtils::parseHexColor(current.text(), &color)) {
+                    value = new (*arena) HexColorNode(color);
                 } else {
-                    error("Color hexadecimal inválido");
+                    error(MSG_INVALID_HEX_COLOR);
                     return NULL;
                 }
                 advance();
             } else {
-                error("Se esperaba color hexadecimal");
+                error(MSG_EXPECTED_HEX_COLOR);
                 return NULL;
             }
-        } else if (key == "solid") {
+        } else if (key.text == "solid") {
             if (current.type == T_TRUE || current.type == T_FALSE) {
-                value = new BooleanNode(current.type == T_TRUE);
+                value = new (*arena) BooleanNode(current.type == T_TRUE);
                 advance();
             } else {
-                error("Se esperaba 'true' o 'false' para solid");
+                error(MSG_EXPECTED_SOLID_BOOLEAN);
                 return NULL;
             }
         }
-        consume(T_SEMICOLON, "Se esperaba ';' al final de propiedad");
-        return new SettingNode(key, value);
+        consume(T_SEMICOLON, MSG_EXPECTED_PROPERTY_SEMICOLON);
+        return new (*arena) SettingNode(key, value);
     } else {
-        error("Propiedad de entidad no reconocida");
+        error(MSG_UNKNOWN_PROPERTY);
         return NULL;
     }
 }
 ASTNode* Parser::parseControls() {
-    consume(T_CONTROLS, "Se esperaba 'controls'");
-    consume(T_LBRACE, "Se esperaba '{' después de 'controls'");
+    consume(T_CONTROLS, MSG_EXPECTED_CONTROLS);
+    consume(T_LBRACE, MSG_EXPECTED_CONTROLS_LBRACE);
     while (current.type != T_RBRACE && current.type != T_EOF) {
         advance(); 
     }
-    consume(T_RBRACE, "Se esperaba '}' al final de controls");
-    return new IdentifierNode("controls"); 
+    consume(T_RBRACE, MSG_EXPECTED_CONTROLS_RBRACE);
+    return new (*arena) IdentifierNode(interner->symbol(StringRef("controls", 8))); 
 }
 ASTNode* Parser::parseRule() {
-    consume(T_RULE, "Se esperaba 'rule'");
+    consume(T_RULE, MSG_EXPECTED_RULE);
     if (current.type != T_IDENT) {
-        error("Se esperaba nombre de regla");
+        error(MSG_EXPECTED_RULE_NAME);
         return NULL;
     }
-    std::string ruleName = current.lexeme;
+    Symbol ruleName = symbolOf(current);
     advance();
-    consume(T_LBRACE, "Se esperaba '{' después del nombre de regla");
+    consume(T_LBRACE, MSG_EXPECTED_RULE_LBRACE);
+    RuleNode* ruleNode = new (*arena) RuleNode(*arena, ruleName);
     while (current.type != T_RBRACE && current.type != T_EOF) {
-        advance(); 
+        // Igual que en parseEntity; 'rule' no, porque las reglas se anidan.
+        if (current.type == T_ENTITY || current.type == T_CONTROLS || current.type == T_GAME) {
+            break;
+        }
+        ASTNode* statement = parseRuleStatement();
+        if (statement) {
+            ruleNode->addStatement(statement);
+        }
+        if (hasError) {
+            synchronize();
+        }
     }
-    consume(T_RBRACE, "Se esperaba '}' al final de regla");
-    return new RuleNode(ruleName);
+    consume(T_RBRACE, MSG_EXPECTED_RULE_RBRACE);
+    return ruleNode;
 }
 ASTNode* Parser::parseExpression() {
-    return new IntegerNode(0);
+    return foldConstants(parseBinaryExpression(1));
 }
+// Precedencia por escalada: cada operador de precedencia >= minPrec se
+// asocia a la izquierda y su operando derecho solo toma operadores más fuertes.
 ASTNode* Parser::parseBinaryExpression(int minPrec) {
-    return new IntegerNode(0);
+    ASTNode* left = parsePrimary();
+    while (left && isOperator(current.type) && getOperatorPrecedence(current.type) >= minPrec) {
+        int prec = getOperatorPrecedence(current.type);
+        Symbol op = symbolOf(current);
+        advance();
+        ASTNode* right = parseBinaryExpression(prec + 1);
+        if (!right) {
+            return NULL;
+        }
+        left = new (*arena) BinaryOpNode(op, left, right);
+    }
+    return left;
 }
 ASTNode* Parser::parsePrimary() {
-    return new IntegerNode(0);
+    if (current.type == T_INT) {
+        int number;
+        if (!current.intValue(&number)) {
+            error(MSG_CONSTANT_OVERFLOW);
+            return NULL;
+        }
+        ASTNode* value = new (*arena) IntegerNode(number);
+        advance();
+        return value;
+    }
+    if (current.type == T_MINUS) {
+        Symbol op = symbolOf(current);
+        advance();
+        ASTNode* operand = parsePrimary();
+        if (!operand) {
+            return NULL;
+        }
+        return new (*arena) BinaryOpNode(op, new (*arena) IntegerNode(0), operand);
+    }
+    if (match(T_LPAREN)) {
+        ASTNode* inner = parseBinaryExpression(1);
+        consume(T_RPAREN, MSG_EXPECTED_EXPRESSION_RPAREN);
+        return hasError ? NULL : inner;
+    }
+    // Las variables del juego pueden coincidir con palabras reservadas (score, speed).
+    if (current.type == T_IDENT || current.type == T_SCORE || current.type == T_SPEED) {
+        ASTNode* name = new (*arena) IdentifierNode(symbolOf(current));
+        advance();
+        return name;
+    }
+    error(MSG_EXPECTED_OPERAND);
+    return NULL;
+}
+// Reduce a IntegerNode todo subárbol cuyos operandos son constantes, para que
+// la tabla de símbolos y el bytecode no evalúen nada que se conozca al compilar.
+ASTNode* Parser::foldConstants(ASTNode* node) {
+    if (!node || node->type != AST_BINARY_OP) {
+        return node;
+    }
+    BinaryOpNode* op = static_cast<BinaryOpNode*>(node);
+    op->left = foldConstants(op->left);
+    op->right = foldConstants(op->right);
+    if (op->left->type != AST_INTEGER || op->right->type != AST_INTEGER) {
+        return op;
+    }
+    long long a = static_cast<IntegerNode*>(op->left)->value;
+    long long b = static_cast<IntegerNode*>(op->right)->value;
+    const StringRef& text = op->operator_.text;
+    long long result = 0;
+    if (text == "+") result = a + b;
+    else if (text == "-") result = a - b;
+    else if (text == "*") result = a * b;
+    else if (text == "/") {
+        if (b == 0) {
+            error(MSG_DIVISION_BY_ZERO);
+            return op;
+        }
+        result = a / b;
+    }
+    else if (text == "==") result = a == b;
+    else if (text == "!=") result = a != b;
+    else if (text == "<") result = a < b;
+    else if (text == ">") result = a > b;
+    else if (text == "<=") result = a <= b;
+    else if (text == ">=") result = a >= b;
+    else return op;
+    if (result > INT_MAX || result < INT_MIN) {
+        error(MSG_CONSTANT_OVERFLOW);
+        return op;
+    }
+    return new (*arena) IntegerNode(static_cast<int>(result));
+}
+bool Parser::parseConstant(int* value, MessageId message, const MessageArg& argument) {
+    switch (current.type) {
+        case T_INT:
+        case T_MINUS:
+        case T_LPAREN:
+        case T_IDENT:
+        case T_SCORE:
+        case T_SPEED:
+            break;
+        default:
+            error(message, argument);
+            return false;
+    }
+    ASTNode* expression = parseExpression();
+    if (!expression || hasError) {
+        return false;
+    }
+    if (expression->type != AST_INTEGER) {
+        error(message, argument);
+        return false;
+    }
+    *value = static_cast<IntegerNode*>(expression)->value;
+    return true;
 }
 ASTNode* Parser::parsePoint() {
-    return new PointNode(0, 0);
+    return new (*arena) PointNode(0, 0);
 }
 ASTNode* Parser::parseSettings() {
     return NULL;
@@ -283,20 +460,216 @@ ASTNode* Parser::parseControl() {
 ASTNode* Parser::parseRules() {
     return NULL;
 }
+// Sentencias de una regla. Las que guardan una acción (collide, if, on press)
+// la parsean con parseAction; todas salvo las reglas anidadas terminan en ';'.
 ASTNode* Parser::parseRuleStatement() {
-    return NULL;
+    if (current.type == T_RULE) {
+        return parseRule();
+    }
+    ASTNode* statement = NULL;
+    if (current.type == T_TICK) {
+        statement = parseTickStatement();
+    } else if (current.type == T_COLLIDE) {
+        statement = parseCollideStatement();
+    } else if (current.type == T_IDENT && current.lexeme == "every" && checkAhead(1, T_COLON)) {
+        statement = parseEveryStatement();
+    } else if (current.type == T_IDENT && current.lexeme == "on") {
+        statement = parseOnStatement();
+    } else if (current.type == T_IDENT && current.lexeme == "if") {
+        statement = parseIfStatement();
+    } else {
+        statement = parseAction();
+    }
+    if (!statement) {
+        return NULL;
+    }
+    consume(T_SEMICOLON, MSG_EXPECTED_STATEMENT_SEMICOLON);
+    return statement;
+}
+// acción := 'lose' | 'score' ':' [+|-]N | 'spawn' ':' E | 'remove' ':' E
+//         | variable ':' [+|-]N | nombre ['(' args ')']
+ASTNode* Parser::parseAction() {
+    if (current.type == T_LOSE) {
+        return parseLoseStatement();
+    }
+    if (current.type == T_SCORE && checkAhead(1, T_COLON)) {
+        return parseScoreStatement();
+    }
+    bool isSpawn = current.type == T_SPAWN;
+    if ((isSpawn || (current.type == T_IDENT && current.lexeme == "remove")) && checkAhead(1, T_COLON)) {
+        advance();
+        advance();
+        if (current.type != T_IDENT) {
+            error(isSpawn ? MSG_EXPECTED_SPAWN_ENTITY : MSG_EXPECTED_REMOVE_ENTITY);
+            return NULL;
+        }
+        Symbol entity = symbolOf(current);
+        advance();
+        return new (*arena) EntityStmtNode(isSpawn ? AST_SPAWN_STMT : AST_REMOVE_STMT, entity);
+    }
+    if ((current.type == T_IDENT || current.type == T_SPEED) && checkAhead(1, T_COLON)) {
+        Symbol key = symbolOf(current);
+        advance();
+        advance();
+        char op = '=';
+        if (current.type == T_PLUS || current.type == T_MINUS) {
+            op = static_cast<char>(current.type);
+            advance();
+        }
+        ASTNode* value = parseExpression();
+        if (!value) {
+            return NULL;
+        }
+        return new (*arena) SetStmtNode(key, op, value);
+    }
+    if (current.type != T_IDENT) {
+        error(MSG_EXPECTED_ACTION);
+        return NULL;
+    }
+    CallStmtNode* call = new (*arena) CallStmtNode(*arena, symbolOf(current));
+    advance();
+    if (check(T_LPAREN) && !parseArguments(call->args)) {
+        return NULL;
+    }
+    return call;
+}
+bool Parser::parseArguments(NodeList& args) {
+    consume(T_LPAREN, MSG_EXPECTED_LPAREN);
+    while (!check(T_RPAREN) && !hasError) {
+        ASTNode* arg = parseExpression();
+        if (!arg) {
+            return false;
+        }
+        args.push_back(arg);
+        if (!match(T_COMMA)) {
+            break;
+        }
+    }
+    consume(T_RPAREN, MSG_EXPECTED_ARGUMENTS_RPAREN);
+    return !hasError;
 }
 ASTNode* Parser::parseTickStatement() {
-    return NULL;
+    consume(T_TICK, MSG_EXPECTED_TICK);
+    consume(T_COLON, MSG_EXPECTED_TICK_COLON);
+    if (current.type != T_IDENT) {
+        error(MSG_EXPECTED_TICK_ACTION);
+        return NULL;
+    }
+    TickStmtNode* tick = new (*arena) TickStmtNode(*arena, symbolOf(current));
+    advance();
+    if (check(T_LPAREN) && !parseArguments(tick->args)) {
+        return NULL;
+    }
+    return tick;
 }
 ASTNode* Parser::parseCollideStatement() {
-    return NULL;
+    consume(T_COLLIDE, MSG_EXPECTED_COLLIDE);
+    consume(T_COLON, MSG_EXPECTED_COLLIDE_COLON);
+    if (current.type != T_IDENT) {
+        error(MSG_EXPECTED_COLLIDE_FIRST);
+        return NULL;
+    }
+    Symbol first = symbolOf(current);
+    advance();
+    consume(T_COMMA, MSG_EXPECTED_COLLIDE_COMMA);
+    if (current.type != T_IDENT) {
+        error(MSG_EXPECTED_COLLIDE_SECOND);
+        return NULL;
+    }
+    Symbol second = symbolOf(current);
+    advance();
+    consume(T_COLON, MSG_EXPECTED_COLLIDE_ACTION_COLON);
+    ASTNode* action = hasError ? NULL : parseAction();
+    if (!action) {
+        return NULL;
+    }
+    return new (*arena) CollideStmtNode(first, second, action);
 }
 ASTNode* Parser::parseScoreStatement() {
-    return NULL;
+    consume(T_SCORE, MSG_EXPECTED_SCORE);
+    consume(T_COLON, MSG_EXPECTED_SCORE_COLON);
+    bool positive = true;
+    if (current.type == T_PLUS || current.type == T_MINUS) {
+        positive = current.type == T_PLUS;
+        advance();
+    }
+    if (current.type != T_INT) {
+        error(MSG_EXPECTED_SCORE_INTEGER);
+        return NULL;
+    }
+    int value;
+    if (!current.intValue(&value)) {
+        error(MSG_CONSTANT_OVERFLOW);
+        return NULL;
+    }
+    advance();
+    return new (*arena) ScoreStmtNode(positive, value);
 }
 ASTNode* Parser::parseLoseStatement() {
-    return NULL;
+    consume(T_LOSE, MSG_EXPECTED_LOSE);
+    return new (*arena) LoseStmtNode();
+}
+ASTNode* Parser::parseEveryStatement() {
+    advance();
+    consume(T_COLON, MSG_EXPECTED_EVERY_COLON);
+    int ticks = 0;
+    if (!parseConstant(&ticks, MSG_EXPECTED_POSITIVE_TICKS)) {
+        return NULL;
+    }
+    if (ticks <= 0) {
+        error(MSG_EXPECTED_POSITIVE_TICKS);
+        return NULL;
+    }
+    if (current.type != T_IDENT || current.lexeme != "ticks") {
+        error(MSG_EXPECTED_TICKS);
+        return NULL;
+    }
+    advance();
+    return new (*arena) EveryStmtNode(ticks);
+}
+// "on press K: acción", "on release K: acción" u "on: evento(args)".
+ASTNode* Parser::parseOnStatement() {
+    advance();
+    if (current.type == T_IDENT && (current.lexeme == "press" || current.lexeme == "release")) {
+        ASTNodeType type = current.lexeme == "press" ? AST_PRESS_STMT : AST_RELEASE_STMT;
+        advance();
+        if (current.type != T_IDENT) {
+            error(MSG_EXPECTED_KEY);
+            return NULL;
+        }
+        Symbol key = symbolOf(current);
+        advance();
+        consume(T_COLON, MSG_EXPECTED_KEY_COLON);
+        ASTNode* action = hasError ? NULL : parseAction();
+        if (!action) {
+            return NULL;
+        }
+        return new (*arena) InputStmtNode(type, key, action);
+    }
+    consume(T_COLON, MSG_EXPECTED_ON_COLON);
+    if (current.type != T_IDENT) {
+        error(MSG_EXPECTED_EVENT_NAME);
+        return NULL;
+    }
+    OnStmtNode* on = new (*arena) OnStmtNode(*arena, symbolOf(current));
+    advance();
+    if (check(T_LPAREN) && !parseArguments(on->args)) {
+        return NULL;
+    }
+    return on;
+}
+ASTNode* Parser::parseIfStatement() {
+    advance();
+    ASTNode* condition = parseExpression();
+    if (!condition) {
+        return NULL;
+    }
+    consume(T_COLON, MSG_EXPECTED_CONDITION_COLON);
+    ASTNode* action = hasError ? NULL : parseAction();
+    if (!action) {
+        return NULL;
+    }
+    return new (*arena) IfStmtNode(condition, action);
 }
 bool Parser::hasErrors() const {
     return hasError;
@@ -304,14 +677,38 @@ bool Parser::hasErrors() const {
 void Parser::resetError() {
     hasError = false;
 }
+// 0 para tokens que no son operadores binarios.
 int Parser::getOperatorPrecedence(TokenType type) const {
-    return 0;
+    switch (type) {
+        case T_EQUAL:
+        case T_NOTEQUAL:
+            return 1;
+        case T_LESS:
+        case T_GREATER:
+        case T_LESSEQ:
+        case T_GREATEREQ:
+            return 2;
+        case T_PLUS:
+        case T_MINUS:
+            return 3;
+        case T_MULTIPLY:
+        case T_DIVIDE:
+            return 4;
+        default:
+            return 0;
+    }
 }
 bool Parser::isOperator(TokenType type) const {
-    return false;
+    return getOperatorPrecedence(type) > 0;
 }
 std::string Parser::tokenToOperator(TokenType type) const {
-    return "";
+    switch (type) {
+        case T_EQUAL: return "==";
+        case T_NOTEQUAL: return "!=";
+        case T_LESSEQ: return "<=";
+        case T_GREATEREQ: return ">=";
+        default: return isOperator(type) ? std::string(1, static_cast<char>(type)) : "";
+    }
 }
 ASTNode* Parser::parseExpressionOnly() {
     return parseExpression();
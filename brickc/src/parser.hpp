@@ -1,25 +1,39 @@
 #ifndef PARSER_HPP
 #define PARSER_HPP
 #include "lexer.hpp"
+#include "token_stream.hpp"
 #include "ast.hpp"
 #include "error.hpp"
+#include "flat_ast.hpp"
 #include <string>
 namespace brick {
 class Parser {
 private:
-    Lexer* lexer;
+    TokenStream tokens;
     Token current;
+    AstArena localArena;
+    AstArena* arena;
+    StringInterner* interner;
     ErrorHandler* errorHandler;
     bool hasError;
+    // Fin del último token consumido: cierra el rango de cada bloque.
+    size_t previousEnd;
+    int previousLine;
+    int previousColumn;
     void advance();
     bool match(TokenType type);
     bool check(TokenType type) const;
-    void consume(TokenType type, const std::string& message);
-    void error(const std::string& message);
+    const Token& peek(size_t k);
+    bool checkAhead(size_t k, TokenType type);
+    void consume(TokenType type, MessageId message);
+    void error(MessageId message, const MessageArg& argument = MessageArg());
     void synchronize();
+    Symbol symbolOf(const Token& token);
     ASTNode* parseExpression();
     ASTNode* parseBinaryExpression(int minPrec = 0);
     ASTNode* parsePrimary();
+    ASTNode* foldConstants(ASTNode* node);
+    bool parseConstant(int* value, MessageId message, const MessageArg& argument = MessageArg());
     ASTNode* parsePoint();
     ASTNode* parseSettings();
     ASTNode* parseSetting();
@@ -35,13 +49,32 @@ private:
     ASTNode* parseCollideStatement();
     ASTNode* parseScoreStatement();
     ASTNode* parseLoseStatement();
+    ASTNode* parseEveryStatement();
+    ASTNode* parseOnStatement();
+    ASTNode* parseIfStatement();
+    ASTNode* parseAction();
+    bool parseArguments(NodeList& args);
     int getOperatorPrecedence(TokenType type) const;
     bool isOperator(TokenType type) const;
     std::string tokenToOperator(TokenType type) const;
 public:
-    explicit Parser(Lexer* lex, ErrorHandler* errHandler = NULL);
+    // Los nodos se crean en 'astArena'; sin él se usa un arena propio del
+    // parser y el árbol vive mientras viva el Parser.
+    explicit Parser(Lexer* lex, ErrorHandler* errHandler = NULL, AstArena* astArena = NULL);
     ASTNode* parseProgram();
+    // Como parseProgram(), pero cada elemento del juego se aplana en 'flat'
+    // apenas se analiza y su subárbol se descarta del arena: el árbol de
+    // punteros nunca tiene más de un bloque. false si falta 'game nombre'.
+    bool parseProgram(FlatAst& flat);
     ASTNode* parseGame();
+    // Las piezas de parseProgram, para quien reparsea el cuerpo del juego por
+    // bloques (IncrementalDocument): 'game nombre {', un elemento del cuerpo
+    // con su recuperación de errores (NULL si no produjo nodo) y el '}' final.
+    GameNode* parseGameHeader();
+    bool atGameEnd() const;
+    ASTNode* parseGameItem(SourceSpan* span);
+    ASTNode* finishGame(GameNode* gameNode);
+    const Token& currentToken() const;
     bool hasErrors() const;
     void resetError();
     ASTNode* parseExpressionOnly();
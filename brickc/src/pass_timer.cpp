@@ -0,0 +1,176 @@
+#include "pass_timer.hpp"
+#include "util.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#include <time.h>
+#endif
+namespace {
+using brick::MemoryUtils;
+void* countedAllocate(size_t size) {
+    void* memory = MemoryUtils::allocate(size ? size : 1);
+    if (!memory) {
+#ifdef BRICK_EXCEPTIONS
+        throw std::bad_alloc();
+#else
+        std::abort();
+#endif
+    }
+    return memory;
+}
+}
+void* operator new(size_t size) {
+    return countedAllocate(size);
+}
+void* operator new[](size_t size) {
+    return countedAllocate(size);
+}
+void operator delete(void* memory) throw() {
+    std::free(memory);
+}
+void operator delete[](void* memory) throw() {
+    std::free(memory);
+}
+namespace brick {
+PassTimer::PassTimer(bool enable)
+    : enabled(enable), running(false), startTime(0), startAllocations(0), startBytes(0) {
+    if (enabled) {
+        MemoryUtils::countAllocations = true;
+    }
+}
+PassTimer::~PassTimer() {
+    if (enabled) {
+        MemoryUtils::countAllocations = false;
+    }
+}
+bool PassTimer::isEnabled() const {
+    return enabled;
+}
+void PassTimer::begin(const char* name) {
+    if (!enabled) return;
+    if (running) {
+        end();
+    }
+    Pass pass;
+    pass.name = name;
+    pass.milliseconds = 0;
+    pass.tokens = 0;
+    pass.nodes = 0;
+    pass.allocations = 0;
+    pass.allocatedBytes = 0;
+    pass.peakRssKb = 0;
+    passes.push_back(pass);
+    running = true;
+    startAllocations = MemoryUtils::allocations;
+    startBytes = MemoryUtils::allocatedBytes;
+    startTime = now();
+}
+void PassTimer::end() {
+    if (!enabled || !running) return;
+    double elapsed = now() - startTime;
+    Pass& pass = passes.back();
+    pass.milliseconds = elapsed;
+    pass.allocations = MemoryUtils::allocations - startAllocations;
+    pass.allocatedBytes = MemoryUtils::allocatedBytes - startBytes;
+    pass.peakRssKb = peakRssKb();
+    running = false;
+}
+void PassTimer::setTokens(size_t count) {
+    if (!passes.empty()) passes.back().tokens = count;
+}
+void PassTimer::setNodes(size_t count) {
+    if (!passes.empty()) passes.back().nodes = count;
+}
+const std::vector<PassTimer::Pass>& PassTimer::getPasses() const {
+    return passes;
+}
+void PassTimer::print(std::ostream& out) const {
+    char line[160];
+    out << "\nTIEMPOS POR FASE:\n";
+    out << "=================\n";
+    BRICK_SNPRINTF(line, sizeof(line), "%-12s %10s %12s %8s %10s %12s %10s\n",
+                   "fase", "ms", "tokens/s", "nodos", "asign.", "bytes", "RSS KB");
+    out << line;
+    double total = 0;
+    size_t allocations = 0;
+    size_t bytes = 0;
+    long peak = 0;
+    for (size_t i = 0; i < passes.size(); ++i) {
+        const Pass& pass = passes[i];
+        char rate[32] = "-";
+        if (pass.tokens > 0 && pass.milliseconds > 0) {
+            BRICK_SNPRINTF(rate, sizeof(rate), "%.0f", pass.tokens * 1000.0 / pass.milliseconds);
+        }
+        char nodes[32] = "-";
+        if (pass.nodes > 0) {
+            BRICK_SNPRINTF(nodes, sizeof(nodes), "%lu", static_cast<unsigned long>(pass.nodes));
+        }
+        BRICK_SNPRINTF(line, sizeof(line), "%-12s %10.3f %12s %8s %10lu %12lu %10ld\n",
+                       pass.name, pass.milliseconds, rate, nodes,
+                       static_cast<unsigned long>(pass.allocations),
+                       static_cast<unsigned long>(pass.allocatedBytes), pass.peakRssKb);
+        out << line;
+        total += pass.milliseconds;
+        allocations += pass.allocations;
+        bytes += pass.allocatedBytes;
+        if (pass.peakRssKb > peak) peak = pass.peakRssKb;
+    }
+    BRICK_SNPRINTF(line, sizeof(line), "%-12s %10.3f %12s %8s %10lu %12lu %10ld\n",
+                   "total", total, "", "", static_cast<unsigned long>(allocations),
+                   static_cast<unsigned long>(bytes), peak);
+    out << line;
+}
+void PassTimer::printJSON(std::ostream& out) const {
+    char number[32];
+    out << "{\n  \"passes\": [\n";
+    for (size_t i = 0; i < passes.size(); ++i) {
+        const Pass& pass = passes[i];
+        BRICK_SNPRINTF(number, sizeof(number), "%.6f", pass.milliseconds);
+        out << "    {\"name\": \"" << pass.name << "\", \"ms\": " << number
+            << ", \"tokens\": " << pass.tokens
+            << ", \"nodes\": " << pass.nodes
+            << ", \"allocations\": " << pass.allocations
+            << ", \"allocated_bytes\": " << pass.allocatedBytes
+            << ", \"peak_rss_kb\": " << pass.peakRssKb << "}"
+            << (i + 1 < passes.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+double PassTimer::now() {
+#ifdef _WIN32
+    LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return counter.QuadPart * 1000.0 / frequency.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+#endif
+}
+long PassTimer::peakRssKb() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return 0;
+    }
+    return static_cast<long>(counters.PeakWorkingSetSize / 1024);
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+#endif
+}
+}
@@ -0,0 +1,50 @@
+#ifndef PASS_TIMER_HPP
+#define PASS_TIMER_HPP
+#include <cstddef>
+#include <iostream>
+#include <vector>
+namespace brick {
+// Mediciones de --time-passes. Cada fase guarda su tiempo de reloj, las
+// asignaciones (cantidad y bytes) y el pico de memoria residente del proceso
+// al terminarla. Se cuentan las hechas con new, por un operator new global, y
+// los bloques del arena, del interner y la copia del fuente, que pasan por
+// MemoryUtils::allocate(); un archivo mapeado con mmap no suma bytes. Solo se
+// cuenta mientras haya un PassTimer activo y el conteo no es seguro entre
+// hilos, por eso --time-passes no admite lotes.
+class PassTimer {
+public:
+    struct Pass {
+        const char* name;
+        double milliseconds;
+        size_t tokens;
+        size_t nodes;
+        size_t allocations;
+        size_t allocatedBytes;
+        long peakRssKb;
+    };
+private:
+    bool enabled;
+    bool running;
+    std::vector<Pass> passes;
+    double startTime;
+    size_t startAllocations;
+    size_t startBytes;
+    PassTimer(const PassTimer&);
+    PassTimer& operator=(const PassTimer&);
+public:
+    explicit PassTimer(bool enable);
+    ~PassTimer();
+    bool isEnabled() const;
+    void begin(const char* name);
+    void end();
+    // Datos de la última fase cerrada.
+    void setTokens(size_t count);
+    void setNodes(size_t count);
+    const std::vector<Pass>& getPasses() const;
+    void print(std::ostream& out) const;
+    void printJSON(std::ostream& out) const;
+    static double now();
+    static long peakRssKb();
+};
+}
+#endif
@@ -0,0 +1,186 @@
+#include "source.hpp"
+#include "util.hpp"
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+namespace brick {
+StringRef::StringRef() : data(""), length(0) {
+}
+StringRef::StringRef(const char* d, size_t n) : data(d), length(n) {
+}
+std::string StringRef::str() const {
+    return std::string(data, length);
+}
+bool StringRef::empty() const {
+    return length == 0;
+}
+bool StringRef::equals(const char* text) const {
+    size_t n = std::strlen(text);
+    return n == length && std::memcmp(data, text, n) == 0;
+}
+bool StringRef::operator==(const char* text) const {
+    return equals(text);
+}
+bool StringRef::operator!=(const char* text) const {
+    return !equals(text);
+}
+bool StringRef::operator==(const StringRef& other) const {
+    return length == other.length && std::memcmp(data, other.data, length) == 0;
+}
+bool StringRef::operator!=(const StringRef& other) const {
+    return !(*this == other);
+}
+SourceBuffer::SourceBuffer() : data_(""), size_(0), owned_(NULL), mapped_(false) {
+#ifdef _WIN32
+    fileHandle_ = INVALID_HANDLE_VALUE;
+    mappingHandle_ = NULL;
+#endif
+}
+SourceBuffer::~SourceBuffer() {
+    release();
+}
+void SourceBuffer::release() {
+    if (mapped_) {
+#ifdef _WIN32
+        UnmapViewOfFile(data_);
+        CloseHandle(mappingHandle_);
+        CloseHandle(fileHandle_);
+        fileHandle_ = INVALID_HANDLE_VALUE;
+        mappingHandle_ = NULL;
+#else
+        munmap(const_cast<char*>(data_), size_);
+#endif
+    }
+    std::free(owned_);
+    owned_ = NULL;
+    mapped_ = false;
+    data_ = "";
+    size_ = 0;
+}
+void SourceBuffer::assign(const char* text, size_t size) {
+    release();
+    owned_ = static_cast<char*>(MemoryUtils::allocate(size + 1));
+    if (!owned_) {
+        return;
+    }
+    std::memcpy(owned_, text, size);
+    owned_[size] = '\0';
+    data_ = owned_;
+    size_ = size;
+}
+bool SourceBuffer::openFile(const std::string& filename, bool mapFile) {
+    release();
+#ifdef _WIN32
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    DWORD size = GetFileSize(file, NULL);
+    if (size == INVALID_FILE_SIZE) {
+        CloseHandle(file);
+        return false;
+    }
+    SYSTEM_INFO system;
+    GetSystemInfo(&system);
+    if (!mapFile || size == 0 || size % system.dwPageSize == 0) {
+        // Sin bytes libres al final de la última página no hay centinela:
+        // se copia el archivo a un bloque propio.
+        owned_ = static_cast<char*>(MemoryUtils::allocate(size + 1));
+        DWORD got = 0;
+        if (!owned_ || (size > 0 && (!ReadFile(file, owned_, size, &got, NULL) || got != size))) {
+            CloseHandle(file);
+            release();
+            return false;
+        }
+        CloseHandle(file);
+        owned_[size] = '\0';
+        data_ = owned_;
+        size_ = size;
+        return true;
+    }
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    const void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+    if (!view) {
+        if (mapping) CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    fileHandle_ = file;
+    mappingHandle_ = mapping;
+    data_ = static_cast<const char*>(view);
+    size_ = size;
+    mapped_ = true;
+    return true;
+#else
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+        close(fd);
+        return false;
+    }
+    size_t size = static_cast<size_t>(info.st_size);
+    long pageSize = sysconf(_SC_PAGESIZE);
+    if (!mapFile || size == 0 || pageSize <= 0 || size % static_cast<size_t>(pageSize) == 0) {
+        // Sin bytes libres al final de la última página no hay centinela:
+        // se copia el archivo a un bloque propio.
+        bool ok = readFrom(fd, size);
+        close(fd);
+        return ok;
+    }
+    void* view = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (view == MAP_FAILED) {
+        bool ok = readFrom(fd, size);
+        close(fd);
+        return ok;
+    }
+    close(fd);
+    data_ = static_cast<const char*>(view);
+    size_ = size;
+    mapped_ = true;
+    return true;
+#endif
+}
+#ifndef _WIN32
+bool SourceBuffer::readFrom(int fd, size_t size) {
+    owned_ = static_cast<char*>(MemoryUtils::allocate(size + 1));
+    if (!owned_) {
+        return false;
+    }
+    size_t done = 0;
+    while (done < size) {
+        ssize_t got = read(fd, owned_ + done, size - done);
+        if (got <= 0) {
+            release();
+            return false;
+        }
+        done += static_cast<size_t>(got);
+    }
+    owned_[size] = '\0';
+    data_ = owned_;
+    size_ = size;
+    return true;
+}
+#endif
+const char* SourceBuffer::data() const {
+    return data_;
+}
+size_t SourceBuffer::size() const {
+    return size_;
+}
+bool SourceBuffer::isMapped() const {
+    return mapped_;
+}
+}
@@ -0,0 +1,52 @@
+#ifndef SOURCE_HPP
+#define SOURCE_HPP
+#include <string>
+#include <cstddef>
+namespace brick {
+// Vista (puntero, longitud) sobre texto que vive en otro lado. No copia ni libera.
+class StringRef {
+public:
+    const char* data;
+    size_t length;
+    StringRef();
+    StringRef(const char* d, size_t n);
+    std::string str() const;
+    bool empty() const;
+    bool equals(const char* text) const;
+    bool operator==(const char* text) const;
+    bool operator!=(const char* text) const;
+    bool operator==(const StringRef& other) const;
+    bool operator!=(const StringRef& other) const;
+};
+// Texto fuente leído una sola vez: copiado a un bloque propio, o mapeado en
+// memoria si se pide y se puede. Siempre hay un '\0' en data()[size()] para
+// que el lexer recorra el texto sin comprobar límites.
+class SourceBuffer {
+private:
+    const char* data_;
+    size_t size_;
+    char* owned_;
+    bool mapped_;
+#ifdef _WIN32
+    void* fileHandle_;
+    void* mappingHandle_;
+#endif
+#ifndef _WIN32
+    bool readFrom(int fd, size_t size);
+#endif
+    SourceBuffer(const SourceBuffer&);
+    SourceBuffer& operator=(const SourceBuffer&);
+public:
+    SourceBuffer();
+    ~SourceBuffer();
+    // mapFile solo sirve si nadie reescribe el archivo mientras se usa (el
+    // CLI): si se acorta estando mapeado, leer lo que sobraba da SIGBUS.
+    bool openFile(const std::string& filename, bool mapFile = false);
+    void assign(const char* text, size_t size);
+    void release();
+    const char* data() const;
+    size_t size() const;
+    bool isMapped() const;
+};
+}
+#endif
@@ -0,0 +1,134 @@
+#include "string_interner.hpp"
+#include "util.hpp"
+#include <cstdlib>
+#include <cstring>
+namespace brick {
+StringInterner::StringInterner() : blockUsed(0), blockSize(0) {
+    clear();
+}
+StringInterner::~StringInterner() {
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        std::free(blocks[i]);
+    }
+}
+void StringInterner::clear() {
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        std::free(blocks[i]);
+    }
+    blocks.clear();
+    blockUsed = 0;
+    blockSize = 0;
+    strings.assign(1, StringRef());
+    hashes.assign(1, hash("", 0));
+    slots.assign(64, NO_SYMBOL);
+}
+uint32_t StringInterner::hash(const char* text, size_t length) {
+    // FNV-1a
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < length; ++i) {
+        h ^= static_cast<unsigned char>(text[i]);
+        h *= 16777619u;
+    }
+    return h;
+}
+const char* StringInterner::store(const char* text, size_t length) {
+    if (blocks.empty() || blockSize - blockUsed < length + 1) {
+        size_t size = length + 1 > BLOCK_SIZE ? length + 1 : BLOCK_SIZE;
+        char* block = static_cast<char*>(MemoryUtils::allocate(size));
+        if (!block) {
+            return NULL;
+        }
+        blocks.push_back(block);
+        blockUsed = 0;
+        blockSize = size;
+    }
+    char* copy = blocks.back() + blockUsed;
+    std::memcpy(copy, text, length);
+    copy[length] = '\0';
+    blockUsed += length + 1;
+    return copy;
+}
+// Sondeo lineal: devuelve la ranura que contiene el texto o la primera vacía.
+size_t StringInterner::findSlot(const char* text, size_t length, uint32_t h) const {
+    size_t mask = slots.size() - 1;
+    size_t slot = h & mask;
+    while (slots[slot] != NO_SYMBOL) {
+        SymbolId id = slots[slot];
+        if (hashes[id] == h && strings[id].length == length &&
+            std::memcmp(strings[id].data, text, length) == 0) {
+            return slot;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+void StringInterner::grow() {
+    std::vector<SymbolId> old;
+    old.swap(slots);
+    slots.assign(old.size() * 2, NO_SYMBOL);
+    size_t mask = slots.size() - 1;
+    for (size_t i = 0; i < old.size(); ++i) {
+        if (old[i] == NO_SYMBOL) continue;
+        size_t slot = hashes[old[i]] & mask;
+        while (slots[slot] != NO_SYMBOL) {
+            slot = (slot + 1) & mask;
+        }
+        slots[slot] = old[i];
+    }
+}
+SymbolId StringInterner::intern(const char* text, size_t length) {
+    if (length == 0) {
+        return NO_SYMBOL;
+    }
+    uint32_t h = hash(text, length);
+    size_t slot = findSlot(text, length, h);
+    if (slots[slot] != NO_SYMBOL) {
+        return slots[slot];
+    }
+    const char* copy = store(text, length);
+    if (!copy) {
+        return NO_SYMBOL;
+    }
+    SymbolId id = static_cast<SymbolId>(strings.size());
+    strings.push_back(StringRef(copy, length));
+    hashes.push_back(h);
+    slots[slot] = id;
+    // Factor de carga máximo 1/2
+    if (strings.size() * 2 > slots.size()) {
+        grow();
+    }
+    return id;
+}
+SymbolId StringInterner::intern(const StringRef& text) {
+    return intern(text.data, text.length);
+}
+SymbolId StringInterner::intern(const std::string& text) {
+    return intern(text.data(), text.length());
+}
+SymbolId StringInterner::lookup(const char* text, size_t length) const {
+    if (length == 0) {
+        return NO_SYMBOL;
+    }
+    return slots[findSlot(text, length, hash(text, length))];
+}
+SymbolId StringInterner::lookup(const std::string& text) const {
+    return lookup(text.data(), text.length());
+}
+Symbol StringInterner::symbol(const StringRef& text) {
+    SymbolId id = intern(text);
+    return Symbol(id, strings[id]);
+}
+StringRef StringInterner::text(SymbolId id) const {
+    return id < strings.size() ? strings[id] : StringRef();
+}
+std::string StringInterner::str(SymbolId id) const {
+    return text(id).str();
+}
+size_t StringInterner::size() const {
+    return strings.size() - 1;
+}
+StringInterner& StringInterner::global() {
+    static StringInterner instance;
+    return instance;
+}
+}
@@ -0,0 +1,57 @@
+#ifndef STRING_INTERNER_HPP
+#define STRING_INTERNER_HPP
+#include "source.hpp"
+#include <stdint.h>
+#include <string>
+#include <vector>
+namespace brick {
+typedef uint32_t SymbolId;
+const SymbolId NO_SYMBOL = 0;
+// Nombre resuelto: el id para comparar y el texto (guardado en el interner)
+// para mostrar. Dos símbolos del mismo interner son iguales si sus ids lo son.
+class Symbol {
+public:
+    SymbolId id;
+    StringRef text;
+    Symbol() : id(NO_SYMBOL) {}
+    Symbol(SymbolId i, const StringRef& t) : id(i), text(t) {}
+    std::string str() const { return text.str(); }
+    bool operator==(const Symbol& other) const { return id == other.id; }
+    bool operator!=(const Symbol& other) const { return id != other.id; }
+};
+// Tabla de cadenas únicas con ids de 32 bits. El texto se copia una vez a
+// bloques que nunca se mueven, así que las vistas devueltas por text() son
+// válidas mientras viva el interner. El id 0 (NO_SYMBOL) es la cadena vacía.
+// No es seguro entre hilos: cada hilo de compilación debe usar el suyo.
+class StringInterner {
+private:
+    std::vector<char*> blocks;
+    size_t blockUsed;
+    size_t blockSize;
+    std::vector<StringRef> strings;
+    std::vector<uint32_t> hashes;
+    std::vector<SymbolId> slots;
+    const char* store(const char* text, size_t length);
+    size_t findSlot(const char* text, size_t length, uint32_t hash) const;
+    void grow();
+    static uint32_t hash(const char* text, size_t length);
+    StringInterner(const StringInterner&);
+    StringInterner& operator=(const StringInterner&);
+public:
+    static const size_t BLOCK_SIZE = 4096;
+    StringInterner();
+    ~StringInterner();
+    SymbolId intern(const char* text, size_t length);
+    SymbolId intern(const StringRef& text);
+    SymbolId intern(const std::string& text);
+    SymbolId lookup(const char* text, size_t length) const;
+    SymbolId lookup(const std::string& text) const;
+    Symbol symbol(const StringRef& text);
+    StringRef text(SymbolId id) const;
+    std::string str(SymbolId id) const;
+    size_t size() const;
+    void clear();
+    static StringInterner& global();
+};
+}
+#endif
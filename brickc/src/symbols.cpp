@@ -2,10 +2,41 @@
 #include "util.hpp"
 #include <iostream>
 #include <sstream>
+#include <algorithm>
 namespace brick {
-Entity::Entity() : spawn(0, 0), color(0), solid(false), isDefined(false) {
+namespace {
+const std::string& sortKey(const Entity& entity) {
+    return entity.name;
+}
+const std::string& sortKey(const Control& control) {
+    return control.input;
+}
+const std::string& sortKey(const Rule& rule) {
+    return rule.name;
+}
+template <typename T>
+bool lessByName(const T* a, const T* b) {
+    return sortKey(*a) < sortKey(*b);
+}
+// Las tablas guardan el orden de declaración; los listados se siguen
+// mostrando ordenados por nombre.
+template <typename T>
+void printSortedByName(std::ostream& out, const std::vector<T>& items) {
+    std::vector<const T*> sorted;
+    sorted.reserve(items.size());
+    for (size_t i = 0; i < items.size(); ++i) {
+        sorted.push_back(&items[i]);
+    }
+    std::sort(sorted.begin(), sorted.end(), lessByName<T>);
+    for (size_t i = 0; i < sorted.size(); ++i) {
+        out << "  " << sorted[i]->toString() << "\n";
+    }
+}
 }
-Entity::Entity(const std::string& n) : name(n), spawn(0, 0), color(0), solid(false), isDefined(true) {
+Entity::Entity() : id(NO_SYMBOL), spawn(0, 0), color(0), solid(false), isDefined(false) {
+}
+Entity::Entity(const Symbol& n)
+    : id(n.id), name(n.str()), spawn(0, 0), color(0), solid(false), isDefined(true) {
 }
 std::string Entity::toString() const {
     std::ostringstream oss;
@@ -23,35 +54,39 @@ void Entity::setColor(unsigned int col) {
 void Entity::setSolid(bool s) {
     solid = s;
 }
-Control::Control() {
+Control::Control() : inputId(NO_SYMBOL), actionId(NO_SYMBOL) {
 }
-Control::Control(const std::string& inp, const std::string& act) : input(inp), action(act) {
+Control::Control(const Symbol& inp, const Symbol& act)
+    : inputId(inp.id), actionId(act.id), input(inp.str()), action(act.str()) {
 }
 std::string Control::toString() const {
     return input + " -> " + action;
 }
-Rule::Rule() {
-}
-Rule::Rule(const std::string& n) : name(n) {
-}
-Rule::~Rule() {
+Rule::Rule() : id(NO_SYMBOL) {
 }
-void Rule::addStatement(ASTNode* stmt) {
-    if (stmt) {
-        statements.push_back(stmt);
-    }
+Rule::Rule(const Symbol& n) : id(n.id), name(n.str()) {
 }
 std::string Rule::toString() const {
     std::ostringstream oss;
-    oss << name << " {" << statements.size() << " statements}";
+    oss << name << " {" << code.size() << " bytes}";
     return oss.str();
 }
-SymbolTable::SymbolTable(ErrorHandler* errHandler)
+SymbolTable::SymbolTable(ErrorHandler* errHandler, StringInterner* interner)
     : speed_(0), gridWidth_(0), gridHeight_(0), gameColor_(0),
       lives_(0), score_(0),
       hasSpeed_(false), hasGrid_(false), hasColor_(false),
       hasLives_(false), hasScore_(false),
-      errorHandler_(errHandler) {
+      errorHandler_(errHandler),
+      interner_(interner ? interner : &StringInterner::global()) {
+}
+StringInterner* SymbolTable::getInterner() const {
+    return interner_;
+}
+void SymbolTable::setErrorHandler(ErrorHandler* errHandler) {
+    errorHandler_ = errHandler;
+}
+SymbolId SymbolTable::symbol(const std::string& name) const {
+    return interner_->lookup(name);
 }
 SymbolTable::~SymbolTable() {
     clear();
@@ -116,24 +151,36 @@ bool SymbolTable::hasLivesSetting() const {
 bool SymbolTable::hasScoreSetting() const {
     return hasScore_;
 }
-bool SymbolTable::addEntity(const std::string& name) {
-    if (entityExists(name)) {
-        reportError("Entidad '" + name + "' ya fue definida");
+bool SymbolTable::addEntity(const Symbol& name) {
+    if (entityExists(name.id)) {
+        reportError(MSG_ENTITY_REDEFINED, name.text);
         return false;
     }
-    entities_[name] = Entity(name);
+    entities_.insert(name.id, Entity(name));
     return true;
 }
+bool SymbolTable::addEntity(const std::string& name) {
+    return addEntity(interner_->symbol(StringRef(name.data(), name.length())));
+}
+Entity* SymbolTable::findEntity(SymbolId id) {
+    EntityId index = entities_.find(id);
+    return index != NO_ENTITY ? &entities_[index] : NULL;
+}
+const Entity* SymbolTable::findEntity(SymbolId id) const {
+    EntityId index = entities_.find(id);
+    return index != NO_ENTITY ? &entities_[index] : NULL;
+}
 Entity* SymbolTable::findEntity(const std::string& name) {
-    std::map<std::string, Entity>::iterator it = entities_.find(name);
-    return (it != entities_.end()) ? &it->second : NULL;
+    return findEntity(symbol(name));
 }
 const Entity* SymbolTable::findEntity(const std::string& name) const {
-    std::map<std::string, Entity>::const_iterator it = entities_.find(name);
-    return (it != entities_.end()) ? &it->second : NULL;
+    return findEntity(symbol(name));
+}
+bool SymbolTable::entityExists(SymbolId id) const {
+    return entities_.find(id) != NO_ENTITY;
 }
 bool SymbolTable::entityExists(const std::string& name) const {
-    return entities_.find(name) != entities_.end();
+    return entityExists(symbol(name));
 }
 void SymbolTable::setEntitySpawn(const std::string& name, int x, int y) {
     Entity* entity = findEntity(name);
@@ -153,143 +200,257 @@ void SymbolTable::setEntitySolid(const std::string& name, bool solid) {
         entity->setSolid(solid);
     }
 }
-const std::map<std::string, Entity>& SymbolTable::getEntities() const {
-    return entities_;
+EntityId SymbolTable::entityId(SymbolId id) const {
+    return entities_.find(id);
+}
+EntityId SymbolTable::entityId(const std::string& name) const {
+    return entityId(symbol(name));
+}
+Entity& SymbolTable::entity(EntityId id) {
+    return entities_[id];
+}
+const Entity& SymbolTable::entity(EntityId id) const {
+    return entities_[id];
+}
+const std::vector<Entity>& SymbolTable::getEntities() const {
+    return entities_.values();
 }
 size_t SymbolTable::getEntityCount() const {
     return entities_.size();
 }
-bool SymbolTable::addControl(const std::string& input, const std::string& action) {
-    if (controlExists(input)) {
-        reportError("Control '" + input + "' ya fue mapeado");
+bool SymbolTable::addControl(const Symbol& input, const Symbol& action) {
+    if (controlExists(input.id)) {
+        reportError(MSG_CONTROL_REDEFINED, input.text);
         return false;
     }
-    controls_[input] = Control(input, action);
+    controls_.insert(input.id, Control(input, action));
     return true;
 }
+bool SymbolTable::addControl(const std::string& input, const std::string& action) {
+    return addControl(interner_->symbol(StringRef(input.data(), input.length())),
+                      interner_->symbol(StringRef(action.data(), action.length())));
+}
+Control* SymbolTable::findControl(SymbolId input) {
+    uint32_t index = controls_.find(input);
+    return index != DenseTable<Control>::NONE ? &controls_[index] : NULL;
+}
+const Control* SymbolTable::findControl(SymbolId input) const {
+    uint32_t index = controls_.find(input);
+    return index != DenseTable<Control>::NONE ? &controls_[index] : NULL;
+}
 Control* SymbolTable::findControl(const std::string& input) {
-    std::map<std::string, Control>::iterator it = controls_.find(input);
-    return (it != controls_.end()) ? &it->second : NULL;
+    return findControl(symbol(input));
 }
 const Control* SymbolTable::findControl(const std::string& input) const {
-    std::map<std::string, Control>::const_iterator it = controls_.find(input);
-    return (it != controls_.end()) ? &it->second : NULL;
+    return findControl(symbol(input));
+}
+bool SymbolTable::controlExists(SymbolId input) const {
+    return controls_.find(input) != DenseTable<Control>::NONE;
 }
 bool SymbolTable::controlExists(const std::string& input) const {
-    return controls_.find(input) != controls_.end();
+    return controlExists(symbol(input));
 }
-const std::map<std::string, Control>& SymbolTable::getControls() const {
-    return controls_;
+const std::vector<Control>& SymbolTable::getControls() const {
+    return controls_.values();
 }
 size_t SymbolTable::getControlCount() const {
     return controls_.size();
 }
-bool SymbolTable::addRule(const std::string& name) {
-    if (ruleExists(name)) {
-        reportError("Regla '" + name + "' ya fue definida");
+bool SymbolTable::addRule(const Symbol& name) {
+    if (ruleExists(name.id)) {
+        reportError(MSG_RULE_REDEFINED, name.text);
         return false;
     }
-    rules_[name] = Rule(name);
+    rules_.insert(name.id, Rule(name));
     return true;
 }
+bool SymbolTable::addRule(const std::string& name) {
+    return addRule(interner_->symbol(StringRef(name.data(), name.length())));
+}
+Rule* SymbolTable::findRule(SymbolId id) {
+    uint32_t index = rules_.find(id);
+    return index != DenseTable<Rule>::NONE ? &rules_[index] : NULL;
+}
+const Rule* SymbolTable::findRule(SymbolId id) const {
+    uint32_t index = rules_.find(id);
+    return index != DenseTable<Rule>::NONE ? &rules_[index] : NULL;
+}
 Rule* SymbolTable::findRule(const std::string& name) {
-    std::map<std::string, Rule>::iterator it = rules_.find(name);
-    return (it != rules_.end()) ? &it->second : NULL;
+    return findRule(symbol(name));
 }
 const Rule* SymbolTable::findRule(const std::string& name) const {
-    std::map<std::string, Rule>::const_iterator it = rules_.find(name);
-    return (it != rules_.end()) ? &it->second : NULL;
+    return findRule(symbol(name));
 }
-bool SymbolTable::ruleExists(const std::string& name) const {
-    return rules_.find(name) != rules_.end();
+bool SymbolTable::ruleExists(SymbolId id) const {
+    return rules_.find(id) != DenseTable<Rule>::NONE;
 }
-void SymbolTable::addRuleStatement(const std::string& ruleName, ASTNode* statement) {
-    Rule* rule = findRule(ruleName);
-    if (rule) {
-        rule->addStatement(statement);
-    }
+bool SymbolTable::ruleExists(const std::string& name) const {
+    return ruleExists(symbol(name));
 }
-const std::map<std::string, Rule>& SymbolTable::getRules() const {
-    return rules_;
+const std::vector<Rule>& SymbolTable::getRules() const {
+    return rules_.values();
 }
 size_t SymbolTable::getRuleCount() const {
     return rules_.size();
 }
-bool SymbolTable::populateFromAST(ASTNode* ast) {
-    if (!ast) return false;
-    if (ast->type == AST_PROGRAM) {
-        ProgramNode* program = static_cast<ProgramNode*>(ast);
-        setGameName(program->gameName);
-        if (program->gameBody && program->gameBody->type == AST_GAME) {
-            GameNode* game = static_cast<GameNode*>(program->gameBody);
-            processGameNode(game);
+// Recorre el AST plano por rangos contiguos de índices; las reglas se
+// compilan a bytecode y se verifican aquí.
+bool SymbolTable::populateFromAST(const FlatAst& ast) {
+    NodeIndex program = ast.root();
+    if (program == INVALID_NODE || ast.kind(program) != AST_PROGRAM) {
+        return program != INVALID_NODE;
+    }
+    setGameName(ast.name(program).str());
+    if (ast.childCount(program) == 0 || ast.kind(ast.child(program, 0)) != AST_GAME) {
+        return true;
+    }
+    NodeIndex game = ast.child(program, 0);
+    uint32_t count = ast.childCount(game);
+    for (uint32_t i = 0; i < count; ++i) {
+        NodeIndex node = ast.child(game, i);
+        if (ast.kind(node) == AST_SETTING) {
+            processFlatSetting(ast, node);
         }
     }
-    return true;
-}
-void SymbolTable::processGameNode(GameNode* gameNode) {
-    for (size_t i = 0; i < gameNode->settings.size(); ++i) {
-        if (gameNode->settings[i]->type == AST_SETTING) {
-            SettingNode* setting = static_cast<SettingNode*>(gameNode->settings[i]);
-            processSettingNode(setting);
+    for (uint32_t i = 0; i < count; ++i) {
+        NodeIndex node = ast.child(game, i);
+        if (ast.kind(node) == AST_ENTITY) {
+            processFlatEntity(ast, node);
         }
     }
-    for (size_t i = 0; i < gameNode->entities.size(); ++i) {
-        if (gameNode->entities[i]->type == AST_ENTITY) {
-            EntityNode* entity = static_cast<EntityNode*>(gameNode->entities[i]);
-            processEntityNode(entity);
+    for (uint32_t i = 0; i < count; ++i) {
+        NodeIndex node = ast.child(game, i);
+        if (ast.kind(node) == AST_RULE) {
+            processFlatRule(ast, node);
         }
     }
-    for (size_t i = 0; i < gameNode->rules.size(); ++i) {
-        if (gameNode->rules[i]->type == AST_RULE) {
-            RuleNode* rule = static_cast<RuleNode*>(gameNode->rules[i]);
-            processRuleNode(rule);
+    return true;
+}
+void SymbolTable::defineBlock(const FlatAst& ast, NodeIndex node) {
+    switch (ast.kind(node)) {
+        case AST_SETTING:
+            processFlatSetting(ast, node);
+            break;
+        case AST_ENTITY: {
+            Entity* entity = findEntity(ast.payload(node));
+            if (!entity) {
+                processFlatEntity(ast, node);
+                break;
+            }
+            *entity = Entity(ast.symbol(node));
+            fillFlatEntity(ast, node, *entity);
+            break;
         }
+        case AST_RULE: {
+            Symbol name = ast.symbol(node);
+            Rule* rule = findRule(name.id);
+            if (!rule) {
+                processFlatRule(ast, node);
+            } else {
+                // Las anidadas de la definición anterior se van con ella.
+                std::vector<SymbolId> nested;
+                nested.swap(rule->nested);
+                for (size_t i = 0; i < nested.size(); ++i) {
+                    removeRule(nested[i]);
+                }
+                rule = findRule(name.id);
+                *rule = Rule(name);
+                compileFlatRule(ast, node, *rule);
+                addNestedRules(ast, node, name);
+            }
+            verifyRuleTree(name.id);
+            break;
+        }
+        default:
+            break;
     }
 }
-void SymbolTable::processSettingNode(SettingNode* settingNode) {
-    if (settingNode->key == "speed" && settingNode->value && settingNode->value->type == AST_INTEGER) {
-        IntegerNode* intNode = static_cast<IntegerNode*>(settingNode->value);
-        setSpeed(intNode->value);
-    } else if (settingNode->key == "grid" && settingNode->value && settingNode->value->type == AST_POINT) {
-        PointNode* pointNode = static_cast<PointNode*>(settingNode->value);
-        setGrid(pointNode->point.x, pointNode->point.y);
-    } else if (settingNode->key == "color" && settingNode->value && settingNode->value->type == AST_HEXCOLOR) {
-        HexColorNode* colorNode = static_cast<HexColorNode*>(settingNode->value);
-        setGameColor(colorNode->color);
-    } else if (settingNode->key == "lives" && settingNode->value && settingNode->value->type == AST_INTEGER) {
-        IntegerNode* intNode = static_cast<IntegerNode*>(settingNode->value);
-        setLives(intNode->value);
-    } else if (settingNode->key == "score" && settingNode->value && settingNode->value->type == AST_INTEGER) {
-        IntegerNode* intNode = static_cast<IntegerNode*>(settingNode->value);
-        setScore(intNode->value);
+bool SymbolTable::removeEntity(SymbolId id) {
+    return entities_.erase(id);
+}
+bool SymbolTable::removeRule(SymbolId id) {
+    const Rule* rule = findRule(id);
+    if (!rule) {
+        return false;
+    }
+    std::vector<SymbolId> nested = rule->nested;
+    for (size_t i = 0; i < nested.size(); ++i) {
+        removeRule(nested[i]);
+    }
+    return rules_.erase(id);
+}
+void SymbolTable::processFlatSetting(const FlatAst& ast, NodeIndex setting) {
+    if (ast.childCount(setting) == 0) return;
+    StringRef key = ast.name(setting);
+    NodeIndex value = ast.child(setting, 0);
+    ASTNodeType kind = ast.kind(value);
+    if (key == "speed" && kind == AST_INTEGER) {
+        setSpeed(ast.intValue(value));
+    } else if (key == "grid" && kind == AST_POINT) {
+        setGrid(ast.point(value).x, ast.point(value).y);
+    } else if (key == "color" && kind == AST_HEXCOLOR) {
+        setGameColor(ast.payload(value));
+    } else if (key == "lives" && kind == AST_INTEGER) {
+        setLives(ast.intValue(value));
+    } else if (key == "score" && kind == AST_INTEGER) {
+        setScore(ast.intValue(value));
     }
 }
-void SymbolTable::processEntityNode(EntityNode* entityNode) {
-    addEntity(entityNode->name);
-    for (size_t i = 0; i < entityNode->properties.size(); ++i) {
-        if (entityNode->properties[i]->type == AST_SETTING) {
-            SettingNode* prop = static_cast<SettingNode*>(entityNode->properties[i]);
-            if (prop->key == "spawn" && prop->value && prop->value->type == AST_POINT) {
-                PointNode* pointNode = static_cast<PointNode*>(prop->value);
-                setEntitySpawn(entityNode->name, pointNode->point.x, pointNode->point.y);
-            } else if (prop->key == "color" && prop->value && prop->value->type == AST_HEXCOLOR) {
-                HexColorNode* colorNode = static_cast<HexColorNode*>(prop->value);
-                setEntityColor(entityNode->name, colorNode->color);
-            } else if (prop->key == "solid" && prop->value && prop->value->type == AST_BOOLEAN) {
-                BooleanNode* boolNode = static_cast<BooleanNode*>(prop->value);
-                setEntitySolid(entityNode->name, boolNode->value);
-            }
+void SymbolTable::processFlatEntity(const FlatAst& ast, NodeIndex entityNode) {
+    Symbol name = ast.symbol(entityNode);
+    addEntity(name);
+    Entity* entity = findEntity(name.id);
+    if (entity) {
+        fillFlatEntity(ast, entityNode, *entity);
+    }
+}
+void SymbolTable::fillFlatEntity(const FlatAst& ast, NodeIndex entityNode, Entity& entity) {
+    for (uint32_t i = 0; i < ast.childCount(entityNode); ++i) {
+        NodeIndex prop = ast.child(entityNode, i);
+        if (ast.kind(prop) != AST_SETTING || ast.childCount(prop) == 0) continue;
+        StringRef key = ast.name(prop);
+        NodeIndex value = ast.child(prop, 0);
+        ASTNodeType kind = ast.kind(value);
+        if (key == "spawn" && kind == AST_POINT) {
+            entity.setSpawn(ast.point(value).x, ast.point(value).y);
+        } else if (key == "color" && kind == AST_HEXCOLOR) {
+            entity.setColor(ast.payload(value));
+        } else if (key == "solid" && kind == AST_BOOLEAN) {
+            entity.setSolid(ast.boolValue(value));
         }
     }
 }
-void SymbolTable::processControlNode(ControlNode* controlNode) {
-    addControl(controlNode->input, controlNode->action);
+void SymbolTable::processFlatRule(const FlatAst& ast, NodeIndex ruleNode) {
+    processFlatRule(ast, ruleNode, ast.symbol(ruleNode));
+}
+bool SymbolTable::processFlatRule(const FlatAst& ast, NodeIndex ruleNode, const Symbol& name) {
+    if (!addRule(name)) {
+        return false;
+    }
+    compileFlatRule(ast, ruleNode, *findRule(name.id));
+    addNestedRules(ast, ruleNode, name);
+    return true;
 }
-void SymbolTable::processRuleNode(RuleNode* ruleNode) {
-    addRule(ruleNode->name);
-    for (size_t i = 0; i < ruleNode->statements.size(); ++i) {
-        addRuleStatement(ruleNode->name, ruleNode->statements[i]);
+// Una regla anidada no tiene condición propia: si el padre la copiara en su
+// cuerpo correría cada vez que corre él. Se registra aparte como
+// 'padre.hija' para que el runtime la dispare por nombre.
+void SymbolTable::addNestedRules(const FlatAst& ast, NodeIndex ruleNode, const Symbol& parent) {
+    for (uint32_t i = 0; i < ast.childCount(ruleNode); ++i) {
+        NodeIndex child = ast.child(ruleNode, i);
+        if (ast.kind(child) != AST_RULE) {
+            continue;
+        }
+        std::string qualified = parent.str() + "." + ast.name(child).str();
+        Symbol name = interner_->symbol(StringRef(qualified.data(), qualified.length()));
+        if (processFlatRule(ast, child, name)) {
+            findRule(parent.id)->nested.push_back(name.id);
+        }
+    }
+}
+void SymbolTable::compileFlatRule(const FlatAst& ast, NodeIndex ruleNode, Rule& rule) {
+    RuleCompiler compiler(*interner_);
+    if (!compiler.compile(ast, ruleNode, rule.code)) {
+        reportError(MSG_RULE_NOT_COMPILED, rule.name, compiler.getError());
     }
 }
 bool SymbolTable::validate() {
@@ -302,7 +463,7 @@ bool SymbolTable::validate() {
 }
 bool SymbolTable::validateGameSettings() {
     if (gameName_.empty()) {
-        reportError("El juego debe tener un nombre");
+        reportError(MSG_GAME_WITHOUT_NAME);
         return false;
     }
     return true;
@@ -313,7 +474,35 @@ bool SymbolTable::validateEntities() {
 bool SymbolTable::validateControls() {
     return true;
 }
+// Verificación de carga: ningún bytecode se ejecuta sin pasar por aquí.
 bool SymbolTable::validateRules() {
+    bool valid = true;
+    for (uint32_t i = 0; i < rules_.size(); ++i) {
+        valid &= verifyRule(rules_[i]);
+    }
+    return valid;
+}
+bool SymbolTable::verifyRuleTree(SymbolId id) {
+    Rule* rule = findRule(id);
+    if (!rule) {
+        return false;
+    }
+    bool valid = verifyRule(*rule);
+    std::vector<SymbolId> nested = rule->nested;
+    for (size_t i = 0; i < nested.size(); ++i) {
+        valid &= verifyRuleTree(nested[i]);
+    }
+    return valid;
+}
+bool SymbolTable::verifyRule(Rule& rule) {
+    if (rule.code.empty()) {
+        return true;
+    }
+    std::string message;
+    if (!verifyBytecode(rule.code, interner_->size(), &message, &rule.code.maxStack)) {
+        reportError(MSG_RULE_INVALID_BYTECODE, rule.name, message);
+        return false;
+    }
     return true;
 }
 void SymbolTable::print(std::ostream& out) const {
@@ -326,20 +515,11 @@ void SymbolTable::print(std::ostream& out) const {
     if (hasLives_) out << "Vidas: " << lives_ << "\n";
     if (hasScore_) out << "Puntaje: " << score_ << "\n";
     out << "\nEntidades (" << entities_.size() << "):\n";
-    for (std::map<std::string, Entity>::const_iterator it = entities_.begin(); 
-         it != entities_.end(); ++it) {
-        out << "  " << it->second.toString() << "\n";
-    }
+    printSortedByName(out, entities_.values());
     out << "\nControles (" << controls_.size() << "):\n";
-    for (std::map<std::string, Control>::const_iterator it = controls_.begin(); 
-         it != controls_.end(); ++it) {
-        out << "  " << it->second.toString() << "\n";
-    }
+    printSortedByName(out, controls_.values());
     out << "\nReglas (" << rules_.size() << "):\n";
-    for (std::map<std::string, Rule>::const_iterator it = rules_.begin(); 
-         it != rules_.end(); ++it) {
-        out << "  " << it->second.toString() << "\n";
-    }
+    printSortedByName(out, rules_.values());
 }
 void SymbolTable::printJSON(std::ostream& out) const {
     out << "{\n";
@@ -368,45 +548,12 @@ void SymbolTable::clear() {
     speed_ = 0;
     gridWidth_ = gridHeight_ = 0;
     gameColor_ = 0;
-    hasSpeed_ = hasGrid_ = hasColor_ = false;
+    lives_ = score_ = 0;
+    hasSpeed_ = hasGrid_ = hasColor_ = hasLives_ = hasScore_ = false;
 }
-void SymbolTable::reportError(const std::string& message) {
+void SymbolTable::reportError(MessageId message, const MessageArg& first, const MessageArg& second) {
     if (errorHandler_) {
-        errorHandler_->reportSemanticError(0, 0, message);
+        errorHandler_->report(ERROR_SEMANTIC, 0, 0, message, first, second);
     }
 }
-SymbolTableVisitor::SymbolTableVisitor(SymbolTable* table) : symbolTable_(table) {
-}
-void SymbolTableVisitor::visitProgram(ProgramNode& node) {
-}
-void SymbolTableVisitor::visitGame(GameNode& node) {
-}
-void SymbolTableVisitor::visitSetting(SettingNode& node) {
-}
-void SymbolTableVisitor::visitEntity(EntityNode& node) {
-}
-void SymbolTableVisitor::visitControl(ControlNode& node) {
-}
-void SymbolTableVisitor::visitRule(RuleNode& node) {
-}
-void SymbolTableVisitor::visitTickStmt(TickStmtNode& node) {
-}
-void SymbolTableVisitor::visitCollideStmt(CollideStmtNode& node) {
-}
-void SymbolTableVisitor::visitScoreStmt(ScoreStmtNode& node) {
-}
-void SymbolTableVisitor::visitLoseStmt(LoseStmtNode& node) {
-}
-void SymbolTableVisitor::visitIdentifier(IdentifierNode& node) {
-}
-void SymbolTableVisitor::visitInteger(IntegerNode& node) {
-}
-void SymbolTableVisitor::visitHexColor(HexColorNode& node) {
-}
-void SymbolTableVisitor::visitBoolean(BooleanNode& node) {
-}
-void SymbolTableVisitor::visitPoint(PointNode& node) {
-}
-void SymbolTableVisitor::visitBinaryOp(BinaryOpNode& node) {
-}
 } 
@@ -1,21 +1,29 @@
 #ifndef SYMBOLS_HPP
 #define SYMBOLS_HPP
 #include "ast.hpp"
+#include "bytecode.hpp"
+#include "dense_table.hpp"
+#include "flat_ast.hpp"
+#include "string_interner.hpp"
 #include "error.hpp"
 #include <string>
 #include <vector>
-#include <map>
 namespace brick {
 class SymbolTable;
+// Posición de una entidad en la tabla, en orden de declaración. Se resuelve
+// una vez (entityId) y después cada acceso es indexar un arreglo.
+typedef uint32_t EntityId;
+const EntityId NO_ENTITY = DenseTable<int>::NONE;
 class Entity {
 public:
+    SymbolId id;
     std::string name;
     Point spawn;
     unsigned int color;
     bool solid;
     bool isDefined;
     Entity();
-    Entity(const std::string& n);
+    explicit Entity(const Symbol& n);
     std::string toString() const;
     void setSpawn(int x, int y);
     void setColor(unsigned int col);
@@ -23,20 +31,25 @@ public:
 };
 class Control {
 public:
+    SymbolId inputId;
+    SymbolId actionId;
     std::string input;
     std::string action;
     Control();
-    Control(const std::string& inp, const std::string& act);
+    Control(const Symbol& inp, const Symbol& act);
     std::string toString() const;
 };
 class Rule {
 public:
+    SymbolId id;
     std::string name;
-    std::vector<ASTNode*> statements;
+    // Cuerpo compilado.
+    Bytecode code;
+    // Reglas anidadas: cada una es una regla aparte llamada 'padre.hija' que
+    // el cuerpo del padre no ejecuta.
+    std::vector<SymbolId> nested;
     Rule();
-    explicit Rule(const std::string& n);
-    ~Rule();
-    void addStatement(ASTNode* stmt);
+    explicit Rule(const Symbol& n);
     std::string toString() const;
 };
 class SymbolTable {
@@ -48,17 +61,24 @@ private:
     unsigned int gameColor_;
     int lives_;
     int score_;
-    std::map<std::string, Entity> entities_;
-    std::map<std::string, Control> controls_;
-    std::map<std::string, Rule> rules_;
+    // Contiguas en orden de declaración, buscadas por id de símbolo.
+    DenseTable<Entity> entities_;
+    DenseTable<Control> controls_;
+    DenseTable<Rule> rules_;
     bool hasSpeed_;
     bool hasGrid_;
     bool hasColor_;
     bool hasLives_;
     bool hasScore_;
     ErrorHandler* errorHandler_;
+    StringInterner* interner_;
 public:
-    explicit SymbolTable(ErrorHandler* errHandler = NULL);
+    // Los nombres se resuelven con 'interner', que debe ser el mismo del
+    // Lexer que produjo el AST (por defecto, el global).
+    explicit SymbolTable(ErrorHandler* errHandler = NULL, StringInterner* interner = NULL);
+    StringInterner* getInterner() const;
+    void setErrorHandler(ErrorHandler* errHandler);
+    SymbolId symbol(const std::string& name) const;
     ~SymbolTable();
     void setGameName(const std::string& name);
     void setSpeed(int speed);
@@ -78,29 +98,52 @@ public:
     bool hasColorSetting() const;
     bool hasLivesSetting() const;
     bool hasScoreSetting() const;
+    bool addEntity(const Symbol& name);
     bool addEntity(const std::string& name);
+    Entity* findEntity(SymbolId id);
+    const Entity* findEntity(SymbolId id) const;
     Entity* findEntity(const std::string& name);
     const Entity* findEntity(const std::string& name) const;
+    bool entityExists(SymbolId id) const;
     bool entityExists(const std::string& name) const;
     void setEntitySpawn(const std::string& name, int x, int y);
     void setEntityColor(const std::string& name, unsigned int color);
     void setEntitySolid(const std::string& name, bool solid);
-    const std::map<std::string, Entity>& getEntities() const;
+    // NO_ENTITY si no existe. El id vale hasta que se borre una entidad.
+    EntityId entityId(SymbolId id) const;
+    EntityId entityId(const std::string& name) const;
+    Entity& entity(EntityId id);
+    const Entity& entity(EntityId id) const;
+    const std::vector<Entity>& getEntities() const;
     size_t getEntityCount() const;
+    bool addControl(const Symbol& input, const Symbol& action);
     bool addControl(const std::string& input, const std::string& action);
+    Control* findControl(SymbolId input);
+    const Control* findControl(SymbolId input) const;
     Control* findControl(const std::string& input);
     const Control* findControl(const std::string& input) const;
+    bool controlExists(SymbolId input) const;
     bool controlExists(const std::string& input) const;
-    const std::map<std::string, Control>& getControls() const;
+    const std::vector<Control>& getControls() const;
     size_t getControlCount() const;
+    bool addRule(const Symbol& name);
     bool addRule(const std::string& name);
+    Rule* findRule(SymbolId id);
+    const Rule* findRule(SymbolId id) const;
     Rule* findRule(const std::string& name);
     const Rule* findRule(const std::string& name) const;
+    bool ruleExists(SymbolId id) const;
     bool ruleExists(const std::string& name) const;
-    void addRuleStatement(const std::string& ruleName, ASTNode* statement);
-    const std::map<std::string, Rule>& getRules() const;
+    const std::vector<Rule>& getRules() const;
     size_t getRuleCount() const;
-    bool populateFromAST(ASTNode* ast);
+    bool populateFromAST(const FlatAst& ast);
+    // Actualización por bloques (IncrementalDocument): 'node' es un ajuste,
+    // una entidad o una regla de primer nivel. Redefinir un nombre reemplaza
+    // la definición anterior en su lugar, sin reportarla como duplicada; las
+    // reglas se compilan y verifican en el momento.
+    void defineBlock(const FlatAst& ast, NodeIndex node);
+    bool removeEntity(SymbolId id);
+    bool removeRule(SymbolId id);
     bool validate();
     bool validateGameSettings();
     bool validateEntities();
@@ -111,34 +154,16 @@ public:
     void printSummary(std::ostream& out = std::cout) const;
     void clear();
 private:
-    void reportError(const std::string& message);
-    void processGameNode(GameNode* gameNode);
-    void processSettingNode(SettingNode* settingNode);
-    void processEntityNode(EntityNode* entityNode);
-    void processControlNode(ControlNode* controlNode);
-    void processRuleNode(RuleNode* ruleNode);
-};
-class SymbolTableVisitor : public Visitor {
-private:
-    SymbolTable* symbolTable_;
-public:
-    explicit SymbolTableVisitor(SymbolTable* table);
-    void visitProgram(ProgramNode& node);
-    void visitGame(GameNode& node);
-    void visitSetting(SettingNode& node);
-    void visitEntity(EntityNode& node);
-    void visitControl(ControlNode& node);
-    void visitRule(RuleNode& node);
-    void visitTickStmt(TickStmtNode& node);
-    void visitCollideStmt(CollideStmtNode& node);
-    void visitScoreStmt(ScoreStmtNode& node);
-    void visitLoseStmt(LoseStmtNode& node);
-    void visitIdentifier(IdentifierNode& node);
-    void visitInteger(IntegerNode& node);
-    void visitHexColor(HexColorNode& node);
-    void visitBoolean(BooleanNode& node);
-    void visitPoint(PointNode& node);
-    void visitBinaryOp(BinaryOpNode& node);
+    void reportError(MessageId message, const MessageArg& first = MessageArg(), const MessageArg& second = MessageArg());
+    bool verifyRule(Rule& rule);
+    bool verifyRuleTree(SymbolId id);
+    void processFlatSetting(const FlatAst& ast, NodeIndex setting);
+    void processFlatEntity(const FlatAst& ast, NodeIndex entity);
+    void processFlatRule(const FlatAst& ast, NodeIndex rule);
+    bool processFlatRule(const FlatAst& ast, NodeIndex rule, const Symbol& name);
+    void addNestedRules(const FlatAst& ast, NodeIndex ruleNode, const Symbol& parent);
+    void fillFlatEntity(const FlatAst& ast, NodeIndex entityNode, Entity& entity);
+    void compileFlatRule(const FlatAst& ast, NodeIndex ruleNode, Rule& rule);
 };
 } 
 #endif 
@@ -0,0 +1,158 @@
+#include "thread_pool.hpp"
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
+namespace brick {
+#ifdef _WIN32
+Mutex::Mutex() : handle(new CRITICAL_SECTION) {
+    InitializeCriticalSection(static_cast<CRITICAL_SECTION*>(handle));
+}
+Mutex::~Mutex() {
+    DeleteCriticalSection(static_cast<CRITICAL_SECTION*>(handle));
+    delete static_cast<CRITICAL_SECTION*>(handle);
+}
+void Mutex::lock() {
+    EnterCriticalSection(static_cast<CRITICAL_SECTION*>(handle));
+}
+void Mutex::unlock() {
+    LeaveCriticalSection(static_cast<CRITICAL_SECTION*>(handle));
+}
+#else
+Mutex::Mutex() : handle(new pthread_mutex_t) {
+    pthread_mutex_init(static_cast<pthread_mutex_t*>(handle), NULL);
+}
+Mutex::~Mutex() {
+    pthread_mutex_destroy(static_cast<pthread_mutex_t*>(handle));
+    delete static_cast<pthread_mutex_t*>(handle);
+}
+void Mutex::lock() {
+    pthread_mutex_lock(static_cast<pthread_mutex_t*>(handle));
+}
+void Mutex::unlock() {
+    pthread_mutex_unlock(static_cast<pthread_mutex_t*>(handle));
+}
+#endif
+MutexLock::MutexLock(Mutex& m) : mutex(m) {
+    mutex.lock();
+}
+MutexLock::~MutexLock() {
+    mutex.unlock();
+}
+WorkStealingPool::WorkStealingPool(unsigned int threadCount)
+    : threads(threadCount > 0 ? threadCount : 1), task(NULL), context(NULL), stolen(0) {
+    for (unsigned int i = 0; i < threads; ++i) {
+        queues.push_back(new Queue());
+    }
+}
+WorkStealingPool::~WorkStealingPool() {
+    for (size_t i = 0; i < queues.size(); ++i) {
+        delete queues[i];
+    }
+}
+void WorkStealingPool::run(size_t count, Task function, void* data) {
+    task = function;
+    context = data;
+    stolen = 0;
+    for (size_t i = 0; i < threads; ++i) {
+        size_t begin = count * i / threads;
+        size_t end = count * (i + 1) / threads;
+        for (size_t index = begin; index < end; ++index) {
+            queues[i]->tasks.push_back(index);
+        }
+    }
+    std::vector<Worker> workers(threads);
+    for (size_t i = 0; i < threads; ++i) {
+        workers[i].pool = this;
+        workers[i].id = i;
+    }
+#ifdef _WIN32
+    std::vector<HANDLE> handles;
+    for (size_t i = 1; i < threads; ++i) {
+        HANDLE handle = CreateThread(NULL, 0, threadMain, &workers[i], 0, NULL);
+        if (handle) {
+            handles.push_back(handle);
+        }
+    }
+    work(0);
+    for (size_t i = 0; i < handles.size(); ++i) {
+        WaitForSingleObject(handles[i], INFINITE);
+        CloseHandle(handles[i]);
+    }
+#else
+    std::vector<pthread_t> handles;
+    for (size_t i = 1; i < threads; ++i) {
+        pthread_t handle;
+        if (pthread_create(&handle, NULL, threadMain, &workers[i]) == 0) {
+            handles.push_back(handle);
+        }
+    }
+    work(0);
+    for (size_t i = 0; i < handles.size(); ++i) {
+        pthread_join(handles[i], NULL);
+    }
+#endif
+}
+// Si no se pudo crear algún hilo, sus tareas acaban robadas por los demás.
+void WorkStealingPool::work(size_t id) {
+    size_t index;
+    while (popLocal(id, &index) || steal(id, &index)) {
+        task(index, context);
+    }
+}
+bool WorkStealingPool::popLocal(size_t id, size_t* index) {
+    Queue& queue = *queues[id];
+    MutexLock lock(queue.mutex);
+    if (queue.tasks.empty()) {
+        return false;
+    }
+    *index = queue.tasks.back();
+    queue.tasks.pop_back();
+    return true;
+}
+bool WorkStealingPool::steal(size_t id, size_t* index) {
+    for (size_t offset = 1; offset < threads; ++offset) {
+        Queue& victim = *queues[(id + offset) % threads];
+        MutexLock lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            *index = victim.tasks.front();
+            victim.tasks.pop_front();
+            MutexLock statsLock(statsMutex);
+            ++stolen;
+            return true;
+        }
+    }
+    return false;
+}
+#ifdef _WIN32
+unsigned long __stdcall WorkStealingPool::threadMain(void* worker) {
+    Worker* self = static_cast<Worker*>(worker);
+    self->pool->work(self->id);
+    return 0;
+}
+#else
+void* WorkStealingPool::threadMain(void* worker) {
+    Worker* self = static_cast<Worker*>(worker);
+    self->pool->work(self->id);
+    return NULL;
+}
+#endif
+unsigned int WorkStealingPool::threadCount() const {
+    return threads;
+}
+size_t WorkStealingPool::stolenCount() const {
+    return stolen;
+}
+unsigned int WorkStealingPool::hardwareThreads() {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? info.dwNumberOfProcessors : 1;
+#else
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? static_cast<unsigned int>(count) : 1;
+#endif
+}
+}
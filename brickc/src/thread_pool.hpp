@@ -0,0 +1,74 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+#include <cstddef>
+#include <deque>
+#include <vector>
+namespace brick {
+// Mutex mínimo sobre pthreads o CRITICAL_SECTION (std::mutex no existe en
+// todos los MinGW que generan binarios para Windows XP).
+class Mutex {
+private:
+    void* handle;
+    Mutex(const Mutex&);
+    Mutex& operator=(const Mutex&);
+public:
+    Mutex();
+    ~Mutex();
+    void lock();
+    void unlock();
+};
+class MutexLock {
+private:
+    Mutex& mutex;
+    MutexLock(const MutexLock&);
+    MutexLock& operator=(const MutexLock&);
+public:
+    explicit MutexLock(Mutex& m);
+    ~MutexLock();
+};
+// Ejecuta 'count' tareas indexadas en varios hilos con robo de trabajo. Cada
+// hilo recibe un bloque contiguo de índices y los saca del final de su cola;
+// al vaciarla roba del principio de la de otro hilo, así los archivos grandes
+// no dejan hilos parados. Como no se crean tareas nuevas, un hilo termina
+// cuando no encuentra nada que robar.
+class WorkStealingPool {
+public:
+    typedef void (*Task)(size_t index, void* context);
+private:
+    struct Queue {
+        Mutex mutex;
+        std::deque<size_t> tasks;
+    };
+    struct Worker {
+        WorkStealingPool* pool;
+        size_t id;
+    };
+    unsigned int threads;
+    std::vector<Queue*> queues;
+    Task task;
+    void* context;
+    size_t stolen;
+    Mutex statsMutex;
+    bool popLocal(size_t id, size_t* index);
+    bool steal(size_t id, size_t* index);
+    void work(size_t id);
+#ifdef _WIN32
+    static unsigned long __stdcall threadMain(void* worker);
+#else
+    static void* threadMain(void* worker);
+#endif
+    WorkStealingPool(const WorkStealingPool&);
+    WorkStealingPool& operator=(const WorkStealingPool&);
+public:
+    explicit WorkStealingPool(unsigned int threadCount);
+    ~WorkStealingPool();
+    // Bloquea hasta terminar todas las tareas. El hilo que llama trabaja
+    // como uno más.
+    void run(size_t count, Task function, void* data);
+    unsigned int threadCount() const;
+    // Tareas que se ejecutaron en un hilo distinto del asignado.
+    size_t stolenCount() const;
+    static unsigned int hardwareThreads();
+};
+}
+#endif
@@ -0,0 +1,49 @@
+#include "token_stream.hpp"
+namespace brick {
+TokenStream::TokenStream(Lexer* lex, size_t initialCapacity)
+    : lexer(lex), mask(0), head(0), count(0) {
+    size_t capacity = 1;
+    while (capacity < initialCapacity) {
+        capacity <<= 1;
+    }
+    ring.resize(capacity);
+    mask = capacity - 1;
+}
+void TokenStream::grow() {
+    std::vector<Token> larger(ring.size() * 2);
+    for (size_t i = 0; i < count; ++i) {
+        larger[i] = ring[(head + i) & mask];
+    }
+    ring.swap(larger);
+    mask = ring.size() - 1;
+    head = 0;
+}
+void TokenStream::fill(size_t n) {
+    while (count < n) {
+        if (count == ring.size()) {
+            grow();
+        }
+        ring[(head + count) & mask] = lexer ? lexer->nextToken() : Token();
+        count++;
+    }
+}
+const Token& TokenStream::peek(size_t k) {
+    fill(k + 1);
+    return ring[(head + k) & mask];
+}
+Token TokenStream::next() {
+    fill(1);
+    Token token = ring[head];
+    head = (head + 1) & mask;
+    count--;
+    return token;
+}
+void TokenStream::skip(size_t n) {
+    fill(n);
+    head = (head + n) & mask;
+    count -= n;
+}
+size_t TokenStream::buffered() const {
+    return count;
+}
+}
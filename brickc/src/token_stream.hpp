@@ -0,0 +1,25 @@
+#ifndef TOKEN_STREAM_HPP
+#define TOKEN_STREAM_HPP
+#include "lexer.hpp"
+#include <vector>
+namespace brick {
+// Buffer circular de tokens entre el Lexer y el Parser. peek(k) mira k tokens
+// por delante sin volver a escanear: cada token se lexea una sola vez.
+class TokenStream {
+private:
+    Lexer* lexer;
+    std::vector<Token> ring;
+    size_t mask;
+    size_t head;
+    size_t count;
+    void fill(size_t n);
+    void grow();
+public:
+    explicit TokenStream(Lexer* lex, size_t initialCapacity = 8);
+    const Token& peek(size_t k = 0);
+    Token next();
+    void skip(size_t n = 1);
+    size_t buffered() const;
+};
+}
+#endif
@@ -5,8 +5,25 @@
 #include <cctype>
 #include <cstdarg>
 #include <cstdio>
+#include <cstdlib>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
 namespace brick {
 bool Debug::enabled_ = false;
+bool MemoryUtils::countAllocations = false;
+size_t MemoryUtils::allocations = 0;
+size_t MemoryUtils::allocatedBytes = 0;
+void* MemoryUtils::allocate(size_t size) {
+    if (countAllocations) {
+        ++allocations;
+        allocatedBytes += size;
+    }
+    return std::malloc(size);
+}
 std::string StringUtils::trim(const std::string& str) {
     return trimLeft(trimRight(str));
 }
@@ -144,7 +161,11 @@ bool ColorUtils::isValidHexColor(const std::string& hex) {
 std::string FileUtils::readFile(const std::string& filename) {
     std::ifstream file(filename.c_str(), std::ios::binary);
     if (!file.is_open()) {
+#ifdef BRICK_EXCEPTIONS
         throw std::runtime_error("No se pudo abrir el archivo: " + filename);
+#else
+        return "";
+#endif
     }
     std::ostringstream oss;
     oss << file.rdbuf();
@@ -176,6 +197,57 @@ std::string FileUtils::getBasename(const std::string& filename) {
     }
     return filename.substr(sepPos + 1);
 }
+bool FileUtils::isDirectory(const std::string& path) {
+#ifdef _WIN32
+    DWORD attributes = GetFileAttributesA(path.c_str());
+    return attributes != INVALID_FILE_ATTRIBUTES && (attributes & FILE_ATTRIBUTE_DIRECTORY);
+#else
+    struct stat info;
+    return stat(path.c_str(), &info) == 0 && S_ISDIR(info.st_mode);
+#endif
+}
+bool FileUtils::listFiles(const std::string& dir, const std::string& extension,
+                          std::vector<std::string>& files) {
+    std::string base = dir;
+    if (!base.empty() && base[base.size() - 1] != '/' && base[base.size() - 1] != '\\') {
+        base += PATH_SEPARATOR;
+    }
+    std::vector<std::string> names;
+#ifdef _WIN32
+    WIN32_FIND_DATAA entry;
+    HANDLE handle = FindFirstFileA((base + "*").c_str(), &entry);
+    if (handle == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    do {
+        names.push_back(entry.cFileName);
+    } while (FindNextFileA(handle, &entry));
+    FindClose(handle);
+#else
+    DIR* handle = opendir(dir.c_str());
+    if (!handle) {
+        return false;
+    }
+    struct dirent* entry;
+    while ((entry = readdir(handle)) != NULL) {
+        names.push_back(entry->d_name);
+    }
+    closedir(handle);
+#endif
+    std::sort(names.begin(), names.end());
+    for (size_t i = 0; i < names.size(); ++i) {
+        if (names[i] == "." || names[i] == "..") {
+            continue;
+        }
+        std::string path = base + names[i];
+        if (isDirectory(path)) {
+            listFiles(path, extension, files);
+        } else if (StringUtils::endsWith(names[i], extension)) {
+            files.push_back(path);
+        }
+    }
+    return true;
+}
 void Debug::setEnabled(bool enable) {
     enabled_ = enable;
 }
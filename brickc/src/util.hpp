@@ -57,11 +57,23 @@ public:
     static std::string joinPath(const std::string& dir, const std::string& file);
     static bool isAbsolutePath(const std::string& path);
     static std::string absolutePath(const std::string& path);
+    static bool isDirectory(const std::string& path);
+    // Agrega a 'files' los archivos con esa extensión (".brick") que hay bajo
+    // 'dir', recorriendo subdirectorios, en orden alfabético por ruta.
+    static bool listFiles(const std::string& dir, const std::string& extension,
+                          std::vector<std::string>& files);
 private:
     static char getPathSeparator();
 };
 class MemoryUtils {
 public:
+    // Contadores de --time-passes. Los suman el operator new de pass_timer.cpp
+    // y allocate(), que usan en lugar de std::malloc los bloques del arena,
+    // del interner y la copia del fuente.
+    static bool countAllocations;
+    static size_t allocations;
+    static size_t allocatedBytes;
+    static void* allocate(size_t size);
     template<typename T>
     static void safeDelete(T*& ptr) {
         delete ptr;
@@ -84,6 +96,13 @@ public:
     static void printAST(class ASTNode* root, int indent = 0);
     static void printSymbolTable(const class SymbolTable& table);
 };
+// CMakeLists compila con -fno-exceptions (/EHs-c- en MSVC); try/throw solo
+// se usan cuando el compilador los admite.
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS) || defined(_CPPUNWIND)
+    #define BRICK_EXCEPTIONS
+#endif
+// Versión del compilador; forma parte de la clave de las imágenes en caché.
+#define BRICKC_VERSION "1.0.0"
 #ifdef _WIN32
     #define PATH_SEPARATOR '\\'
     #define LINE_ENDING "\r\n"
@@ -0,0 +1,227 @@
+// Pruebas de IncrementalDocument: después de cada edición la tabla de
+// símbolos y los diagnósticos tienen que ser los mismos que da un load() del
+// texto resultante. Las reglas pueden quedar en otro orden, así que se
+// comparan ordenadas.
+#include "../src/incremental.hpp"
+#include "../src/bytecode.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <vector>
+using namespace brick;
+namespace {
+int failures = 0;
+const char* BASE_PROGRAM =
+    "game prueba {\n"
+    "    speed: 4;\n"
+    "    grid: (20, 15);\n"
+    "    color: #102030;\n"
+    "    lives: 3;\n"
+    "    // jugador\n"
+    "    entity player {\n"
+    "        spawn: (2, 3);\n"
+    "        color: #00FF00;\n"
+    "        solid: true;\n"
+    "    }\n"
+    "    entity wall {\n"
+    "        color: #666666;\n"
+    "        solid: true;\n"
+    "    }\n"
+    "    controls {\n"
+    "        w: up;\n"
+    "        s: down;\n"
+    "    }\n"
+    "    rule movement {\n"
+    "        tick: move_forward();\n"
+    "        collide: player, wall: lose_life();\n"
+    "    }\n"
+    "    rule scoring {\n"
+    "        score: +10;\n"
+    "        every 3: spawn wall;\n"
+    "        rule bonus {\n"
+    "            score: +2 * 5;\n"
+    "        }\n"
+    "    }\n"
+    "}\n"
+    "// fin\n";
+// Tabla de símbolos y diagnósticos como líneas ordenadas.
+std::vector<std::string> snapshot(const IncrementalDocument& document) {
+    std::vector<std::string> lines;
+    const SymbolTable& table = document.getSymbols();
+    std::ostringstream settings;
+    settings << "game " << table.getGameName() << " speed " << table.hasSpeedSetting() << table.getSpeed()
+             << " grid " << table.hasGridSetting() << table.getGridWidth() << "x" << table.getGridHeight()
+             << " color " << table.hasColorSetting() << table.getGameColor()
+             << " lives " << table.hasLivesSetting() << table.getLives()
+             << " score " << table.hasScoreSetting() << table.getScore();
+    lines.push_back(settings.str());
+    const std::vector<Entity>& entities = table.getEntities();
+    for (size_t i = 0; i < entities.size(); ++i) {
+        lines.push_back("entity " + entities[i].toString());
+    }
+    const std::vector<Control>& controls = table.getControls();
+    for (size_t i = 0; i < controls.size(); ++i) {
+        lines.push_back("control " + controls[i].toString());
+    }
+    const std::vector<Rule>& rules = table.getRules();
+    for (size_t i = 0; i < rules.size(); ++i) {
+        std::ostringstream rule;
+        rule << "rule " << rules[i].name << " nested";
+        std::vector<std::string> nested;
+        for (size_t n = 0; n < rules[i].nested.size(); ++n) {
+            nested.push_back(table.getInterner()->text(rules[i].nested[n]).str());
+        }
+        std::sort(nested.begin(), nested.end());
+        for (size_t n = 0; n < nested.size(); ++n) {
+            rule << " " << nested[n];
+        }
+        rule << "\n";
+        disassemble(rules[i].code, *table.getInterner(), rule);
+        lines.push_back(rule.str());
+    }
+    ErrorHandler errors;
+    document.diagnostics(errors);
+    for (size_t i = 0; i < errors.getErrorCount(); ++i) {
+        lines.push_back("error " + errors.getError(i).toString());
+    }
+    std::ostringstream count;
+    count << "errores " << document.getErrorCount() << " " << document.hasErrors();
+    lines.push_back(count.str());
+    std::sort(lines.begin(), lines.end());
+    return lines;
+}
+void printDifference(const std::vector<std::string>& got, const std::vector<std::string>& expected) {
+    for (size_t i = 0; i < got.size(); ++i) {
+        if (!std::binary_search(expected.begin(), expected.end(), got[i])) {
+            std::printf("  sobra:  %s\n", got[i].c_str());
+        }
+    }
+    for (size_t i = 0; i < expected.size(); ++i) {
+        if (!std::binary_search(got.begin(), got.end(), expected[i])) {
+            std::printf("  falta:  %s\n", expected[i].c_str());
+        }
+    }
+}
+// Aplica la edición y compara con un documento cargado de cero.
+bool editAndCompare(IncrementalDocument& document, size_t begin, size_t end, const std::string& text,
+                    const char* what) {
+    document.edit(begin, end, text);
+    IncrementalDocument fresh;
+    fresh.load(document.text());
+    std::vector<std::string> got = snapshot(document);
+    std::vector<std::string> expected = snapshot(fresh);
+    if (got == expected) {
+        return true;
+    }
+    failures++;
+    std::printf("FALLO %s: edit(%lu, %lu, \"%s\")\n", what, static_cast<unsigned long>(begin),
+                static_cast<unsigned long>(end), text.c_str());
+    printDifference(got, expected);
+    std::printf("--- texto ---\n%s\n-------------\n", document.text().c_str());
+    return false;
+}
+// Reemplaza la primera aparición de 'from' por 'to'.
+bool replaceText(IncrementalDocument& document, const std::string& from, const std::string& to,
+                 const char* what) {
+    std::string text = document.text();
+    size_t at = text.find(from);
+    if (at == std::string::npos) {
+        failures++;
+        std::printf("FALLO %s: no se encontró \"%s\"\n", what, from.c_str());
+        return false;
+    }
+    return editAndCompare(document, at, at + from.size(), to, what);
+}
+void testTrickyEdits() {
+    IncrementalDocument document;
+    document.load(BASE_PROGRAM);
+    replaceText(document, "rule movement", "rule moving", "renombrar regla");
+    replaceText(document, "entity wall", "entity brick", "renombrar entidad");
+    replaceText(document, "collide: player, wall", "collide: player, brick", "usar la entidad renombrada");
+    replaceText(document, "    controls {",
+                "    entity player {\n        color: #FFFFFF;\n    }\n    controls {", "entidad duplicada");
+    replaceText(document, "rule scoring {", "rule moving {", "regla duplicada");
+    replaceText(document, "rule moving {", "rule movement {", "deshacer el duplicado");
+    replaceText(document, "    entity player {\n        color: #FFFFFF;\n    }\n", "", "quitar la entidad duplicada");
+    replaceText(document, "lose_life();\n    }", "lose_life();\n", "borrar una llave de cierre");
+    replaceText(document, "lose_life();\n", "lose_life();\n    }", "devolver la llave");
+    replaceText(document, "score: +10;", "score: +10; {", "llave abierta de más");
+    replaceText(document, "score: +10; {", "score: +10;", "quitar la llave abierta");
+    replaceText(document, "rule bonus", "rule extra", "renombrar regla anidada");
+    replaceText(document, "// fin\n", "// fin\nrule afuera { score: +1; }\n", "texto después del juego");
+    replaceText(document, "rule afuera { score: +1; }\n", "", "quitar el texto del final");
+    replaceText(document, "}\n// fin", "", "borrar la llave del juego");
+    replaceText(document, "    }\n\n", "    }\n}\n// fin", "devolver la llave del juego");
+    replaceText(document, "speed: 4;", "speed: 9;", "cambiar un ajuste");
+    replaceText(document, "game prueba", "game otra", "cambiar el encabezado");
+    replaceText(document, "tick: move_forward();", "tick: move_forward(;", "error de sintaxis");
+    replaceText(document, "tick: move_forward(;", "tick: move_forward();", "corregir el error");
+    replaceText(document, "every 3:", "every 3 / 0:", "error semántico");
+    replaceText(document, "every 3 / 0:", "every 3:", "corregir el error semántico");
+}
+// Generador congruencial fijo: las fallas se reproducen igual en cualquier
+// plataforma.
+unsigned int nextRandom(unsigned int* state) {
+    *state = *state * 1103515245u + 12345u;
+    return (*state >> 16) & 0x7FFF;
+}
+void testRandomEdits() {
+    static const char* const SNIPPETS[] = {
+        "{", "}", "}\n", "\n", " ", ";", "x", "wall", "player",
+        "rule r { score: +1; }\n",
+        "rule movement { tick: stop(); }\n",
+        "entity player { solid: false; }\n",
+        "entity e { spawn: (1, 2); }\n",
+        "rule n { rule m { lose_life(); } }\n",
+        "speed: 7;\n",
+        "// comentario\n",
+        "/* bloque */",
+        "collide: player, wall: lose_life();\n",
+        "every 2 * 3: remove wall;\n",
+        "game g {\n",
+        "99999999999"
+    };
+    const size_t SNIPPET_COUNT = sizeof(SNIPPETS) / sizeof(SNIPPETS[0]);
+    const int EDITS = 3000;
+    unsigned int state = 2024;
+    IncrementalDocument document;
+    document.load(BASE_PROGRAM);
+    for (int i = 0; i < EDITS && failures == 0; ++i) {
+        // De vez en cuando se vuelve al programa base para que el texto no
+        // termine siendo solo basura.
+        if (i % 100 == 0) {
+            document.load(BASE_PROGRAM);
+        }
+        size_t length = document.size();
+        size_t begin = length == 0 ? 0 : nextRandom(&state) % (length + 1);
+        size_t end = begin;
+        std::string text;
+        switch (nextRandom(&state) % 3) {
+            case 0:
+                end = std::min(length, begin + nextRandom(&state) % 12);
+                break;
+            case 1:
+                text = SNIPPETS[nextRandom(&state) % SNIPPET_COUNT];
+                break;
+            default:
+                end = std::min(length, begin + nextRandom(&state) % 4);
+                text = SNIPPETS[nextRandom(&state) % SNIPPET_COUNT];
+                break;
+        }
+        char what[32];
+        std::sprintf(what, "edición al azar %d", i);
+        editAndCompare(document, begin, end, text, what);
+    }
+}
+}
+int main() {
+    testTrickyEdits();
+    testRandomEdits();
+    if (failures > 0) {
+        std::printf("%d prueba(s) fallaron\n", failures);
+        return 1;
+    }
+    std::printf("incremental: todas las pruebas pasaron\n");
+    return 0;
+}
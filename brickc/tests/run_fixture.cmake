@@ -0,0 +1,21 @@
+# Compila tests/<CASE>.brick con brickc y compara la salida (stdout y stderr
+# juntos) y el código de salida con tests/<CASE>.expected.
+#
+# Uso: cmake -DBRICKC=<brickc> -DCASE=<caso> [-DOPTIONS=<opciones>]
+#            -P run_fixture.cmake
+# desde el directorio tests/, para que los mensajes lleven rutas relativas.
+
+execute_process(
+    COMMAND ${BRICKC} ${OPTIONS} ${CASE}.brick
+    OUTPUT_VARIABLE output
+    ERROR_VARIABLE output
+    RESULT_VARIABLE code
+)
+set(actual "${output}[salida: ${code}]\n")
+
+file(READ ${CASE}.expected expected)
+if(NOT actual STREQUAL expected)
+    message(FATAL_ERROR "La salida de ${CASE} no coincide con ${CASE}.expected\n"
+                        "--- esperada ---\n${expected}"
+                        "--- obtenida ---\n${actual}")
+endif()
@@ -3,24 +3,64 @@
 
 #include <string>
 #include <memory>
-#include <map>
+#include <vector>
+#include <cstdint>
 
 namespace brick {
     class SymbolTable;
     class ErrorHandler;
     class Entity;
+    class AstArena;
+    class StringInterner;
+    typedef uint32_t SymbolId;
+    typedef uint32_t EntityId;
 }
 
+// What a game listing needs, read from the "game <name> {" header and the
+// literal top-level settings that precede the first entity, controls or rule
+// block. Unset values keep BrickLoader's defaults.
+struct GameMetadata {
+    bool valid;
+    std::string name;
+    bool hasSpeed;
+    bool hasGrid;
+    bool hasColor;
+    int speed;
+    int gridWidth;
+    int gridHeight;
+    unsigned int color;
+    
+    GameMetadata();
+};
+
 class BrickLoader {
 private:
     std::unique_ptr<brick::SymbolTable> symbolTable_;
     std::unique_ptr<brick::ErrorHandler> errorHandler_;
+    // Reused across loads: the AST is discarded in one reset() once the
+    // symbol table has been built, keeping the first chunk for the next file.
+    std::unique_ptr<brick::AstArena> astArena_;
+    // Owned per loader (the interner is not thread-safe) and kept across
+    // loads so ids handed out to games stay valid after a reload.
+    std::unique_ptr<brick::StringInterner> interner_;
+    
+    // Both rebuild symbolTable_ from image records (BrickImage::populate):
+    // no parsing, but not a zero-copy view either.
+    bool loadBrickImage(const std::string& filename, uint64_t sourceHash);
+    bool loadCached(uint64_t sourceHash);
     
 public:
     BrickLoader();
     ~BrickLoader();
     
     bool loadBrickFile(const std::string& filename);
+    // Exchanges everything, interner included: ids resolved from 'other'
+    // must be resolved again afterwards.
+    void swap(BrickLoader& other);
+    // Lexes at most the first PROBE_BYTES of the file, without parsing or
+    // validating it: a valid result does not mean the game compiles.
+    static GameMetadata probeMetadata(const std::string& filename);
+    static const size_t PROBE_BYTES = 4096;
     const brick::SymbolTable* getSymbolTable() const;
     bool isLoaded() const;
     std::string getGameName() const;
@@ -32,8 +72,19 @@ public:
     int getScore() const;
     std::string getErrorMessages() const;
     
-    const std::map<std::string, brick::Entity>& getEntities() const;
+    // Resolve a name once (e.g. at load time) and use the id afterwards:
+    // id lookups are a single integer compare per probe.
+    brick::SymbolId symbol(const std::string& name) const;
+    // Position of an entity in declaration order, NO_ENTITY if undefined.
+    // entity() is then a plain array index; null for NO_ENTITY. Resolve
+    // again after swap().
+    brick::EntityId entityId(const std::string& name) const;
+    const brick::Entity* entity(brick::EntityId id) const;
+    // In declaration order.
+    const std::vector<brick::Entity>& getEntities() const;
+    const brick::Entity* findEntity(brick::SymbolId id) const;
     const brick::Entity* findEntity(const std::string& name) const;
+    bool hasEntity(brick::SymbolId id) const;
     bool hasEntity(const std::string& name) const;
 };
 
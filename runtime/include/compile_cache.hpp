@@ -0,0 +1,64 @@
+#ifndef COMPILE_CACHE_HPP
+#define COMPILE_CACHE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace brick {
+    class SymbolTable;
+}
+
+// Persistent cache of validated symbol tables, stored as .brickb images.
+// Entries are named after a hash of the source bytes mixed with the
+// compiler and image format versions, so an edited file or a new compiler
+// simply misses; nothing has to be tracked per path.
+class CompileCache {
+public:
+    struct Stats {
+        unsigned long hits;
+        unsigned long misses;
+        unsigned long stores;
+    };
+
+    explicit CompileCache(const std::string& directory);
+
+    // Process-wide cache in $BRICK_CACHE_DIR, else $XDG_CACHE_HOME/brick,
+    // else ~/.cache/brick.
+    static CompileCache& shared();
+    static std::string defaultDirectory();
+
+    const std::string& directory() const;
+    static uint64_t keyFor(uint64_t sourceHash);
+    std::string entryPath(uint64_t sourceHash) const;
+
+    // Fills 'table' (empty, with its own interner and error handler) from
+    // the entry for this source and validates it. Errors go to the table's
+    // handler; the caller clears them and falls back on a miss.
+    bool load(uint64_t sourceHash, brick::SymbolTable& table);
+    // Written to a temporary name and renamed, so concurrent loaders never
+    // see a partial entry.
+    bool store(const brick::SymbolTable& table, uint64_t sourceHash);
+    // Drops the entry for the current contents of 'sourceFile'.
+    bool invalidate(const std::string& sourceFile);
+    // Removes every entry; returns how many files were deleted.
+    size_t clear();
+
+    Stats stats() const;
+    void resetStats();
+
+private:
+    std::string directory_;
+    std::atomic<unsigned long> hits_;
+    std::atomic<unsigned long> misses_;
+    std::atomic<unsigned long> stores_;
+    std::atomic<unsigned long> tempCounter_;
+
+    bool ensureDirectory() const;
+
+    CompileCache(const CompileCache&) = delete;
+    CompileCache& operator=(const CompileCache&) = delete;
+};
+
+#endif // COMPILE_CACHE_HPP
@@ -1,10 +1,12 @@
 #ifndef GAME_ENGINE_HPP
 #define GAME_ENGINE_HPP
 
+#include "renderer.hpp"
 #include <SDL2/SDL.h>
+#include <cstdint>
 #include <string>
+#include <unordered_map>
 #include <vector>
-#include <map>
 
 struct Point {
     int x, y;
@@ -29,43 +31,183 @@ struct Color {
     }
 };
 
+// Describes an entity to create; the engine keeps each field in its own
+// array, so this is not what it stores.
 struct Entity {
-    std::string name;
     Point position;
     Color color;
     int width, height;
     bool solid;
     bool visible;
     
-    Entity(const std::string& name = "", const Point& pos = Point(0, 0),
-           const Color& col = Color(255, 255, 255), int w = 1, int h = 1)
-        : name(name), position(pos), color(col), width(w), height(h), 
-          solid(true), visible(true) {}
+    Entity(const Point& pos = Point(0, 0), const Color& col = Color(255, 255, 255), int w = 1, int h = 1)
+        : position(pos), color(col), width(w), height(h), solid(true), visible(true) {}
 };
 
+// Refers to an engine entity: a slot index and the generation the slot had
+// when the entity was created. Destroying the entity bumps the generation,
+// so old handles stop resolving even after the slot is reused.
+struct EntityHandle {
+    static const uint32_t INVALID_INDEX = 0xFFFFFFFFu;
+    uint32_t index;
+    uint32_t generation;
+    
+    EntityHandle() : index(INVALID_INDEX), generation(0) {}
+    EntityHandle(uint32_t index, uint32_t generation) : index(index), generation(generation) {}
+    
+    bool operator==(const EntityHandle& other) const {
+        return index == other.index && generation == other.generation;
+    }
+    
+    bool operator!=(const EntityHandle& other) const {
+        return !(*this == other);
+    }
+};
+
+// Occupancy layers of the SpatialGrid; queries take several or'ed together.
+enum GridLayer {
+    LAYER_SOLID = 1 << 0,
+    LAYER_SNAKE = 1 << 1,
+    LAYER_TANK = 1 << 2,
+    LAYER_WALL = 1 << 3,
+    LAYER_DESTRUCTIBLE = 1 << 4,
+    LAYER_PICKUP = 1 << 5
+};
+
+// ============================================================================
+// Spatial Grid - What occupies each cell, by layer
+// ============================================================================
+
+// Each cell keeps a count per layer (a snake that grows stacks segments on
+// one cell) and a byte with the bit of every layer whose count is not zero,
+// so occupied() is one load. Games update it when something moves instead
+// of scanning their lists on every query. Cells outside the grid are never
+// occupied and changes to them are ignored.
+class SpatialGrid {
+public:
+    static const int LAYER_COUNT = 6;
+    
+    SpatialGrid(int width = 0, int height = 0);
+    
+    // Empties every layer.
+    void resize(int width, int height);
+    int getWidth() const { return width_; }
+    int getHeight() const { return height_; }
+    
+    bool contains(const Point& cell) const {
+        return cell.x >= 0 && cell.x < width_ && cell.y >= 0 && cell.y < height_;
+    }
+    bool occupied(const Point& cell, unsigned layers) const {
+        return contains(cell) && (mask_[cell.y * width_ + cell.x] & layers) != 0;
+    }
+    // These take a single layer, never a combination.
+    int count(const Point& cell, GridLayer layer) const;
+    
+    void add(const Point& cell, GridLayer layer);
+    void remove(const Point& cell, GridLayer layer);
+    void move(const Point& from, const Point& to, GridLayer layer);
+    void clearLayer(GridLayer layer);
+    void clear();
+    
+    // A random cell where none of blockedLayers is present; false if there
+    // is none.
+    bool findFreeCell(unsigned blockedLayers, Point* cell) const;
+
+private:
+    int width_;
+    int height_;
+    std::vector<Uint8> mask_;
+    // LAYER_COUNT counters per cell.
+    std::vector<uint16_t> counts_;
+    
+    static int layerIndex(GridLayer layer);
+};
+
+// ============================================================================
+// Game Engine - Window, entities and the occupancy grid
+// ============================================================================
+
 class GameEngine {
 public:
     GameEngine(int gridWidth, int gridHeight, int cellSize = 20);
     GameEngine(SDL_Window* window, SDL_Renderer* renderer, int gridWidth, int gridHeight, int cellSize = 20);
     ~GameEngine();
     
+    // The engine owns its cached textures and, without an external window,
+    // the window and renderer; it is not copied.
+    GameEngine(const GameEngine&) = delete;
+    GameEngine& operator=(const GameEngine&) = delete;
+    
+    // Starts over on an external window and renderer with a new board size:
+    // entities, static layers and cached textures are dropped, and a window
+    // the engine created is destroyed. Handles from before stay dead.
+    void reset(SDL_Window* window, SDL_Renderer* renderer, int gridWidth, int gridHeight, int cellSize = 20);
+    
     bool initialize();
     void update(float deltaTime);
     void render();
     bool isRunning() const { return running; }
     void quit() { running = false; }
     
-    void addEntity(const Entity& entity);
+    // O(1): slots come from a free list and the component arrays stay
+    // packed (destroying moves the last entity into the hole).
+    EntityHandle createEntity(const Entity& entity);
+    void destroyEntity(EntityHandle handle);
+    bool isAlive(EntityHandle handle) const;
+    // Overwrites the entity behind handle, or creates one and stores its
+    // handle there if it no longer exists.
+    void placeEntity(EntityHandle& handle, const Entity& entity);
+    void setPosition(EntityHandle handle, const Point& position);
+    void setColor(EntityHandle handle, const Color& color);
+    void setVisible(EntityHandle handle, bool visible);
+    void clearEntities();
+    size_t getEntityCount() const { return positions.size(); }
+    
+    // Optional names, for entities that come from the .brick file and are
+    // touched at load and hot-reload time only. Adding a name that is in use
+    // replaces that entity.
+    EntityHandle addEntity(const std::string& name, const Entity& entity);
     void removeEntity(const std::string& name);
-    Entity* getEntity(const std::string& name);
+    EntityHandle findEntity(const std::string& name) const;
+    
+    // Static layers hold entities that rarely change, such as walls. Each
+    // one is drawn into a texture of its own, redrawn only after the layer
+    // is changed, and composited under the entities in creation order.
+    // clearEntities() leaves them alone.
+    int createStaticLayer();
+    void addStaticEntity(int layer, const Entity& entity);
+    void clearStaticLayer(int layer);
+    
+    // Recreates the cached textures after SDL reports they were lost.
+    void handleEvent(const SDL_Event& event);
+    
+    // Incremental mode keeps the board in a back-buffer texture and redraws
+    // only the cells whose contents changed since the last frame; a new
+    // window size or background color redraws it whole. Off by default. It
+    // needs render targets, and without them every frame is drawn in full.
+    // Only the board area is shown, so entities that stick out of the grid
+    // are clipped.
+    void setIncrementalRendering(bool enabled);
+    bool isIncrementalRendering() const { return incremental; }
+    // Cells drawn by the last render(): all of them unless it was an
+    // incremental frame.
+    size_t getRedrawnCells() const { return redrawnCells; }
     
     void setGameSpeed(int speed) { gameSpeed = speed; }
-    void setBackgroundColor(const Color& color) { backgroundColor = color; }
+    void setBackgroundColor(const Color& color) {
+        backgroundColor = color;
+        gridCache.dirty = true;
+        fullRedraw = true;
+    }
     
     int getGridWidth() const { return gridWidth; }
     int getGridHeight() const { return gridHeight; }
     int getCellSize() const { return cellSize; }
     
+    // Sized gridWidth x gridHeight; the games fill and query it.
+    SpatialGrid& getSpatialGrid() { return spatialGrid; }
+    const SpatialGrid& getSpatialGrid() const { return spatialGrid; }
+    
     SDL_Window* getWindow() { return window; }
     SDL_Renderer* getRenderer() { return renderer; }
 
@@ -80,10 +222,84 @@ private:
     SDL_Renderer* renderer;
     
     Color backgroundColor;
-    std::map<std::string, Entity> entities;
+    SpatialGrid spatialGrid;
+    // Filled by renderGrid() and renderEntities(), drawn once per frame.
+    RenderBatch batch;
+    
+    // A render-target texture covering the grid. Textures hold
+    // premultiplied color, so compositing one gives the same picture as
+    // drawing its contents straight to the screen.
+    struct LayerCache {
+        SDL_Texture* texture;
+        bool dirty;
+    };
+    struct StaticLayer {
+        std::vector<Entity> entities;
+        LayerCache cache;
+    };
+    // The grid overlay is cached like a static layer; its color follows the
+    // background.
+    LayerCache gridCache;
+    std::vector<StaticLayer> staticLayers;
+    // False when the renderer has no render targets or a texture could not
+    // be set up; then the layers are drawn directly every frame.
+    bool useLayerCache;
+    
+    // Incremental rendering. A cell's signature hashes what is drawn over
+    // it, in draw order; the cells whose signature differs from the one
+    // drawn into the back buffer are redrawn. Static layers are hashed
+    // again only after they change.
+    bool incremental;
+    bool fullRedraw;
+    SDL_Texture* backBuffer;
+    int outputWidth, outputHeight;
+    std::vector<uint64_t> drawnSignatures;
+    std::vector<uint64_t> frameSignatures;
+    std::vector<uint64_t> staticSignatures;
+    bool staticSignaturesDirty;
+    size_t redrawnCells;
+    
+    // Entity components, one element per live entity in the same order in
+    // every array; renderEntities() walks them front to back.
+    enum EntityFlags : Uint8 {
+        ENTITY_SOLID = 1,
+        ENTITY_VISIBLE = 2
+    };
+    std::vector<Point> positions;
+    std::vector<Color> colors;
+    std::vector<Point> sizes;
+    std::vector<Uint8> flags;
+    // Dense position -> slot, to fix the slot of the entity that is moved
+    // when another one is destroyed.
+    std::vector<uint32_t> owners;
+    
+    struct Slot {
+        uint32_t dense;
+        uint32_t generation;
+    };
+    std::vector<Slot> slots;
+    std::vector<uint32_t> freeSlots;
+    // Entries are not removed when their entity is destroyed by handle;
+    // findEntity() checks the handle is still alive.
+    std::unordered_map<std::string, EntityHandle> names;
     
+    bool resolve(EntityHandle handle, uint32_t* dense) const;
     void renderGrid();
+    void renderStaticLayer(const StaticLayer& layer);
+    void renderBoard();
     void renderEntities();
+    void queueEntity(const Point& position, const Point& size, const Color& color);
+    SDL_Rect entityArea(const Point& position, const Point& size) const;
+    bool renderIncremental();
+    void computeSignatures();
+    void signEntity(std::vector<uint64_t>& signatures, const Point& position, const Point& size,
+                    const Color& color) const;
+    void redrawArea(const SDL_Rect& area);
+    bool updateLayerCaches();
+    bool beginCache(LayerCache& cache);
+    void endCache(LayerCache& cache);
+    void compositeCache(const LayerCache& cache);
+    void releaseLayerCaches();
 };
 
 #endif // GAME_ENGINE_HPP
@@ -0,0 +1,56 @@
+#ifndef GAME_SCANNER_HPP
+#define GAME_SCANNER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct BrickGame {
+    std::string filename;
+    std::string displayName;
+};
+
+// ============================================================================
+// Game Scanner - Lists the .brick files of a directory on a worker pool
+// ============================================================================
+
+// start() lists the directory and returns at once; a fixed set of workers
+// then probes one file per task (BrickLoader::probeMetadata). The caller polls
+// collect() (e.g. once per frame) and can show games as soon as they land.
+class GameScanner {
+public:
+    // 0 workers means one per hardware thread.
+    explicit GameScanner(size_t workers = 0);
+    ~GameScanner();
+
+    void start(const std::string& directory);
+    // Waits for the workers; also called by the destructor.
+    void wait();
+
+    // Merges the games finished since the last call into 'games', keeping it
+    // sorted by displayName (then filename), so the final list does not
+    // depend on which worker finished first. Returns true if it changed.
+    bool collect(std::vector<BrickGame>& games);
+    bool done() const;
+    size_t scanned() const;
+    size_t total() const;
+
+private:
+    size_t workerCount_;
+    std::vector<std::thread> workers_;
+    std::vector<std::string> files_;
+    std::atomic<size_t> next_;
+    std::atomic<size_t> finished_;
+    std::mutex mutex_;
+    std::vector<BrickGame> pending_;
+
+    void work();
+
+    GameScanner(const GameScanner&) = delete;
+    GameScanner& operator=(const GameScanner&) = delete;
+};
+
+#endif // GAME_SCANNER_HPP
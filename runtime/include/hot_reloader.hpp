@@ -0,0 +1,125 @@
+#ifndef HOT_RELOADER_HPP
+#define HOT_RELOADER_HPP
+
+#include "brick_loader.hpp"
+#include <atomic>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace brick {
+    class SymbolTable;
+}
+
+class GameEngine;
+
+// What a recompiled file changes with respect to the live symbol table.
+// Entities are matched by name (the two tables have different interners).
+// lives and score only seed a new game, so they are not compared.
+struct ReloadDiff {
+    bool speedChanged;
+    bool gridChanged;
+    bool colorChanged;
+    // Spawn, color or solid differ.
+    std::vector<std::string> changedEntities;
+    std::vector<std::string> addedEntities;
+    std::vector<std::string> removedEntities;
+
+    ReloadDiff();
+    bool empty() const;
+
+    // Speed and background color go through the game's setSpeed() and
+    // setBackgroundColor(); the grid only changes on restart.
+    template <typename Game>
+    void applySettings(Game& game, const BrickLoader& loader) const {
+        if (speedChanged) {
+            game.setSpeed(loader.getSpeed());
+        }
+        if (colorChanged) {
+            game.setBackgroundColor(loader.getGameColor());
+        }
+        if (gridChanged) {
+            std::cout << "Hot reload: grid changes apply when the game is restarted" << std::endl;
+        }
+    }
+
+    // Calls redo(name) for every removed, changed and added entity, in that
+    // order, and logs how many there were.
+    template <typename Redo>
+    void redoEntities(Redo redo) const {
+        std::vector<std::string> touched = removedEntities;
+        touched.insert(touched.end(), changedEntities.begin(), changedEntities.end());
+        touched.insert(touched.end(), addedEntities.begin(), addedEntities.end());
+        for (const auto& name : touched) {
+            redo(name);
+        }
+        std::cout << "Hot reload: applied " << touched.size() << " entity change(s)" << std::endl;
+    }
+};
+
+// ============================================================================
+// Hot Reloader - Recompiles a .brick file in the background when it changes
+// ============================================================================
+
+// watch() starts a thread that waits for the file to be written (inotify on
+// the file's directory on Linux, so editors that save by renaming are seen;
+// an mtime poll elsewhere) and compiles it with a loader of its own. Files
+// that fail to compile are reported and skipped, so the game keeps running on
+// the last good version. The game calls take() once per tick and applies the
+// new loader between ticks; the frame never waits for the compiler.
+class HotReloader {
+public:
+    HotReloader();
+    ~HotReloader();
+
+    // Returns false if the file cannot be watched; the game runs as before.
+    bool watch(const std::string& filename);
+    // Wakes and joins the thread; also called by the destructor.
+    void stop();
+
+    // The newest successfully compiled loader, or null. A lock-free check
+    // when nothing is pending; older unclaimed results are dropped.
+    std::unique_ptr<BrickLoader> take();
+
+    static ReloadDiff diff(const brick::SymbolTable& live, const brick::SymbolTable& next);
+
+    // The start of a game's applyReload(): takes the newest loader, diffs it
+    // against 'live' and swaps it in. False when nothing is pending or 'live'
+    // was never loaded.
+    bool apply(BrickLoader& live, ReloadDiff* changes);
+
+    // A static entity as the reloaded file has it: added or moved under its
+    // name, or removed when the file no longer defines it.
+    static void replaceEntity(GameEngine& engine, const BrickLoader& loader, const std::string& name);
+
+    unsigned long reloads() const;
+    unsigned long failures() const;
+
+private:
+    std::string filename_;
+    std::string basename_;
+    std::thread thread_;
+    std::atomic<bool> stopping_;
+    std::atomic<bool> ready_;
+    std::atomic<unsigned long> reloads_;
+    std::atomic<unsigned long> failures_;
+    std::mutex mutex_;
+    std::unique_ptr<BrickLoader> pending_;
+    int wakePipe_[2];
+    int inotifyFd_;
+    long long lastModified_;
+    long long lastSize_;
+
+    void run();
+    bool waitForChange();
+    bool fileChanged();
+    void compile();
+
+    HotReloader(const HotReloader&) = delete;
+    HotReloader& operator=(const HotReloader&) = delete;
+};
+
+#endif // HOT_RELOADER_HPP
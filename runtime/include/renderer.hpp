@@ -3,6 +3,7 @@
 
 #include <SDL2/SDL.h>
 #include <string>
+#include <vector>
 
 // ============================================================================
 // Renderer - Graphics rendering utilities
@@ -30,5 +31,55 @@ public:
     static void present(SDL_Renderer* renderer);
 };
 
+// ============================================================================
+// Render Batch - Queues a frame's primitives and draws them by color
+// ============================================================================
+
+// Items with the same color and blend mode share a bucket, and flush() draws
+// each bucket with one SDL_RenderFillRects, one SDL_RenderDrawPoints and one
+// SDL_RenderDrawLines per connected run of segments. Buckets are drawn in the
+// order they were opened. An item that overlaps a later bucket opens a new
+// one instead of joining its own, so the result matches drawing in call
+// order. Storage is kept between frames.
+class RenderBatch {
+public:
+    RenderBatch();
+    
+    // Applies to the items queued after it; SDL_BLENDMODE_BLEND by default.
+    void setBlendMode(SDL_BlendMode mode);
+    
+    void fillRect(int x, int y, int w, int h,
+                  Uint8 r, Uint8 g, Uint8 b, Uint8 a = 255);
+    // Horizontal and vertical lines are queued as one-pixel-wide rects.
+    void drawLine(int x1, int y1, int x2, int y2,
+                  Uint8 r, Uint8 g, Uint8 b, Uint8 a = 255);
+    void drawPoint(int x, int y, Uint8 r, Uint8 g, Uint8 b, Uint8 a = 255);
+    
+    // Draws and empties the batch, leaving the renderer's blend mode as it
+    // was. Returns the number of SDL draw calls issued.
+    int flush(SDL_Renderer* renderer);
+    void clear();
+    bool empty() const { return used_ == 0; }
+
+private:
+    struct Bucket {
+        Uint32 color;
+        SDL_BlendMode blendMode;
+        // Union of everything queued in the bucket.
+        SDL_Rect bounds;
+        std::vector<SDL_Rect> rects;
+        // Segments as start/end pairs.
+        std::vector<SDL_Point> lines;
+        std::vector<SDL_Point> points;
+    };
+    std::vector<Bucket> buckets_;
+    size_t used_;
+    SDL_BlendMode blendMode_;
+    std::vector<SDL_Point> polyline_;
+    
+    Bucket& bucketFor(Uint8 r, Uint8 g, Uint8 b, Uint8 a, const SDL_Rect& area);
+    int drawSegments(SDL_Renderer* renderer, const std::vector<SDL_Point>& lines);
+};
+
 #endif // RENDERER_HPP
 
@@ -4,6 +4,7 @@
 #include "game_engine.hpp"
 #include "input_manager.hpp"
 #include "brick_loader.hpp"
+#include "hot_reloader.hpp"
 #include <queue>
 #include <ctime>
 
@@ -46,6 +47,7 @@ public:
     void setSpeed(int speed) { gameSpeed = speed; moveDelay = 1.0f / speed; }
     void setLives(int newLives) { lives = newLives; }
     void setScore(int newScore) { score = newScore; }
+    void setIncrementalRendering(bool enabled) { engine.setIncrementalRendering(enabled); }
     void setBackgroundColor(unsigned int color) { 
         Color bgColor = Color::fromHex(color);
         engine.setBackgroundColor(bgColor);
@@ -55,9 +57,30 @@ private:
     GameEngine engine;
     InputManager input;
     BrickLoader brickLoader;
+    // Recompiles the .brick file when it is saved; applied by applyReload().
+    HotReloader reloader;
+    // Entities from the .brick file, resolved to their position in the symbol
+    // table after loading and after each hot reload, so the per-frame
+    // lookups are an array index.
+    struct EntityIds {
+        brick::EntityId head;
+        brick::EntityId body;
+        brick::EntityId fruit;
+        brick::EntityId superfruit;
+        brick::EntityId obstacle;
+        brick::EntityId wall;
+    } entityIds = {};
     bool useExternalWindow;
     bool useBrickFile;
     
+    // Engine entities the game moves; the static ones from the .brick file
+    // are added to the engine by name.
+    std::vector<EntityHandle> segmentEntities;
+    EntityHandle fruitEntity;
+    EntityHandle superfruitEntity;
+    EntityHandle obstacleEntity;
+    EntityHandle wallEntity;
+    
     std::deque<SnakeSegment> snake;
     Point fruitPosition;
     Point superfruitPosition;
@@ -91,11 +114,15 @@ private:
     void drawGame();
     void handleGameOver();
     void loadEntitiesFromBrick();
+    void applyReload();
+    void resolveEntityIds();
     
     // Utilities
     bool isValidPosition(const Point& pos) const;
     bool isSnakeBody(const Point& pos) const;
     bool isSolidEntity(const Point& pos) const;
+    void rebuildSnakeLayer();
+    void rebuildSolidLayer();
     void clearSnakeEntities();
     void ensureStaticEntities();
 };
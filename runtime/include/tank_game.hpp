@@ -4,6 +4,7 @@
 #include "game_engine.hpp"
 #include "input_manager.hpp"
 #include "brick_loader.hpp"
+#include "hot_reloader.hpp"
 #include <vector>
 #include <ctime>
 
@@ -77,6 +78,7 @@ public:
     
     void setSpeed(int speed) { gameSpeed = speed; }
     void setLives(int newLives) { lives = newLives; }
+    void setIncrementalRendering(bool enabled) { engine.setIncrementalRendering(enabled); }
     void setScore(int newScore) { score = newScore; }
     void setBackgroundColor(unsigned int color) { 
         Color bgColor = Color::fromHex(color);
@@ -87,9 +89,32 @@ private:
     GameEngine engine;
     InputManager input;
     BrickLoader brickLoader;
+    // Recompiles the .brick file when it is saved; applied by applyReload().
+    HotReloader reloader;
+    // Entities from the .brick file, resolved to their position in the symbol
+    // table after loading and after each hot reload, so the per-frame
+    // lookups are an array index.
+    struct EntityIds {
+        brick::EntityId playerTank;
+        brick::EntityId enemyTank;
+        brick::EntityId destructibleWall;
+        brick::EntityId powerup;
+        brick::EntityId bullet;
+        brick::EntityId enemyBullet;
+        brick::EntityId explosion;
+        brick::EntityId wall;
+    } entityIds = {};
     bool useExternalWindow;
     bool useBrickFile;
     
+    // Tanks, bullets, explosions and the powerup are drawn from the game
+    // state every frame; their engine entities live for one frame.
+    std::vector<EntityHandle> frameEntities;
+    // Walls only change when a destructible one is shot, so they sit in
+    // static layers that the engine caches.
+    int wallLayer = -1;
+    int destructibleWallLayer = -1;
+    
     Tank playerTank;
     std::vector<Tank> enemyTanks;
     std::vector<Bullet> bullets;
@@ -126,6 +151,8 @@ private:
     void drawGame();
     void handleGameOver();
     void loadEntitiesFromBrick();
+    void applyReload();
+    void resolveEntityIds();
     
     // Tank operations
     void moveTank(Tank& tank, TankDirection direction);
@@ -139,11 +166,14 @@ private:
     bool isWall(const Point& pos) const;
     bool isDestructibleWall(const Point& pos) const;
     bool isTankAt(const Point& pos) const;
+    void rebuildGrid();
+    void rebuildWallLayer();
+    void rebuildDestructibleWallLayer();
     void destroyDestructibleWall(const Point& pos);
     
     // Utilities
     void clearGameEntities();
-    void ensureStaticEntities();
+    void drawPowerup();
     TankDirection getRandomDirection() const;
     Point getDirectionOffset(TankDirection direction) const;
 };
@@ -4,6 +4,7 @@
 #include "game_engine.hpp"
 #include "input_manager.hpp"
 #include "brick_loader.hpp"
+#include "hot_reloader.hpp"
 
 // ============================================================================
 // Tetris Game - Game logic and state
@@ -59,6 +60,7 @@ public:
     
     void setSpeed(int speed) { gravitySpeed = 1.0f / speed; dropDelay = gravitySpeed; }
     void setScore(int newScore) { score = newScore; }
+    void setIncrementalRendering(bool enabled) { engine.setIncrementalRendering(enabled); }
     void setLevel(int newLevel) { level = newLevel; }
     void setBackgroundColor(unsigned int color) { 
         Color bgColor = Color::fromHex(color);
@@ -69,8 +71,13 @@ private:
     GameEngine engine;
     InputManager input;
     BrickLoader brickLoader;
+    // Recompiles the .brick file when it is saved; applied by applyReload().
+    HotReloader reloader;
     bool useExternalWindow;
     bool useBrickFile;
+    // Engine entities for the blocks and the falling piece; they live for
+    // one frame.
+    std::vector<EntityHandle> frameEntities;
     
     int** board;
     int boardWidth, boardHeight;
@@ -115,6 +122,7 @@ private:
     void drawNextPiece();
     void handleGameOver();
     void loadEntitiesFromBrick();
+    void applyReload();
     
     // Tetromino shape helpers
     void getPieceShape(TetrisBlockType type, RotationState rot, 
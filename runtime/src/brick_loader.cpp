@@ -1,14 +1,21 @@
 #include "brick_loader.hpp"
+#include "compile_cache.hpp"
 #include "../../brickc/src/lexer.hpp"
 #include "../../brickc/src/parser.hpp"
 #include "../../brickc/src/symbols.hpp"
 #include "../../brickc/src/error.hpp"
+#include "../../brickc/src/arena.hpp"
+#include "../../brickc/src/flat_ast.hpp"
+#include "../../brickc/src/brick_image.hpp"
+#include "../../brickc/src/string_interner.hpp"
 #include "../../brickc/src/util.hpp"
+#include <cstdio>
 #include <iostream>
 #include <sstream>
 
 BrickLoader::BrickLoader() 
-    : symbolTable_(nullptr), errorHandler_(nullptr) {
+    : symbolTable_(nullptr), errorHandler_(nullptr), astArena_(new brick::AstArena()),
+      interner_(new brick::StringInterner()) {
 }
 
 BrickLoader::~BrickLoader() {
@@ -19,28 +26,36 @@ bool BrickLoader::loadBrickFile(const std::string& filename) {
         errorHandler_ = std::unique_ptr<brick::ErrorHandler>(new brick::ErrorHandler());
         errorHandler_->setCurrentFile(filename);
         
-        std::string sourceCode = brick::FileUtils::readFile(filename);
-        
-        brick::Lexer lexer(sourceCode);
-        brick::Parser parser(&lexer, errorHandler_.get());
-        
-        brick::ASTNode* ast = parser.parseProgram();
-        
-        if (errorHandler_->hasErrors()) {
-            if (ast) {
-                brick::deleteAST(ast);
-            }
+        // The text is read once: the lexer's buffer is hashed to pick the
+        // side-by-side image and the cache entry, and the same bytes are
+        // parsed on a miss, so the cache never stores a table under the
+        // hash of other content.
+        brick::Lexer lexer;
+        lexer.setInterner(interner_.get());
+        if (!lexer.openFile(filename)) {
+            errorHandler_->report(brick::ERROR_IO, 0, 0, brick::MSG_FILE_NOT_OPENED, filename);
+            symbolTable_.reset();
             return false;
         }
+        const brick::SourceBuffer& source = lexer.getBuffer();
+        uint64_t sourceHash = brick::BrickImage::hashSource(source.data(), source.size());
+        if (loadBrickImage(filename, sourceHash) || loadCached(sourceHash)) {
+            return true;
+        }
         
-        if (!ast) {
+        brick::Parser parser(&lexer, errorHandler_.get(), astArena_.get());
+        
+        brick::FlatAst flatAst;
+        bool parsed = parser.parseProgram(flatAst);
+        astArena_->reset();
+        
+        if (errorHandler_->hasErrors() || !parsed) {
+            symbolTable_.reset();
             return false;
         }
         
-        symbolTable_ = std::unique_ptr<brick::SymbolTable>(new brick::SymbolTable(errorHandler_.get()));
-        bool success = symbolTable_->populateFromAST(ast);
-        
-        brick::deleteAST(ast);
+        symbolTable_ = std::unique_ptr<brick::SymbolTable>(new brick::SymbolTable(errorHandler_.get(), interner_.get()));
+        bool success = symbolTable_->populateFromAST(flatAst);
         
         if (!success || errorHandler_->hasErrors()) {
             symbolTable_.reset();
@@ -53,6 +68,7 @@ bool BrickLoader::loadBrickFile(const std::string& filename) {
             return false;
         }
         
+        CompileCache::shared().store(*symbolTable_, sourceHash);
         return true;
         
     } catch (const std::exception& e) {
@@ -62,6 +78,152 @@ bool BrickLoader::loadBrickFile(const std::string& filename) {
     }
 }
 
+void BrickLoader::swap(BrickLoader& other) {
+    symbolTable_.swap(other.symbolTable_);
+    errorHandler_.swap(other.errorHandler_);
+    astArena_.swap(other.astArena_);
+    interner_.swap(other.interner_);
+}
+
+// Uses "<file>.brickb" when its source hash matches the current text.
+// Anything else (missing, stale, corrupt or failing verification) leaves
+// no trace and lets the caller fall back to the text front-end.
+bool BrickLoader::loadBrickImage(const std::string& filename, uint64_t sourceHash) {
+    brick::BrickImage image;
+    if (!image.open(brick::BrickImage::pathFor(filename)) || image.sourceHash() != sourceHash) {
+        return false;
+    }
+    std::unique_ptr<brick::SymbolTable> table(new brick::SymbolTable(errorHandler_.get(), interner_.get()));
+    if (!image.populate(*table) || !table->validate() || errorHandler_->hasErrors()) {
+        errorHandler_->clear();
+        return false;
+    }
+    symbolTable_ = std::move(table);
+    return true;
+}
+
+// Same contract as loadBrickImage, reading from the shared compile cache.
+bool BrickLoader::loadCached(uint64_t sourceHash) {
+    std::unique_ptr<brick::SymbolTable> table(new brick::SymbolTable(errorHandler_.get(), interner_.get()));
+    if (!CompileCache::shared().load(sourceHash, *table) || errorHandler_->hasErrors()) {
+        errorHandler_->clear();
+        return false;
+    }
+    symbolTable_ = std::move(table);
+    return true;
+}
+
+GameMetadata::GameMetadata()
+    : valid(false), hasSpeed(false), hasGrid(false), hasColor(false),
+      speed(8), gridWidth(30), gridHeight(30), color(0x001122) {
+}
+
+namespace {
+
+// Token cursor over the probe window. A token that touches the end of a
+// truncated window may be cut in half, so it reads as end of input.
+class ProbeCursor {
+public:
+    ProbeCursor(brick::Lexer& lexer, size_t windowSize, bool truncated)
+        : lexer_(lexer), windowSize_(windowSize), truncated_(truncated) {
+        advance();
+    }
+    
+    const brick::Token& current() const { return current_; }
+    
+    void advance() {
+        current_ = lexer_.nextToken();
+        if (truncated_ && current_.offset + current_.lexeme.length >= windowSize_) {
+            current_.type = brick::T_EOF;
+        }
+    }
+    
+    bool match(int type) {
+        if (current_.type != type) return false;
+        advance();
+        return true;
+    }
+    
+    bool readInt(int* value) {
+        if (current_.type != brick::T_INT || !current_.intValue(value)) return false;
+        advance();
+        return true;
+    }
+    
+private:
+    brick::Lexer& lexer_;
+    size_t windowSize_;
+    bool truncated_;
+    brick::Token current_;
+};
+
+}
+
+GameMetadata BrickLoader::probeMetadata(const std::string& filename) {
+    GameMetadata meta;
+    FILE* file = std::fopen(filename.c_str(), "rb");
+    if (!file) {
+        return meta;
+    }
+    // One byte more than the window tells whether the file goes on.
+    std::string window(PROBE_BYTES + 1, '\0');
+    size_t read = std::fread(&window[0], 1, window.size(), file);
+    std::fclose(file);
+    bool truncated = read > PROBE_BYTES;
+    window.resize(truncated ? PROBE_BYTES : read);
+    
+    // A private interner: probes run on scanner threads.
+    brick::StringInterner names;
+    brick::Lexer lexer;
+    lexer.setInterner(&names);
+    lexer.init(window);
+    ProbeCursor cursor(lexer, window.size(), truncated);
+    
+    if (!cursor.match(brick::T_GAME) || cursor.current().type != brick::T_IDENT) {
+        return meta;
+    }
+    meta.name = cursor.current().text();
+    cursor.advance();
+    if (!cursor.match(brick::T_LBRACE)) {
+        return meta;
+    }
+    meta.valid = true;
+    
+    // Settings with anything but a literal value are skipped up to their ';'.
+    for (;;) {
+        brick::TokenType type = cursor.current().type;
+        if (type != brick::T_SPEED && type != brick::T_GRID && type != brick::T_COLOR &&
+            type != brick::T_SCORE && type != brick::T_IDENT) {
+            break;
+        }
+        cursor.advance();
+        if (!cursor.match(brick::T_COLON)) break;
+        
+        int number = 0, width = 0, height = 0;
+        unsigned int color = 0;
+        if (type == brick::T_SPEED && cursor.readInt(&number) &&
+            cursor.current().type == brick::T_SEMICOLON) {
+            meta.hasSpeed = true;
+            meta.speed = number;
+        } else if (type == brick::T_GRID && cursor.match(brick::T_LPAREN) && cursor.readInt(&width) &&
+                   cursor.match(brick::T_COMMA) && cursor.readInt(&height) && cursor.match(brick::T_RPAREN) &&
+                   cursor.current().type == brick::T_SEMICOLON) {
+            meta.hasGrid = true;
+            meta.gridWidth = width;
+            meta.gridHeight = height;
+        } else if (type == brick::T_COLOR && cursor.current().type == brick::T_HEXCOLOR &&
+                   brick::ColorUtils::parseHexColor(cursor.current().text(), &color)) {
+            meta.hasColor = true;
+            meta.color = color;
+        }
+        while (cursor.current().type != brick::T_SEMICOLON && cursor.current().type != brick::T_EOF) {
+            cursor.advance();
+        }
+        if (!cursor.match(brick::T_SEMICOLON)) break;
+    }
+    return meta;
+}
+
 const brick::SymbolTable* BrickLoader::getSymbolTable() const {
     return symbolTable_.get();
 }
@@ -117,14 +279,39 @@ std::string BrickLoader::getErrorMessages() const {
     return oss.str();
 }
 
-const std::map<std::string, brick::Entity>& BrickLoader::getEntities() const {
-    static std::map<std::string, brick::Entity> emptyMap;
+brick::SymbolId BrickLoader::symbol(const std::string& name) const {
+    return interner_->lookup(name);
+}
+
+brick::EntityId BrickLoader::entityId(const std::string& name) const {
     if (!symbolTable_) {
-        return emptyMap;
+        return brick::NO_ENTITY;
+    }
+    return symbolTable_->entityId(name);
+}
+
+const brick::Entity* BrickLoader::entity(brick::EntityId id) const {
+    if (!symbolTable_ || id == brick::NO_ENTITY) {
+        return nullptr;
+    }
+    return &symbolTable_->entity(id);
+}
+
+const std::vector<brick::Entity>& BrickLoader::getEntities() const {
+    static std::vector<brick::Entity> emptyList;
+    if (!symbolTable_) {
+        return emptyList;
     }
     return symbolTable_->getEntities();
 }
 
+const brick::Entity* BrickLoader::findEntity(brick::SymbolId id) const {
+    if (!symbolTable_) {
+        return nullptr;
+    }
+    return symbolTable_->findEntity(id);
+}
+
 const brick::Entity* BrickLoader::findEntity(const std::string& name) const {
     if (!symbolTable_) {
         return nullptr;
@@ -132,6 +319,13 @@ const brick::Entity* BrickLoader::findEntity(const std::string& name) const {
     return symbolTable_->findEntity(name);
 }
 
+bool BrickLoader::hasEntity(brick::SymbolId id) const {
+    if (!symbolTable_) {
+        return false;
+    }
+    return symbolTable_->entityExists(id);
+}
+
 bool BrickLoader::hasEntity(const std::string& name) const {
     if (!symbolTable_) {
         return false;
@@ -0,0 +1,163 @@
+#include "compile_cache.hpp"
+#include "../../brickc/src/brick_image.hpp"
+#include "../../brickc/src/source.hpp"
+#include "../../brickc/src/symbols.hpp"
+#include "../../brickc/src/util.hpp"
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+const char* const ENTRY_EXTENSION = ".brickb";
+
+bool hasSuffix(const std::string& name, const std::string& suffix) {
+    return name.size() >= suffix.size() &&
+           name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+bool makeDirectory(const std::string& path) {
+    return mkdir(path.c_str(), 0755) == 0 || errno == EEXIST;
+}
+
+}
+
+CompileCache::CompileCache(const std::string& directory)
+    : directory_(directory), hits_(0), misses_(0), stores_(0), tempCounter_(0) {
+}
+
+CompileCache& CompileCache::shared() {
+    static CompileCache cache(defaultDirectory());
+    return cache;
+}
+
+std::string CompileCache::defaultDirectory() {
+    const char* dir = std::getenv("BRICK_CACHE_DIR");
+    if (dir && *dir) {
+        return dir;
+    }
+    dir = std::getenv("XDG_CACHE_HOME");
+    if (dir && *dir) {
+        return std::string(dir) + "/brick";
+    }
+    dir = std::getenv("HOME");
+    if (dir && *dir) {
+        return std::string(dir) + "/.cache/brick";
+    }
+    return ".brick_cache";
+}
+
+const std::string& CompileCache::directory() const {
+    return directory_;
+}
+
+// Continues the source hash over the version strings: same FNV-1a step, so
+// the key costs nothing beyond the hash the loader already computed.
+uint64_t CompileCache::keyFor(uint64_t sourceHash) {
+    char version[64];
+    int length = std::snprintf(version, sizeof(version), "%s/%u", BRICKC_VERSION,
+                               static_cast<unsigned>(brick::BrickImage::VERSION));
+    uint64_t key = sourceHash;
+    for (int i = 0; i < length; ++i) {
+        key ^= static_cast<unsigned char>(version[i]);
+        key *= 1099511628211ULL;
+    }
+    return key;
+}
+
+std::string CompileCache::entryPath(uint64_t sourceHash) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(keyFor(sourceHash)));
+    return directory_ + "/" + name + ENTRY_EXTENSION;
+}
+
+bool CompileCache::load(uint64_t sourceHash, brick::SymbolTable& table) {
+    brick::BrickImage image;
+    // The stored source hash guards against two sources sharing a key.
+    bool hit = image.open(entryPath(sourceHash)) && image.sourceHash() == sourceHash &&
+               image.populate(table) && table.validate();
+    if (hit) {
+        ++hits_;
+    } else {
+        ++misses_;
+    }
+    return hit;
+}
+
+bool CompileCache::store(const brick::SymbolTable& table, uint64_t sourceHash) {
+    if (!ensureDirectory()) {
+        return false;
+    }
+    std::string path = entryPath(sourceHash);
+    std::string temp = path + ".tmp." + std::to_string(static_cast<long>(getpid())) + "." +
+                       std::to_string(tempCounter_++);
+    if (!brick::BrickImage::write(table, sourceHash, temp)) {
+        return false;
+    }
+    if (std::rename(temp.c_str(), path.c_str()) != 0) {
+        std::remove(temp.c_str());
+        return false;
+    }
+    ++stores_;
+    return true;
+}
+
+bool CompileCache::invalidate(const std::string& sourceFile) {
+    brick::SourceBuffer source;
+    if (!source.openFile(sourceFile)) {
+        return false;
+    }
+    uint64_t hash = brick::BrickImage::hashSource(source.data(), source.size());
+    return std::remove(entryPath(hash).c_str()) == 0;
+}
+
+size_t CompileCache::clear() {
+    DIR* dir = opendir(directory_.c_str());
+    if (!dir) {
+        return 0;
+    }
+    size_t removed = 0;
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != nullptr) {
+        std::string name = entry->d_name;
+        // Also sweeps temporaries left behind by an interrupted store().
+        if (hasSuffix(name, ENTRY_EXTENSION) || name.find(std::string(ENTRY_EXTENSION) + ".tmp.") != std::string::npos) {
+            if (std::remove((directory_ + "/" + name).c_str()) == 0) {
+                ++removed;
+            }
+        }
+    }
+    closedir(dir);
+    return removed;
+}
+
+CompileCache::Stats CompileCache::stats() const {
+    Stats result;
+    result.hits = hits_;
+    result.misses = misses_;
+    result.stores = stores_;
+    return result;
+}
+
+void CompileCache::resetStats() {
+    hits_ = 0;
+    misses_ = 0;
+    stores_ = 0;
+}
+
+// Creates the directory and its parent (~/.cache may not exist yet).
+bool CompileCache::ensureDirectory() const {
+    struct stat info;
+    if (stat(directory_.c_str(), &info) == 0) {
+        return S_ISDIR(info.st_mode);
+    }
+    size_t slash = directory_.find_last_of('/');
+    if (slash != std::string::npos && slash > 0) {
+        makeDirectory(directory_.substr(0, slash));
+    }
+    return makeDirectory(directory_);
+}
@@ -1,7 +1,112 @@
 #include "game_engine.hpp"
-#include "renderer.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
 #include <iostream>
 
+// ============================================================================
+// Spatial Grid Implementation
+// ============================================================================
+
+namespace {
+
+// Random probes before falling back to a scan in findFreeCell().
+const int FREE_CELL_PROBES = 16;
+
+}
+
+SpatialGrid::SpatialGrid(int width, int height) : width_(0), height_(0) {
+    resize(width, height);
+}
+
+void SpatialGrid::resize(int width, int height) {
+    width_ = width > 0 ? width : 0;
+    height_ = height > 0 ? height : 0;
+    size_t cells = static_cast<size_t>(width_) * height_;
+    mask_.assign(cells, 0);
+    counts_.assign(cells * LAYER_COUNT, 0);
+}
+
+// Position of the layer's bit. Counters are per layer, so 0 or a combined
+// mask is a caller bug: it asserts, and returns -1 so the call is ignored.
+int SpatialGrid::layerIndex(GridLayer layer) {
+    for (int index = 0; index < LAYER_COUNT; ++index) {
+        if (static_cast<unsigned>(layer) == 1u << index) {
+            return index;
+        }
+    }
+    assert(!"GridLayer must have exactly one bit set");
+    return -1;
+}
+
+int SpatialGrid::count(const Point& cell, GridLayer layer) const {
+    int offset = layerIndex(layer);
+    if (!contains(cell) || offset < 0) return 0;
+    return counts_[(cell.y * width_ + cell.x) * LAYER_COUNT + offset];
+}
+
+void SpatialGrid::add(const Point& cell, GridLayer layer) {
+    int offset = layerIndex(layer);
+    if (!contains(cell) || offset < 0) return;
+    size_t index = cell.y * width_ + cell.x;
+    ++counts_[index * LAYER_COUNT + offset];
+    mask_[index] |= layer;
+}
+
+void SpatialGrid::remove(const Point& cell, GridLayer layer) {
+    int offset = layerIndex(layer);
+    if (!contains(cell) || offset < 0) return;
+    size_t index = cell.y * width_ + cell.x;
+    uint16_t& counter = counts_[index * LAYER_COUNT + offset];
+    if (counter == 0) return;
+    if (--counter == 0) {
+        mask_[index] &= ~layer;
+    }
+}
+
+void SpatialGrid::move(const Point& from, const Point& to, GridLayer layer) {
+    remove(from, layer);
+    add(to, layer);
+}
+
+void SpatialGrid::clearLayer(GridLayer layer) {
+    int offset = layerIndex(layer);
+    if (offset < 0) return;
+    for (size_t index = 0; index < mask_.size(); ++index) {
+        counts_[index * LAYER_COUNT + offset] = 0;
+        mask_[index] &= ~layer;
+    }
+}
+
+void SpatialGrid::clear() {
+    std::fill(mask_.begin(), mask_.end(), 0);
+    std::fill(counts_.begin(), counts_.end(), 0);
+}
+
+// A few uniform probes find a cell right away on a mostly empty board; the
+// scan from a random start after them bounds the work on a full one.
+bool SpatialGrid::findFreeCell(unsigned blockedLayers, Point* cell) const {
+    size_t cells = mask_.size();
+    if (cells == 0) return false;
+    
+    for (int probe = 0; probe < FREE_CELL_PROBES; ++probe) {
+        size_t index = std::rand() % cells;
+        if (!(mask_[index] & blockedLayers)) {
+            *cell = Point(static_cast<int>(index % width_), static_cast<int>(index / width_));
+            return true;
+        }
+    }
+    size_t start = std::rand() % cells;
+    for (size_t step = 0; step < cells; ++step) {
+        size_t index = (start + step) % cells;
+        if (!(mask_[index] & blockedLayers)) {
+            *cell = Point(static_cast<int>(index % width_), static_cast<int>(index / width_));
+            return true;
+        }
+    }
+    return false;
+}
+
 // ============================================================================
 // Game Engine Implementation
 // ============================================================================
@@ -9,16 +114,23 @@
 GameEngine::GameEngine(int gridWidth, int gridHeight, int cellSize)
     : gridWidth(gridWidth), gridHeight(gridHeight), cellSize(cellSize),
       gameSpeed(8), running(false), useExternalWindow(false), 
-      window(nullptr), renderer(nullptr), backgroundColor(0, 17, 34) {
+      window(nullptr), renderer(nullptr), backgroundColor(0, 17, 34),
+      spatialGrid(gridWidth, gridHeight), gridCache{nullptr, true}, useLayerCache(false),
+      incremental(false), fullRedraw(true), backBuffer(nullptr), outputWidth(0), outputHeight(0),
+      staticSignaturesDirty(true), redrawnCells(0) {
 }
 
 GameEngine::GameEngine(SDL_Window* window, SDL_Renderer* renderer, int gridWidth, int gridHeight, int cellSize)
     : gridWidth(gridWidth), gridHeight(gridHeight), cellSize(cellSize),
       gameSpeed(8), running(false), useExternalWindow(true),
-      window(window), renderer(renderer), backgroundColor(0, 17, 34) {
+      window(window), renderer(renderer), backgroundColor(0, 17, 34),
+      spatialGrid(gridWidth, gridHeight), gridCache{nullptr, true}, useLayerCache(false),
+      incremental(false), fullRedraw(true), backBuffer(nullptr), outputWidth(0), outputHeight(0),
+      staticSignaturesDirty(true), redrawnCells(0) {
 }
 
 GameEngine::~GameEngine() {
+    releaseLayerCaches();
     if (!useExternalWindow) {
         if (renderer) {
             SDL_DestroyRenderer(renderer);
@@ -30,8 +142,47 @@ GameEngine::~GameEngine() {
     }
 }
 
+void GameEngine::reset(SDL_Window* window, SDL_Renderer* renderer, int gridWidth, int gridHeight, int cellSize) {
+    releaseLayerCaches();
+    if (!useExternalWindow) {
+        if (this->renderer) {
+            SDL_DestroyRenderer(this->renderer);
+        }
+        if (this->window) {
+            SDL_DestroyWindow(this->window);
+        }
+        SDL_Quit();
+    }
+    
+    this->gridWidth = gridWidth;
+    this->gridHeight = gridHeight;
+    this->cellSize = cellSize;
+    this->window = window;
+    this->renderer = renderer;
+    useExternalWindow = true;
+    running = false;
+    
+    // clearEntities() bumps the generations, so old handles do not come
+    // back to life once their slots are reused.
+    clearEntities();
+    spatialGrid.resize(gridWidth, gridHeight);
+    staticLayers.clear();
+    batch.clear();
+    gridCache.dirty = true;
+    useLayerCache = false;
+    fullRedraw = true;
+    outputWidth = 0;
+    outputHeight = 0;
+    drawnSignatures.clear();
+    frameSignatures.clear();
+    staticSignatures.clear();
+    staticSignaturesDirty = true;
+    redrawnCells = 0;
+}
+
 bool GameEngine::initialize() {
     if (useExternalWindow) {
+        useLayerCache = renderer && SDL_RenderTargetSupported(renderer);
         running = true;
         return true;
     }
@@ -68,25 +219,179 @@ bool GameEngine::initialize() {
     }
     
     SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+    useLayerCache = SDL_RenderTargetSupported(renderer);
     running = true;
     
     return true;
 }
 
-void GameEngine::addEntity(const Entity& entity) {
-    entities[entity.name] = entity;
+EntityHandle GameEngine::createEntity(const Entity& entity) {
+    uint32_t index;
+    if (!freeSlots.empty()) {
+        index = freeSlots.back();
+        freeSlots.pop_back();
+    } else {
+        index = static_cast<uint32_t>(slots.size());
+        slots.push_back(Slot{0, 0});
+    }
+    slots[index].dense = static_cast<uint32_t>(positions.size());
+    
+    positions.push_back(entity.position);
+    colors.push_back(entity.color);
+    sizes.push_back(Point(entity.width, entity.height));
+    flags.push_back((entity.solid ? ENTITY_SOLID : 0) | (entity.visible ? ENTITY_VISIBLE : 0));
+    owners.push_back(index);
+    return EntityHandle(index, slots[index].generation);
+}
+
+void GameEngine::destroyEntity(EntityHandle handle) {
+    uint32_t dense;
+    if (!resolve(handle, &dense)) {
+        return;
+    }
+    uint32_t last = static_cast<uint32_t>(positions.size() - 1);
+    if (dense != last) {
+        positions[dense] = positions[last];
+        colors[dense] = colors[last];
+        sizes[dense] = sizes[last];
+        flags[dense] = flags[last];
+        owners[dense] = owners[last];
+        slots[owners[dense]].dense = dense;
+    }
+    positions.pop_back();
+    colors.pop_back();
+    sizes.pop_back();
+    flags.pop_back();
+    owners.pop_back();
+    
+    ++slots[handle.index].generation;
+    freeSlots.push_back(handle.index);
+}
+
+bool GameEngine::isAlive(EntityHandle handle) const {
+    uint32_t dense;
+    return resolve(handle, &dense);
+}
+
+void GameEngine::placeEntity(EntityHandle& handle, const Entity& entity) {
+    uint32_t dense;
+    if (!resolve(handle, &dense)) {
+        handle = createEntity(entity);
+        return;
+    }
+    positions[dense] = entity.position;
+    colors[dense] = entity.color;
+    sizes[dense] = Point(entity.width, entity.height);
+    flags[dense] = (entity.solid ? ENTITY_SOLID : 0) | (entity.visible ? ENTITY_VISIBLE : 0);
+}
+
+void GameEngine::setPosition(EntityHandle handle, const Point& position) {
+    uint32_t dense;
+    if (resolve(handle, &dense)) {
+        positions[dense] = position;
+    }
+}
+
+void GameEngine::setColor(EntityHandle handle, const Color& color) {
+    uint32_t dense;
+    if (resolve(handle, &dense)) {
+        colors[dense] = color;
+    }
+}
+
+void GameEngine::setVisible(EntityHandle handle, bool visible) {
+    uint32_t dense;
+    if (resolve(handle, &dense)) {
+        flags[dense] = visible ? (flags[dense] | ENTITY_VISIBLE) : (flags[dense] & ~ENTITY_VISIBLE);
+    }
+}
+
+// Every handle handed out so far goes stale; slots are kept for reuse.
+void GameEngine::clearEntities() {
+    for (uint32_t slot : owners) {
+        ++slots[slot].generation;
+        freeSlots.push_back(slot);
+    }
+    positions.clear();
+    colors.clear();
+    sizes.clear();
+    flags.clear();
+    owners.clear();
+    names.clear();
+}
+
+EntityHandle GameEngine::addEntity(const std::string& name, const Entity& entity) {
+    EntityHandle& handle = names[name];
+    destroyEntity(handle);
+    handle = createEntity(entity);
+    return handle;
 }
 
 void GameEngine::removeEntity(const std::string& name) {
-    entities.erase(name);
+    auto it = names.find(name);
+    if (it != names.end()) {
+        destroyEntity(it->second);
+        names.erase(it);
+    }
+}
+
+EntityHandle GameEngine::findEntity(const std::string& name) const {
+    auto it = names.find(name);
+    if (it == names.end() || !isAlive(it->second)) {
+        return EntityHandle();
+    }
+    return it->second;
+}
+
+int GameEngine::createStaticLayer() {
+    StaticLayer layer;
+    layer.cache.texture = nullptr;
+    layer.cache.dirty = true;
+    staticLayers.push_back(layer);
+    return static_cast<int>(staticLayers.size() - 1);
+}
+
+void GameEngine::addStaticEntity(int layer, const Entity& entity) {
+    staticLayers[layer].entities.push_back(entity);
+    staticLayers[layer].cache.dirty = true;
+    staticSignaturesDirty = true;
+}
+
+void GameEngine::clearStaticLayer(int layer) {
+    staticLayers[layer].entities.clear();
+    staticLayers[layer].cache.dirty = true;
+    staticSignaturesDirty = true;
+}
+
+void GameEngine::setIncrementalRendering(bool enabled) {
+    incremental = enabled;
+    fullRedraw = true;
+    if (!enabled && backBuffer) {
+        SDL_DestroyTexture(backBuffer);
+        backBuffer = nullptr;
+    }
 }
 
-Entity* GameEngine::getEntity(const std::string& name) {
-    auto it = entities.find(name);
-    if (it != entities.end()) {
-        return &it->second;
+// SDL_RENDER_TARGETS_RESET loses the contents of the target textures;
+// SDL_RENDER_DEVICE_RESET loses the textures themselves.
+void GameEngine::handleEvent(const SDL_Event& event) {
+    if (event.type == SDL_RENDER_TARGETS_RESET) {
+        fullRedraw = true;
+        gridCache.dirty = true;
+        for (StaticLayer& layer : staticLayers) {
+            layer.cache.dirty = true;
+        }
+    } else if (event.type == SDL_RENDER_DEVICE_RESET) {
+        releaseLayerCaches();
     }
-    return nullptr;
+}
+
+bool GameEngine::resolve(EntityHandle handle, uint32_t* dense) const {
+    if (handle.index >= slots.size() || slots[handle.index].generation != handle.generation) {
+        return false;
+    }
+    *dense = slots[handle.index].dense;
+    return true;
 }
 
 void GameEngine::update(float deltaTime) {
@@ -94,12 +399,30 @@ void GameEngine::update(float deltaTime) {
 }
 
 void GameEngine::render() {
+    if (!incremental || !renderIncremental()) {
+        renderBoard();
+        redrawnCells = static_cast<size_t>(gridWidth) * gridHeight;
+    }
+    Renderer::present(renderer);
+}
+
+// Everything, into the current render target.
+void GameEngine::renderBoard() {
     Renderer::clear(renderer, backgroundColor.r, backgroundColor.g, backgroundColor.b);
     
-    renderGrid();
+    if (updateLayerCaches()) {
+        compositeCache(gridCache);
+        for (const StaticLayer& layer : staticLayers) {
+            compositeCache(layer.cache);
+        }
+    } else {
+        renderGrid();
+        for (const StaticLayer& layer : staticLayers) {
+            renderStaticLayer(layer);
+        }
+    }
     renderEntities();
-    
-    Renderer::present(renderer);
+    batch.flush(renderer);
 }
 
 void GameEngine::renderGrid() {
@@ -110,37 +433,271 @@ void GameEngine::renderGrid() {
     
     // Vertical lines
     for (int x = 0; x <= gridWidth; x++) {
-        Renderer::drawLine(renderer, x * cellSize, 0, x * cellSize, gridHeight * cellSize,
-                          gridR, gridG, gridB, 100);
+        batch.drawLine(x * cellSize, 0, x * cellSize, gridHeight * cellSize,
+                       gridR, gridG, gridB, 100);
     }
     
     // Horizontal lines
     for (int y = 0; y <= gridHeight; y++) {
-        Renderer::drawLine(renderer, 0, y * cellSize, gridWidth * cellSize, y * cellSize,
-                          gridR, gridG, gridB, 100);
+        batch.drawLine(0, y * cellSize, gridWidth * cellSize, y * cellSize,
+                       gridR, gridG, gridB, 100);
+    }
+}
+
+void GameEngine::renderStaticLayer(const StaticLayer& layer) {
+    for (const Entity& entity : layer.entities) {
+        if (entity.visible) {
+            queueEntity(entity.position, Point(entity.width, entity.height), entity.color);
+        }
     }
 }
 
 void GameEngine::renderEntities() {
-    for (auto& pair : entities) {
-        Entity& entity = pair.second;
-        
-        if (!entity.visible) continue;
-        
-        int pixelX = entity.position.x * cellSize + cellSize / 2;
-        int pixelY = entity.position.y * cellSize + cellSize / 2;
-        int pixelW = entity.width * cellSize;
-        int pixelH = entity.height * cellSize;
-        
-        Renderer::fillRect(renderer, 
-                          pixelX - pixelW / 2, 
-                          pixelY - pixelH / 2, 
-                          pixelW, 
-                          pixelH,
-                          entity.color.r, 
-                          entity.color.g, 
-                          entity.color.b, 
-                          entity.color.a);
+    for (size_t i = 0; i < positions.size(); i++) {
+        if (!(flags[i] & ENTITY_VISIBLE)) continue;
+        queueEntity(positions[i], sizes[i], colors[i]);
+    }
+}
+
+void GameEngine::queueEntity(const Point& position, const Point& size, const Color& color) {
+    SDL_Rect area = entityArea(position, size);
+    batch.fillRect(area.x, area.y, area.w, area.h, color.r, color.g, color.b, color.a);
+}
+
+// Entities are centered on their cell and span size cells.
+SDL_Rect GameEngine::entityArea(const Point& position, const Point& size) const {
+    int pixelX = position.x * cellSize + cellSize / 2;
+    int pixelY = position.y * cellSize + cellSize / 2;
+    int pixelW = size.x * cellSize;
+    int pixelH = size.y * cellSize;
+    SDL_Rect area = {pixelX - pixelW / 2, pixelY - pixelH / 2, pixelW, pixelH};
+    return area;
+}
+
+// Brings the back buffer up to date and copies it to the screen. Returns
+// false, leaving the screen untouched, if there is no back buffer.
+bool GameEngine::renderIncremental() {
+    // The layer caches first: redrawing one resets the render target.
+    if (!updateLayerCaches()) {
+        return false;
+    }
+    int boardW = gridWidth * cellSize + 1;
+    int boardH = gridHeight * cellSize + 1;
+    if (!backBuffer) {
+        backBuffer = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, boardW, boardH);
+        if (!backBuffer || SDL_SetTextureBlendMode(backBuffer, SDL_BLENDMODE_NONE) != 0) {
+            std::cerr << "Warning: no back buffer, drawing every frame in full. SDL_Error: "
+                      << SDL_GetError() << std::endl;
+            setIncrementalRendering(false);
+            return false;
+        }
+        fullRedraw = true;
+    }
+    int width = 0, height = 0;
+    SDL_GetRendererOutputSize(renderer, &width, &height);
+    if (width != outputWidth || height != outputHeight) {
+        outputWidth = width;
+        outputHeight = height;
+        fullRedraw = true;
+    }
+    
+    computeSignatures();
+    size_t cellCount = frameSignatures.size();
+    size_t dirty = 0;
+    for (size_t i = 0; i < cellCount; i++) {
+        if (frameSignatures[i] != drawnSignatures[i]) dirty++;
+    }
+    
+    SDL_SetRenderTarget(renderer, backBuffer);
+    if (fullRedraw || dirty * 2 > cellCount) {
+        // Past half the board one pass is cheaper than clipped pieces
+        renderBoard();
+        redrawnCells = cellCount;
+        fullRedraw = false;
+    } else {
+        // One clipped redraw per run of dirty cells in a row. The last row
+        // and column also own the closing grid line.
+        for (int y = 0; y < gridHeight; y++) {
+            int x = 0;
+            while (x < gridWidth) {
+                size_t cell = static_cast<size_t>(y) * gridWidth + x;
+                if (frameSignatures[cell] == drawnSignatures[cell]) {
+                    x++;
+                    continue;
+                }
+                int start = x;
+                while (x < gridWidth && frameSignatures[cell] != drawnSignatures[cell]) {
+                    x++;
+                    cell++;
+                }
+                SDL_Rect area = {start * cellSize, y * cellSize, (x - start) * cellSize, cellSize};
+                if (x == gridWidth) area.w++;
+                if (y == gridHeight - 1) area.h++;
+                redrawArea(area);
+            }
+        }
+        redrawnCells = dirty;
+    }
+    drawnSignatures.swap(frameSignatures);
+    SDL_SetRenderTarget(renderer, nullptr);
+    
+    Renderer::clear(renderer, backgroundColor.r, backgroundColor.g, backgroundColor.b);
+    SDL_Rect board = {0, 0, boardW, boardH};
+    SDL_RenderCopy(renderer, backBuffer, nullptr, &board);
+    return true;
+}
+
+void GameEngine::computeSignatures() {
+    size_t cellCount = static_cast<size_t>(gridWidth) * gridHeight;
+    if (staticSignaturesDirty || staticSignatures.size() != cellCount) {
+        staticSignatures.assign(cellCount, 0);
+        for (const StaticLayer& layer : staticLayers) {
+            for (const Entity& entity : layer.entities) {
+                if (entity.visible) {
+                    signEntity(staticSignatures, entity.position, Point(entity.width, entity.height), entity.color);
+                }
+            }
+        }
+        staticSignaturesDirty = false;
+    }
+    if (drawnSignatures.size() != cellCount) {
+        drawnSignatures.assign(cellCount, 0);
+        fullRedraw = true;
+    }
+    frameSignatures = staticSignatures;
+    for (size_t i = 0; i < positions.size(); i++) {
+        if (flags[i] & ENTITY_VISIBLE) {
+            signEntity(frameSignatures, positions[i], sizes[i], colors[i]);
+        }
     }
 }
 
+// Folds the entity's area and color into every cell it touches. The fold
+// depends on order, so swapping two overlapping entities dirties the cell.
+void GameEngine::signEntity(std::vector<uint64_t>& signatures, const Point& position, const Point& size,
+                            const Color& color) const {
+    SDL_Rect area = entityArea(position, size);
+    if (area.w <= 0 || area.h <= 0 || area.x >= gridWidth * cellSize || area.y >= gridHeight * cellSize ||
+        area.x + area.w <= 0 || area.y + area.h <= 0) {
+        return;
+    }
+    int firstX = std::max(area.x, 0) / cellSize;
+    int firstY = std::max(area.y, 0) / cellSize;
+    int lastX = std::min((area.x + area.w - 1) / cellSize, gridWidth - 1);
+    int lastY = std::min((area.y + area.h - 1) / cellSize, gridHeight - 1);
+    
+    uint64_t value = static_cast<uint32_t>(area.x) | (static_cast<uint64_t>(static_cast<uint32_t>(area.y)) << 32);
+    value = value * 0x9E3779B97F4A7C15ull ^ (static_cast<uint64_t>(static_cast<uint32_t>(area.w)) << 32 | static_cast<uint32_t>(area.h));
+    value = value * 0x9E3779B97F4A7C15ull ^ ((static_cast<uint32_t>(color.r) << 24) | (color.g << 16) | (color.b << 8) | color.a);
+    for (int y = firstY; y <= lastY; y++) {
+        for (int x = firstX; x <= lastX; x++) {
+            uint64_t& signature = signatures[static_cast<size_t>(y) * gridWidth + x];
+            signature = (signature ^ value) * 0xBF58476D1CE4E5B9ull;
+            signature ^= signature >> 31;
+        }
+    }
+}
+
+// Redraws area of the back buffer from scratch, clipped to it.
+void GameEngine::redrawArea(const SDL_Rect& area) {
+    SDL_RenderSetClipRect(renderer, &area);
+    Renderer::fillRect(renderer, area.x, area.y, area.w, area.h,
+                       backgroundColor.r, backgroundColor.g, backgroundColor.b);
+    compositeCache(gridCache);
+    for (const StaticLayer& layer : staticLayers) {
+        compositeCache(layer.cache);
+    }
+    for (size_t i = 0; i < positions.size(); i++) {
+        if (!(flags[i] & ENTITY_VISIBLE)) continue;
+        SDL_Rect entity = entityArea(positions[i], sizes[i]);
+        if (entity.x < area.x + area.w && area.x < entity.x + entity.w &&
+            entity.y < area.y + area.h && area.y < entity.y + entity.h) {
+            batch.fillRect(entity.x, entity.y, entity.w, entity.h,
+                           colors[i].r, colors[i].g, colors[i].b, colors[i].a);
+        }
+    }
+    batch.flush(renderer);
+    SDL_RenderSetClipRect(renderer, nullptr);
+}
+
+// Redraws the dirty caches. Returns false if caching is off, in which case
+// render() draws every layer directly.
+bool GameEngine::updateLayerCaches() {
+    if (!useLayerCache) {
+        return false;
+    }
+    if (gridCache.dirty) {
+        if (!beginCache(gridCache)) return false;
+        renderGrid();
+        endCache(gridCache);
+    }
+    for (StaticLayer& layer : staticLayers) {
+        if (layer.cache.dirty) {
+            if (!beginCache(layer.cache)) return false;
+            renderStaticLayer(layer);
+            endCache(layer.cache);
+        }
+    }
+    return true;
+}
+
+// Points the renderer at the cache's texture, creating it on first use,
+// and clears it to transparent. On failure caching is turned off for good.
+bool GameEngine::beginCache(LayerCache& cache) {
+    if (!cache.texture) {
+        // One pixel more than the grid for the last grid line
+        cache.texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET,
+                                          gridWidth * cellSize + 1, gridHeight * cellSize + 1);
+        // Blending into a transparent target leaves color * alpha in the
+        // texture, so it is composited with "one, one minus source alpha".
+        SDL_BlendMode premultiplied = SDL_ComposeCustomBlendMode(
+            SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD,
+            SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD);
+        if (!cache.texture || SDL_SetTextureBlendMode(cache.texture, premultiplied) != 0) {
+            std::cerr << "Warning: layer textures unavailable, drawing every layer each frame. SDL_Error: "
+                      << SDL_GetError() << std::endl;
+            releaseLayerCaches();
+            useLayerCache = false;
+            return false;
+        }
+    }
+    if (SDL_SetRenderTarget(renderer, cache.texture) != 0) {
+        releaseLayerCaches();
+        useLayerCache = false;
+        return false;
+    }
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+    SDL_RenderClear(renderer);
+    return true;
+}
+
+void GameEngine::endCache(LayerCache& cache) {
+    batch.flush(renderer);
+    SDL_SetRenderTarget(renderer, nullptr);
+    cache.dirty = false;
+}
+
+void GameEngine::compositeCache(const LayerCache& cache) {
+    SDL_Rect area = {0, 0, gridWidth * cellSize + 1, gridHeight * cellSize + 1};
+    SDL_RenderCopy(renderer, cache.texture, nullptr, &area);
+}
+
+void GameEngine::releaseLayerCaches() {
+    if (backBuffer) {
+        SDL_DestroyTexture(backBuffer);
+        backBuffer = nullptr;
+    }
+    fullRedraw = true;
+    if (gridCache.texture) {
+        SDL_DestroyTexture(gridCache.texture);
+        gridCache.texture = nullptr;
+    }
+    gridCache.dirty = true;
+    for (StaticLayer& layer : staticLayers) {
+        if (layer.cache.texture) {
+            SDL_DestroyTexture(layer.cache.texture);
+            layer.cache.texture = nullptr;
+        }
+        layer.cache.dirty = true;
+    }
+}
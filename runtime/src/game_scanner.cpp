@@ -0,0 +1,109 @@
+#include "game_scanner.hpp"
+#include "brick_loader.hpp"
+#include <algorithm>
+#include <dirent.h>
+#include <sys/stat.h>
+
+namespace {
+
+bool gameBefore(const BrickGame& a, const BrickGame& b) {
+    if (a.displayName != b.displayName) {
+        return a.displayName < b.displayName;
+    }
+    return a.filename < b.filename;
+}
+
+}
+
+GameScanner::GameScanner(size_t workers)
+    : workerCount_(workers), next_(0), finished_(0) {
+    if (workerCount_ == 0) {
+        workerCount_ = std::max(1u, std::thread::hardware_concurrency());
+    }
+}
+
+GameScanner::~GameScanner() {
+    wait();
+}
+
+void GameScanner::start(const std::string& directory) {
+    wait();
+    files_.clear();
+    pending_.clear();
+    next_ = 0;
+    finished_ = 0;
+
+    struct stat info;
+    if (stat(directory.c_str(), &info) != 0 || !(info.st_mode & S_IFDIR)) {
+        return;
+    }
+    DIR* dir = opendir(directory.c_str());
+    if (!dir) {
+        return;
+    }
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != nullptr) {
+        std::string filename = entry->d_name;
+        if (filename.length() > 6 && filename.substr(filename.length() - 6) == ".brick") {
+            files_.push_back(directory + filename);
+        }
+    }
+    closedir(dir);
+
+    size_t count = std::min(workerCount_, files_.size());
+    for (size_t i = 0; i < count; ++i) {
+        workers_.push_back(std::thread(&GameScanner::work, this));
+    }
+}
+
+void GameScanner::wait() {
+    for (size_t i = 0; i < workers_.size(); ++i) {
+        workers_[i].join();
+    }
+    workers_.clear();
+}
+
+// Listing a game only needs its header; the full compile waits until the
+// game is picked. Probes share nothing but the task counter and the list.
+void GameScanner::work() {
+    size_t index;
+    while ((index = next_++) < files_.size()) {
+        GameMetadata meta = BrickLoader::probeMetadata(files_[index]);
+        if (meta.valid) {
+            BrickGame game;
+            game.filename = files_[index];
+            game.displayName = meta.name;
+            std::lock_guard<std::mutex> lock(mutex_);
+            pending_.push_back(game);
+        }
+        ++finished_;
+    }
+}
+
+bool GameScanner::collect(std::vector<BrickGame>& games) {
+    std::vector<BrickGame> ready;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ready.swap(pending_);
+    }
+    if (ready.empty()) {
+        return false;
+    }
+    std::sort(ready.begin(), ready.end(), gameBefore);
+    size_t middle = games.size();
+    games.insert(games.end(), ready.begin(), ready.end());
+    std::inplace_merge(games.begin(), games.begin() + middle, games.end(), gameBefore);
+    return true;
+}
+
+bool GameScanner::done() const {
+    return finished_ == files_.size();
+}
+
+size_t GameScanner::scanned() const {
+    return finished_;
+}
+
+size_t GameScanner::total() const {
+    return files_.size();
+}
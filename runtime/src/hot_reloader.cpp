@@ -0,0 +1,240 @@
+#include "hot_reloader.hpp"
+#include "game_engine.hpp"
+#include "../../brickc/src/symbols.hpp"
+#include <cerrno>
+#include <iostream>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
+
+namespace {
+
+// Editors often write a file in several steps; compile once it is quiet.
+const int SETTLE_MS = 50;
+// Without inotify the file's mtime is checked at this interval.
+const int POLL_MS = 250;
+
+bool sameEntity(const brick::Entity& a, const brick::Entity& b) {
+    return a.spawn.x == b.spawn.x && a.spawn.y == b.spawn.y &&
+           a.color == b.color && a.solid == b.solid;
+}
+
+}
+
+ReloadDiff::ReloadDiff()
+    : speedChanged(false), gridChanged(false), colorChanged(false) {
+}
+
+bool ReloadDiff::empty() const {
+    return !speedChanged && !gridChanged && !colorChanged && changedEntities.empty() &&
+           addedEntities.empty() && removedEntities.empty();
+}
+
+HotReloader::HotReloader()
+    : stopping_(false), ready_(false), reloads_(0), failures_(0),
+      inotifyFd_(-1), lastModified_(0), lastSize_(0) {
+    wakePipe_[0] = wakePipe_[1] = -1;
+}
+
+HotReloader::~HotReloader() {
+    stop();
+}
+
+bool HotReloader::watch(const std::string& filename) {
+    stop();
+    filename_ = filename;
+    size_t slash = filename.find_last_of('/');
+    std::string directory = slash == std::string::npos ? "." : filename.substr(0, slash + 1);
+    basename_ = slash == std::string::npos ? filename : filename.substr(slash + 1);
+
+    struct stat info;
+    if (stat(filename.c_str(), &info) != 0 || pipe(wakePipe_) != 0) {
+        wakePipe_[0] = wakePipe_[1] = -1;
+        return false;
+    }
+    lastModified_ = static_cast<long long>(info.st_mtime);
+    lastSize_ = static_cast<long long>(info.st_size);
+#ifdef __linux__
+    inotifyFd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotifyFd_ < 0 || inotify_add_watch(inotifyFd_, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+        if (inotifyFd_ >= 0) {
+            close(inotifyFd_);
+            inotifyFd_ = -1;
+        }
+    }
+#endif
+    stopping_ = false;
+    thread_ = std::thread(&HotReloader::run, this);
+    return true;
+}
+
+void HotReloader::stop() {
+    if (thread_.joinable()) {
+        stopping_ = true;
+        char byte = 0;
+        ssize_t written = write(wakePipe_[1], &byte, 1);
+        (void)written;
+        thread_.join();
+    }
+    for (int i = 0; i < 2; ++i) {
+        if (wakePipe_[i] >= 0) {
+            close(wakePipe_[i]);
+            wakePipe_[i] = -1;
+        }
+    }
+    if (inotifyFd_ >= 0) {
+        close(inotifyFd_);
+        inotifyFd_ = -1;
+    }
+}
+
+std::unique_ptr<BrickLoader> HotReloader::take() {
+    if (!ready_.load(std::memory_order_acquire)) {
+        return nullptr;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    ready_ = false;
+    return std::move(pending_);
+}
+
+void HotReloader::run() {
+    while (waitForChange()) {
+        compile();
+    }
+}
+
+// Blocks until the file has changed and then stayed quiet for SETTLE_MS.
+// Returns false when stop() is called.
+bool HotReloader::waitForChange() {
+    bool changed = false;
+    for (;;) {
+        struct pollfd fds[2];
+        fds[0].fd = wakePipe_[0];
+        fds[0].events = POLLIN;
+        fds[0].revents = 0;
+        fds[1].fd = inotifyFd_;
+        fds[1].events = POLLIN;
+        fds[1].revents = 0;
+        int count = inotifyFd_ >= 0 ? 2 : 1;
+        int timeout = changed ? SETTLE_MS : (inotifyFd_ >= 0 ? -1 : POLL_MS);
+        int ready = poll(fds, count, timeout);
+        if (stopping_ || (ready < 0 && errno != EINTR)) {
+            return false;
+        }
+        if (ready > 0 || inotifyFd_ < 0) {
+            if (fileChanged()) {
+                changed = true;
+                continue;
+            }
+        }
+        if (ready == 0 && changed) {
+            return true;
+        }
+    }
+}
+
+// Drains the pending inotify events, or compares mtime and size when there
+// is no inotify. True if any of them is about the watched file.
+bool HotReloader::fileChanged() {
+#ifdef __linux__
+    if (inotifyFd_ >= 0) {
+        bool matched = false;
+        alignas(struct inotify_event) char buffer[4096];
+        ssize_t length;
+        while ((length = read(inotifyFd_, buffer, sizeof(buffer))) > 0) {
+            for (char* at = buffer; at < buffer + length; ) {
+                const struct inotify_event* event = reinterpret_cast<const struct inotify_event*>(at);
+                if (event->len > 0 && basename_ == event->name) {
+                    matched = true;
+                }
+                at += sizeof(struct inotify_event) + event->len;
+            }
+        }
+        return matched;
+    }
+#endif
+    struct stat info;
+    if (stat(filename_.c_str(), &info) != 0) {
+        return false;
+    }
+    long long modified = static_cast<long long>(info.st_mtime);
+    long long size = static_cast<long long>(info.st_size);
+    if (modified == lastModified_ && size == lastSize_) {
+        return false;
+    }
+    lastModified_ = modified;
+    lastSize_ = size;
+    return true;
+}
+
+// A fresh loader per attempt: loaders are not thread-safe, and the live one
+// belongs to the game thread until take() hands this one over.
+void HotReloader::compile() {
+    std::unique_ptr<BrickLoader> loader(new BrickLoader());
+    if (!loader->loadBrickFile(filename_)) {
+        ++failures_;
+        std::cerr << "Hot reload: " << filename_ << " does not compile, keeping the running version" << std::endl;
+        std::cerr << loader->getErrorMessages();
+        return;
+    }
+    ++reloads_;
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_ = std::move(loader);
+    ready_.store(true, std::memory_order_release);
+}
+
+ReloadDiff HotReloader::diff(const brick::SymbolTable& live, const brick::SymbolTable& next) {
+    ReloadDiff result;
+    result.speedChanged = live.hasSpeedSetting() != next.hasSpeedSetting() || live.getSpeed() != next.getSpeed();
+    result.gridChanged = live.hasGridSetting() != next.hasGridSetting() ||
+                         live.getGridWidth() != next.getGridWidth() ||
+                         live.getGridHeight() != next.getGridHeight();
+    result.colorChanged = live.hasColorSetting() != next.hasColorSetting() ||
+                          live.getGameColor() != next.getGameColor();
+
+    for (const brick::Entity& entity : live.getEntities()) {
+        const brick::Entity* updated = next.findEntity(entity.name);
+        if (!updated) {
+            result.removedEntities.push_back(entity.name);
+        } else if (!sameEntity(entity, *updated)) {
+            result.changedEntities.push_back(entity.name);
+        }
+    }
+    for (const brick::Entity& entity : next.getEntities()) {
+        if (!live.entityExists(entity.name)) {
+            result.addedEntities.push_back(entity.name);
+        }
+    }
+    return result;
+}
+
+bool HotReloader::apply(BrickLoader& live, ReloadDiff* changes) {
+    std::unique_ptr<BrickLoader> reloaded = take();
+    if (!reloaded || !live.isLoaded()) {
+        return false;
+    }
+    *changes = diff(*live.getSymbolTable(), *reloaded->getSymbolTable());
+    live.swap(*reloaded);
+    return true;
+}
+
+void HotReloader::replaceEntity(GameEngine& engine, const BrickLoader& loader, const std::string& name) {
+    const brick::Entity* entity = loader.findEntity(name);
+    if (entity) {
+        engine.addEntity(name, Entity(Point(entity->spawn.x, entity->spawn.y), Color::fromHex(entity->color)));
+    } else {
+        engine.removeEntity(name);
+    }
+}
+
+unsigned long HotReloader::reloads() const {
+    return reloads_;
+}
+
+unsigned long HotReloader::failures() const {
+    return failures_;
+}
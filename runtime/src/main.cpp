@@ -1,4 +1,6 @@
 #include "brick_loader.hpp"
+#include "compile_cache.hpp"
+#include "game_scanner.hpp"
 #include "snake_game.hpp"
 #include "tetris_game.hpp"
 #include "tank_game.hpp"
@@ -7,25 +9,24 @@
 #include <iostream>
 #include <vector>
 #include <algorithm>
-#include <dirent.h>
-#include <sys/stat.h>
-
-struct BrickGame {
-    std::string filename;
-    std::string displayName;
-};
 
 class SimpleMenu {
 private:
     SDL_Window* window;
     SDL_Renderer* renderer;
     std::vector<BrickGame> games;
+    GameScanner scanner;
+    bool scanReported;
     int selectedIndex;
     bool running;
     TTF_Font* font;
+    bool incrementalRendering;
     
 public:
-    SimpleMenu() : window(nullptr), renderer(nullptr), selectedIndex(0), running(false), font(nullptr) {}
+    SimpleMenu() : window(nullptr), renderer(nullptr), scanReported(false), selectedIndex(0), running(false), font(nullptr),
+                   incrementalRendering(false) {}
+    
+    void setIncrementalRendering(bool enabled) { incrementalRendering = enabled; }
     
     ~SimpleMenu() {
         if (font) TTF_CloseFont(font);
@@ -89,40 +90,38 @@ public:
     
     void scanForGames() {
         games.clear();
-        
-        std::string searchPath = "../../brickc/examples/";
-        
-        struct stat info;
-        if (stat(searchPath.c_str(), &info) == 0 && (info.st_mode & S_IFDIR)) {
-            DIR* dir = opendir(searchPath.c_str());
-            if (dir) {
-                struct dirent* entry;
-                while ((entry = readdir(dir)) != nullptr) {
-                    std::string filename = entry->d_name;
-                    
-                    if (filename == "." || filename == "..") continue;
-                    
-                    if (filename.length() > 6 && 
-                        filename.substr(filename.length() - 6) == ".brick") {
-                        
-                        std::string filepath = searchPath + filename;
-                        BrickLoader loader;
-                        if (loader.loadBrickFile(filepath)) {
-                            BrickGame game;
-                            game.filename = filepath;
-                            game.displayName = loader.getGameName();
-                            games.push_back(game);
-                        }
-                    }
+        scanReported = false;
+        scanner.start("../../brickc/examples/");
+    }
+    
+    // Called every frame: adds the games compiled since the last frame and
+    // keeps the same game selected while the list grows.
+    void updateGames() {
+        bool finished = scanner.done();
+        std::string selected;
+        if (selectedIndex < static_cast<int>(games.size())) {
+            selected = games[selectedIndex].filename;
+        }
+        if (scanner.collect(games) && !selected.empty()) {
+            for (size_t i = 0; i < games.size(); i++) {
+                if (games[i].filename == selected) {
+                    selectedIndex = static_cast<int>(i);
+                    break;
                 }
-                closedir(dir);
             }
         }
+        if (!finished || scanReported) return;
+        scanReported = true;
         
-        std::sort(games.begin(), games.end(), 
-            [](const BrickGame& a, const BrickGame& b) -> bool {
-                return a.displayName < b.displayName;
-            });
+        if (games.empty()) {
+            std::cout << "No .brick files found!" << std::endl;
+            running = false;
+            return;
+        }
+        std::cout << "Found " << games.size() << " brick games:" << std::endl;
+        for (const auto& game : games) {
+            std::cout << "  - " << game.displayName << std::endl;
+        }
     }
     
     void renderText(const std::string& text, int x, int y, SDL_Color color, SDL_Texture** texture, SDL_Rect* rect) {
@@ -183,7 +182,11 @@ public:
         
         SDL_Texture* instrTexture;
         SDL_Rect instrRect;
-        renderText("Use Arrow Keys to Navigate, ENTER to Select, ESC to Exit", 100, 500, gray, &instrTexture, &instrRect);
+        std::string instructions = "Use Arrow Keys to Navigate, ENTER to Select, ESC to Exit";
+        if (!scanner.done()) {
+            instructions = "Scanning games... " + std::to_string(scanner.scanned()) + "/" + std::to_string(scanner.total());
+        }
+        renderText(instructions, 100, 500, gray, &instrTexture, &instrRect);
         SDL_RenderCopy(renderer, instrTexture, NULL, &instrRect);
         SDL_DestroyTexture(instrTexture);
         
@@ -241,6 +244,7 @@ public:
         
         if (gameName.find("snake") != std::string::npos) {
             SnakeGame snakeGame(window, renderer, game.filename, 20);
+            snakeGame.setIncrementalRendering(incrementalRendering);
             std::cout << "Initializing Snake game..." << std::endl;
             if (snakeGame.initialize()) {
                 std::cout << "Snake game initialized, starting..." << std::endl;
@@ -251,6 +255,7 @@ public:
             }
         } else if (gameName.find("tetris") != std::string::npos) {
             TetrisGame tetrisGame(window, renderer, game.filename, 30);
+            tetrisGame.setIncrementalRendering(incrementalRendering);
             std::cout << "Initializing Tetris game..." << std::endl;
             if (tetrisGame.initialize()) {
                 std::cout << "Tetris game initialized, starting..." << std::endl;
@@ -261,6 +266,7 @@ public:
             }
         } else if (gameName.find("tank") != std::string::npos) {
             TankGame tankGame(window, renderer, game.filename, 25);
+            tankGame.setIncrementalRendering(incrementalRendering);
             std::cout << "Initializing Tank game..." << std::endl;
             if (tankGame.initialize()) {
                 std::cout << "Tank game initialized, starting..." << std::endl;
@@ -272,6 +278,7 @@ public:
         } else {
             std::cout << "Unknown game type '" << gameName << "', using Snake as default..." << std::endl;
             SnakeGame snakeGame(window, renderer, game.filename, 20);
+            snakeGame.setIncrementalRendering(incrementalRendering);
             if (snakeGame.initialize()) {
                 snakeGame.run();
             }
@@ -280,19 +287,11 @@ public:
     
     void run() {
         if (!initialize()) return;
-        if (games.empty()) {
-            std::cout << "No .brick files found!" << std::endl;
-            return;
-        }
-        
-        std::cout << "Found " << games.size() << " brick games:" << std::endl;
-        for (const auto& game : games) {
-            std::cout << "  - " << game.displayName << std::endl;
-        }
         std::cout << "\nUse arrow keys to navigate, ENTER to select, ESC to exit" << std::endl;
         
         running = true;
         while (running) {
+            updateGames();
             handleEvents();
             render();
             SDL_Delay(16);
@@ -300,8 +299,28 @@ public:
     }
 };
 
-int main() {
+int main(int argc, char* argv[]) {
+    CompileCache& cache = CompileCache::shared();
+    bool incrementalRendering = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--clear-cache") {
+            size_t removed = cache.clear();
+            std::cout << "Removed " << removed << " cached images from " << cache.directory() << std::endl;
+            return 0;
+        }
+        // Redraw only the cells that change; for large grids and slow GPUs
+        if (arg == "--incremental-render") {
+            incrementalRendering = true;
+        }
+    }
+    
     SimpleMenu menu;
+    menu.setIncrementalRendering(incrementalRendering);
     menu.run();
+    
+    CompileCache::Stats stats = cache.stats();
+    std::cout << "Compile cache (" << cache.directory() << "): " << stats.hits << " hits, "
+              << stats.misses << " misses, " << stats.stores << " stored" << std::endl;
     return 0;
 }
\ No newline at end of file
@@ -1,5 +1,7 @@
 #include "renderer.hpp"
+#include <algorithm>
 #include <cmath>
+#include <cstdlib>
 
 // ============================================================================
 // Renderer Implementation
@@ -28,18 +30,16 @@ void Renderer::drawLine(SDL_Renderer* renderer, int x1, int y1, int x2, int y2,
 void Renderer::drawCircle(SDL_Renderer* renderer, int x, int y, int radius,
                           Uint8 r, Uint8 g, Uint8 b, Uint8 a) {
     SDL_SetRenderDrawColor(renderer, r, g, b, a);
+    std::vector<SDL_Point> points;
     int d = (5 - radius * 4) / 8;
     int cx = 0, cy = radius;
     
     while (cx <= cy) {
-        SDL_RenderDrawPoint(renderer, x + cx, y + cy);
-        SDL_RenderDrawPoint(renderer, x - cx, y + cy);
-        SDL_RenderDrawPoint(renderer, x + cx, y - cy);
-        SDL_RenderDrawPoint(renderer, x - cx, y - cy);
-        SDL_RenderDrawPoint(renderer, x + cy, y + cx);
-        SDL_RenderDrawPoint(renderer, x - cy, y + cx);
-        SDL_RenderDrawPoint(renderer, x + cy, y - cx);
-        SDL_RenderDrawPoint(renderer, x - cy, y - cx);
+        SDL_Point octants[8] = {
+            {x + cx, y + cy}, {x - cx, y + cy}, {x + cx, y - cy}, {x - cx, y - cy},
+            {x + cy, y + cx}, {x - cy, y + cx}, {x + cy, y - cx}, {x - cy, y - cx}
+        };
+        points.insert(points.end(), octants, octants + 8);
         
         if (d < 0) {
             d = d + 2 * cx + 1;
@@ -49,19 +49,24 @@ void Renderer::drawCircle(SDL_Renderer* renderer, int x, int y, int radius,
         }
         cx++;
     }
+    SDL_RenderDrawPoints(renderer, points.data(), static_cast<int>(points.size()));
 }
 
+// One span per row, all drawn with a single SDL_RenderFillRects.
 void Renderer::fillCircle(SDL_Renderer* renderer, int x, int y, int radius,
                           Uint8 r, Uint8 g, Uint8 b, Uint8 a) {
     SDL_SetRenderDrawColor(renderer, r, g, b, a);
+    std::vector<SDL_Rect> spans;
     
     for (int dy = -radius; dy <= radius; dy++) {
-        for (int dx = -radius; dx <= radius; dx++) {
-            if (dx*dx + dy*dy <= radius*radius) {
-                SDL_RenderDrawPoint(renderer, x + dx, y + dy);
-            }
+        int half = 0;
+        while ((half + 1) * (half + 1) + dy * dy <= radius * radius) {
+            half++;
         }
+        SDL_Rect span = {x - half, y + dy, 2 * half + 1, 1};
+        spans.push_back(span);
     }
+    SDL_RenderFillRects(renderer, spans.data(), static_cast<int>(spans.size()));
 }
 
 void Renderer::clear(SDL_Renderer* renderer, Uint8 r, Uint8 g, Uint8 b) {
@@ -73,3 +78,154 @@ void Renderer::present(SDL_Renderer* renderer) {
     SDL_RenderPresent(renderer);
 }
 
+
+// ============================================================================
+// Render Batch Implementation
+// ============================================================================
+
+namespace {
+
+bool overlaps(const SDL_Rect& a, const SDL_Rect& b) {
+    return a.x < b.x + b.w && b.x < a.x + a.w &&
+           a.y < b.y + b.h && b.y < a.y + a.h;
+}
+
+SDL_Rect unite(const SDL_Rect& a, const SDL_Rect& b) {
+    int left = std::min(a.x, b.x);
+    int top = std::min(a.y, b.y);
+    int right = std::max(a.x + a.w, b.x + b.w);
+    int bottom = std::max(a.y + a.h, b.y + b.h);
+    SDL_Rect result = {left, top, right - left, bottom - top};
+    return result;
+}
+
+bool samePoint(const SDL_Point& a, const SDL_Point& b) {
+    return a.x == b.x && a.y == b.y;
+}
+
+}
+
+RenderBatch::RenderBatch() : used_(0), blendMode_(SDL_BLENDMODE_BLEND) {
+}
+
+void RenderBatch::setBlendMode(SDL_BlendMode mode) {
+    blendMode_ = mode;
+}
+
+void RenderBatch::fillRect(int x, int y, int w, int h,
+                           Uint8 r, Uint8 g, Uint8 b, Uint8 a) {
+    if (w <= 0 || h <= 0) {
+        return;
+    }
+    SDL_Rect rect = {x, y, w, h};
+    bucketFor(r, g, b, a, rect).rects.push_back(rect);
+}
+
+void RenderBatch::drawLine(int x1, int y1, int x2, int y2,
+                           Uint8 r, Uint8 g, Uint8 b, Uint8 a) {
+    // Both end points are drawn, as SDL_RenderDrawLine does.
+    SDL_Rect area = {std::min(x1, x2), std::min(y1, y2),
+                     std::abs(x2 - x1) + 1, std::abs(y2 - y1) + 1};
+    Bucket& bucket = bucketFor(r, g, b, a, area);
+    if (x1 == x2 || y1 == y2) {
+        bucket.rects.push_back(area);
+        return;
+    }
+    SDL_Point start = {x1, y1};
+    SDL_Point end = {x2, y2};
+    bucket.lines.push_back(start);
+    bucket.lines.push_back(end);
+}
+
+void RenderBatch::drawPoint(int x, int y, Uint8 r, Uint8 g, Uint8 b, Uint8 a) {
+    SDL_Rect area = {x, y, 1, 1};
+    SDL_Point point = {x, y};
+    bucketFor(r, g, b, a, area).points.push_back(point);
+}
+
+// The newest bucket with this color and mode, unless something queued after
+// it overlaps area; then the item needs a bucket of its own on top.
+RenderBatch::Bucket& RenderBatch::bucketFor(Uint8 r, Uint8 g, Uint8 b, Uint8 a, const SDL_Rect& area) {
+    Uint32 color = (static_cast<Uint32>(r) << 24) | (static_cast<Uint32>(g) << 16) |
+                   (static_cast<Uint32>(b) << 8) | a;
+    for (size_t i = used_; i-- > 0; ) {
+        Bucket& bucket = buckets_[i];
+        if (bucket.color == color && bucket.blendMode == blendMode_) {
+            bucket.bounds = unite(bucket.bounds, area);
+            return bucket;
+        }
+        if (overlaps(bucket.bounds, area)) {
+            break;
+        }
+    }
+    
+    if (used_ == buckets_.size()) {
+        buckets_.push_back(Bucket());
+    }
+    Bucket& bucket = buckets_[used_++];
+    bucket.color = color;
+    bucket.blendMode = blendMode_;
+    bucket.bounds = area;
+    return bucket;
+}
+
+int RenderBatch::flush(SDL_Renderer* renderer) {
+    SDL_BlendMode previous = SDL_BLENDMODE_NONE;
+    SDL_GetRenderDrawBlendMode(renderer, &previous);
+    SDL_BlendMode current = previous;
+    int calls = 0;
+    
+    for (size_t i = 0; i < used_; i++) {
+        const Bucket& bucket = buckets_[i];
+        if (bucket.blendMode != current) {
+            SDL_SetRenderDrawBlendMode(renderer, bucket.blendMode);
+            current = bucket.blendMode;
+        }
+        SDL_SetRenderDrawColor(renderer, bucket.color >> 24, (bucket.color >> 16) & 0xFF,
+                               (bucket.color >> 8) & 0xFF, bucket.color & 0xFF);
+        if (!bucket.rects.empty()) {
+            SDL_RenderFillRects(renderer, bucket.rects.data(), static_cast<int>(bucket.rects.size()));
+            calls++;
+        }
+        calls += drawSegments(renderer, bucket.lines);
+        if (!bucket.points.empty()) {
+            SDL_RenderDrawPoints(renderer, bucket.points.data(), static_cast<int>(bucket.points.size()));
+            calls++;
+        }
+    }
+    
+    if (current != previous) {
+        SDL_SetRenderDrawBlendMode(renderer, previous);
+    }
+    clear();
+    return calls;
+}
+
+// Segments where each one starts at the previous one's end are joined into
+// a single polyline.
+int RenderBatch::drawSegments(SDL_Renderer* renderer, const std::vector<SDL_Point>& lines) {
+    int calls = 0;
+    size_t i = 0;
+    while (i < lines.size()) {
+        polyline_.clear();
+        polyline_.push_back(lines[i]);
+        polyline_.push_back(lines[i + 1]);
+        i += 2;
+        while (i < lines.size() && samePoint(lines[i], polyline_.back())) {
+            polyline_.push_back(lines[i + 1]);
+            i += 2;
+        }
+        SDL_RenderDrawLines(renderer, polyline_.data(), static_cast<int>(polyline_.size()));
+        calls++;
+    }
+    return calls;
+}
+
+void RenderBatch::clear() {
+    for (size_t i = 0; i < used_; i++) {
+        buckets_[i].rects.clear();
+        buckets_[i].lines.clear();
+        buckets_[i].points.clear();
+    }
+    used_ = 0;
+}
@@ -35,7 +35,7 @@ SnakeGame::SnakeGame(SDL_Window* window, SDL_Renderer* renderer, const std::stri
     std::srand(static_cast<unsigned>(std::time(nullptr)));
     
     if (brickLoader.loadBrickFile(brickFile)) {
-        engine = GameEngine(window, renderer, brickLoader.getGridWidth(), brickLoader.getGridHeight(), cellSize);
+        engine.reset(window, renderer, brickLoader.getGridWidth(), brickLoader.getGridHeight(), cellSize);
         gameSpeed = brickLoader.getSpeed();
         lives = brickLoader.getLives();
         score = brickLoader.getScore();
@@ -43,6 +43,8 @@ SnakeGame::SnakeGame(SDL_Window* window, SDL_Renderer* renderer, const std::stri
         
         Color bgColor = Color::fromHex(brickLoader.getGameColor());
         engine.setBackgroundColor(bgColor);
+        resolveEntityIds();
+        reloader.watch(brickFile);
     }
 }
 
@@ -74,8 +76,8 @@ bool SnakeGame::initialize() {
 void SnakeGame::initializeGame() {
     snake.clear();
     
-    if (useBrickFile && brickLoader.hasEntity("head")) {
-        const brick::Entity* headEntity = brickLoader.findEntity("head");
+    if (useBrickFile && brickLoader.entity(entityIds.head)) {
+        const brick::Entity* headEntity = brickLoader.entity(entityIds.head);
         snake.push_back(SnakeSegment(headEntity->spawn.x, headEntity->spawn.y));
         snake.push_back(SnakeSegment(headEntity->spawn.x - 1, headEntity->spawn.y));
         snake.push_back(SnakeSegment(headEntity->spawn.x - 2, headEntity->spawn.y));
@@ -85,46 +87,54 @@ void SnakeGame::initializeGame() {
         snake.push_back(SnakeSegment(engine.getGridWidth() / 2 - 1, engine.getGridHeight() / 2));
         snake.push_back(SnakeSegment(engine.getGridWidth() / 2 - 2, engine.getGridHeight() / 2));
     }
+    rebuildSnakeLayer();
     
-    if (useBrickFile && brickLoader.hasEntity("fruit")) {
-        const brick::Entity* fruitEntity = brickLoader.findEntity("fruit");
-        fruitPosition = Point(fruitEntity->spawn.x, fruitEntity->spawn.y);
-        std::cout << "Fruit spawned at position from .brick: (" << fruitEntity->spawn.x << ", " << fruitEntity->spawn.y << ")" << std::endl;
-        
-        // Create the visual fruit entity
-        Color fruitColor = Color::fromHex(fruitEntity->color);
-        Entity fruitGameEntity("fruit", fruitPosition, fruitColor);
-        engine.addEntity(fruitGameEntity);
+    // Initialize moving obstacles positions
+    if (useBrickFile && brickLoader.entity(entityIds.obstacle)) {
+        const brick::Entity* obstacleBrickEntity = brickLoader.entity(entityIds.obstacle);
+        obstaclePosition = Point(obstacleBrickEntity->spawn.x, obstacleBrickEntity->spawn.y);
     } else {
-        spawnFruit();
+        obstaclePosition = Point(12, 18); // Default position
     }
     
-    if (useBrickFile && brickLoader.hasEntity("superfruit")) {
-        const brick::Entity* superfruitEntity = brickLoader.findEntity("superfruit");
-        superfruitPosition = Point(superfruitEntity->spawn.x, superfruitEntity->spawn.y);
-        std::cout << "Superfruit spawned at position from .brick: (" << superfruitEntity->spawn.x << ", " << superfruitEntity->spawn.y << ")" << std::endl;
-        
-        // Create the visual superfruit entity
-        Color superfruitColor = Color::fromHex(superfruitEntity->color);
-        Entity superfruitGameEntity("superfruit", superfruitPosition, superfruitColor);
-        engine.addEntity(superfruitGameEntity);
+    if (useBrickFile && brickLoader.entity(entityIds.wall)) {
+        const brick::Entity* wallBrickEntity = brickLoader.entity(entityIds.wall);
+        wallPosition = Point(wallBrickEntity->spawn.x, wallBrickEntity->spawn.y);
     } else {
-        spawnSuperFruit();
+        wallPosition = Point(0, 0); // Default position
     }
     
-    // Initialize moving obstacles positions
-    if (useBrickFile && brickLoader.hasEntity("obstacle")) {
-        const brick::Entity* obstacleEntity = brickLoader.findEntity("obstacle");
-        obstaclePosition = Point(obstacleEntity->spawn.x, obstacleEntity->spawn.y);
+    rebuildSolidLayer();
+    
+    // Fruits go on the pickup layer; off the board until placed
+    engine.getSpatialGrid().clearLayer(LAYER_PICKUP);
+    fruitPosition = Point(-1, -1);
+    superfruitPosition = Point(-1, -1);
+    
+    if (useBrickFile && brickLoader.entity(entityIds.fruit)) {
+        const brick::Entity* fruitBrickEntity = brickLoader.entity(entityIds.fruit);
+        fruitPosition = Point(fruitBrickEntity->spawn.x, fruitBrickEntity->spawn.y);
+        engine.getSpatialGrid().add(fruitPosition, LAYER_PICKUP);
+        std::cout << "Fruit spawned at position from .brick: (" << fruitBrickEntity->spawn.x << ", " << fruitBrickEntity->spawn.y << ")" << std::endl;
+        
+        // Create the visual fruit entity
+        Color fruitColor = Color::fromHex(fruitBrickEntity->color);
+        engine.placeEntity(fruitEntity, Entity(fruitPosition, fruitColor));
     } else {
-        obstaclePosition = Point(12, 18); // Default position
+        spawnFruit();
     }
     
-    if (useBrickFile && brickLoader.hasEntity("wall")) {
-        const brick::Entity* wallEntity = brickLoader.findEntity("wall");
-        wallPosition = Point(wallEntity->spawn.x, wallEntity->spawn.y);
+    if (useBrickFile && brickLoader.entity(entityIds.superfruit)) {
+        const brick::Entity* superfruitBrickEntity = brickLoader.entity(entityIds.superfruit);
+        superfruitPosition = Point(superfruitBrickEntity->spawn.x, superfruitBrickEntity->spawn.y);
+        engine.getSpatialGrid().add(superfruitPosition, LAYER_PICKUP);
+        std::cout << "Superfruit spawned at position from .brick: (" << superfruitBrickEntity->spawn.x << ", " << superfruitBrickEntity->spawn.y << ")" << std::endl;
+        
+        // Create the visual superfruit entity
+        Color superfruitColor = Color::fromHex(superfruitBrickEntity->color);
+        engine.placeEntity(superfruitEntity, Entity(superfruitPosition, superfruitColor));
     } else {
-        wallPosition = Point(0, 0); // Default position
+        spawnSuperFruit();
     }
     
     gameOver = false;
@@ -137,49 +147,45 @@ void SnakeGame::initializeGame() {
 }
 
 void SnakeGame::spawnFruit() {
-    bool validPosition = false;
-    while (!validPosition) {
-        fruitPosition = Point(
-            std::rand() % engine.getGridWidth(),
-            std::rand() % engine.getGridHeight()
-        );
-        validPosition = !isSnakeBody(fruitPosition) && 
-                       fruitPosition != superfruitPosition &&
-                       !isSolidEntity(fruitPosition);
+    SpatialGrid& grid = engine.getSpatialGrid();
+    grid.remove(fruitPosition, LAYER_PICKUP);
+    if (!grid.findFreeCell(LAYER_SNAKE | LAYER_SOLID | LAYER_PICKUP, &fruitPosition)) {
+        // No free cell left: the fruit leaves the board
+        fruitPosition = Point(-1, -1);
+        engine.destroyEntity(fruitEntity);
+        return;
     }
+    grid.add(fruitPosition, LAYER_PICKUP);
     
     // Create new fruit entity at the new position
     Color fruitColor = Color(255, 0, 0); // Red color
-    if (useBrickFile && brickLoader.hasEntity("fruit")) {
-        const brick::Entity* fruitBrickEntity = brickLoader.findEntity("fruit");
+    if (useBrickFile && brickLoader.entity(entityIds.fruit)) {
+        const brick::Entity* fruitBrickEntity = brickLoader.entity(entityIds.fruit);
         fruitColor = Color::fromHex(fruitBrickEntity->color);
     }
     
-    Entity fruitEntity("fruit", fruitPosition, fruitColor);
-    engine.addEntity(fruitEntity);
+    engine.placeEntity(fruitEntity, Entity(fruitPosition, fruitColor));
 }
 
 void SnakeGame::spawnSuperFruit() {
-    bool validPosition = false;
-    while (!validPosition) {
-        superfruitPosition = Point(
-            std::rand() % engine.getGridWidth(),
-            std::rand() % engine.getGridHeight()
-        );
-        validPosition = !isSnakeBody(superfruitPosition) && 
-                       superfruitPosition != fruitPosition &&
-                       !isSolidEntity(superfruitPosition);
+    SpatialGrid& grid = engine.getSpatialGrid();
+    grid.remove(superfruitPosition, LAYER_PICKUP);
+    if (!grid.findFreeCell(LAYER_SNAKE | LAYER_SOLID | LAYER_PICKUP, &superfruitPosition)) {
+        // No free cell left: the superfruit leaves the board
+        superfruitPosition = Point(-1, -1);
+        engine.destroyEntity(superfruitEntity);
+        return;
     }
+    grid.add(superfruitPosition, LAYER_PICKUP);
     
     // Create new superfruit entity at the new position
     Color superfruitColor = Color(255, 215, 0); // Gold color
-    if (useBrickFile && brickLoader.hasEntity("superfruit")) {
-        const brick::Entity* superfruitBrickEntity = brickLoader.findEntity("superfruit");
+    if (useBrickFile && brickLoader.entity(entityIds.superfruit)) {
+        const brick::Entity* superfruitBrickEntity = brickLoader.entity(entityIds.superfruit);
         superfruitColor = Color::fromHex(superfruitBrickEntity->color);
     }
     
-    Entity superfruitEntity("superfruit", superfruitPosition, superfruitColor);
-    engine.addEntity(superfruitEntity);
+    engine.placeEntity(superfruitEntity, Entity(superfruitPosition, superfruitColor));
 }
 
 bool SnakeGame::isValidPosition(const Point& pos) const {
@@ -188,53 +194,56 @@ bool SnakeGame::isValidPosition(const Point& pos) const {
 }
 
 bool SnakeGame::isSnakeBody(const Point& pos) const {
-    for (const auto& segment : snake) {
-        if (segment.position == pos) {
-            return true;
-        }
-    }
-    return false;
+    return engine.getSpatialGrid().occupied(pos, LAYER_SNAKE);
 }
 
+// The moving obstacle and wall at their current positions, and the solid
+// static entities of the .brick file; see rebuildSolidLayer().
 bool SnakeGame::isSolidEntity(const Point& pos) const {
-    // Check moving obstacles at their current positions
-    if (pos == obstaclePosition || pos == wallPosition) {
-        return true;
+    return engine.getSpatialGrid().occupied(pos, LAYER_SOLID);
+}
+
+// Done whenever the snake is rebuilt from scratch; moves update the layer
+// one cell at a time.
+void SnakeGame::rebuildSnakeLayer() {
+    SpatialGrid& grid = engine.getSpatialGrid();
+    grid.clearLayer(LAYER_SNAKE);
+    for (const auto& segment : snake) {
+        grid.add(segment.position, LAYER_SNAKE);
     }
+}
+
+void SnakeGame::rebuildSolidLayer() {
+    SpatialGrid& grid = engine.getSpatialGrid();
+    grid.clearLayer(LAYER_SOLID);
+    grid.add(obstaclePosition, LAYER_SOLID);
+    grid.add(wallPosition, LAYER_SOLID);
     
-    if (!useBrickFile) return false;
+    if (!useBrickFile) return;
     
     const auto& entities = brickLoader.getEntities();
     
-    for (const auto& pair : entities) {
-        const std::string& name = pair.first;
-        const brick::Entity& brickEntity = pair.second;
+    for (brick::EntityId id = 0; id < entities.size(); ++id) {
+        const brick::Entity& brickEntity = entities[id];
         
-        // Skip moving entities (they're handled above with dynamic positions)
-        if (name == "obstacle" || name == "wall") {
+        // Moving entities are added above at their current positions, and
+        // the snake has its own layer
+        if (id == entityIds.obstacle || id == entityIds.wall ||
+            id == entityIds.head || id == entityIds.body) {
             continue;
         }
         
-        // Check if this entity is solid and at the given position
-        if (brickEntity.solid && 
-            brickEntity.spawn.x == pos.x && 
-            brickEntity.spawn.y == pos.y) {
-            
-            // Skip snake-related entities (they're handled separately)
-            if (name == "head" || name == "body") {
-                continue;
-            }
-            
-            return true;
+        if (brickEntity.solid) {
+            grid.add(Point(brickEntity.spawn.x, brickEntity.spawn.y), LAYER_SOLID);
         }
     }
-    return false;
 }
 
 void SnakeGame::handleInput() {
     SDL_Event event;
     while (SDL_PollEvent(&event)) {
         input.handleEvent(event);
+        engine.handleEvent(event);
     }
     
     input.update();
@@ -299,6 +308,7 @@ void SnakeGame::updateSnake(float deltaTime) {
             snake.push_back(SnakeSegment(engine.getGridWidth() / 2, engine.getGridHeight() / 2));
             snake.push_back(SnakeSegment(engine.getGridWidth() / 2 - 1, engine.getGridHeight() / 2));
             snake.push_back(SnakeSegment(engine.getGridWidth() / 2 - 2, engine.getGridHeight() / 2));
+            rebuildSnakeLayer();
             currentDirection = RIGHT;
             nextDirection = RIGHT;
             return;
@@ -318,6 +328,7 @@ void SnakeGame::updateSnake(float deltaTime) {
             snake.push_back(SnakeSegment(engine.getGridWidth() / 2, engine.getGridHeight() / 2));
             snake.push_back(SnakeSegment(engine.getGridWidth() / 2 - 1, engine.getGridHeight() / 2));
             snake.push_back(SnakeSegment(engine.getGridWidth() / 2 - 2, engine.getGridHeight() / 2));
+            rebuildSnakeLayer();
             currentDirection = RIGHT;
             nextDirection = RIGHT;
             return;
@@ -339,6 +350,7 @@ void SnakeGame::updateSnake(float deltaTime) {
             snake.push_back(SnakeSegment(engine.getGridWidth() / 2, engine.getGridHeight() / 2));
             snake.push_back(SnakeSegment(engine.getGridWidth() / 2 - 1, engine.getGridHeight() / 2));
             snake.push_back(SnakeSegment(engine.getGridWidth() / 2 - 2, engine.getGridHeight() / 2));
+            rebuildSnakeLayer();
             currentDirection = RIGHT;
             nextDirection = RIGHT;
             return;
@@ -357,6 +369,7 @@ void SnakeGame::updateSnake(float deltaTime) {
             snake.push_back(SnakeSegment(engine.getGridWidth() / 2, engine.getGridHeight() / 2));
             snake.push_back(SnakeSegment(engine.getGridWidth() / 2 - 1, engine.getGridHeight() / 2));
             snake.push_back(SnakeSegment(engine.getGridWidth() / 2 - 2, engine.getGridHeight() / 2));
+            rebuildSnakeLayer();
             currentDirection = RIGHT;
             nextDirection = RIGHT;
             return;
@@ -376,6 +389,7 @@ void SnakeGame::updateSnake(float deltaTime) {
             snake.push_back(SnakeSegment(engine.getGridWidth() / 2, engine.getGridHeight() / 2));
             snake.push_back(SnakeSegment(engine.getGridWidth() / 2 - 1, engine.getGridHeight() / 2));
             snake.push_back(SnakeSegment(engine.getGridWidth() / 2 - 2, engine.getGridHeight() / 2));
+            rebuildSnakeLayer();
             currentDirection = RIGHT;
             nextDirection = RIGHT;
             return;
@@ -383,12 +397,12 @@ void SnakeGame::updateSnake(float deltaTime) {
         
         // Move snake
         snake.push_front(SnakeSegment(newHead));
+        engine.getSpatialGrid().add(newHead, LAYER_SNAKE);
         
         // Check fruit collision
         if (newHead == fruitPosition) {
             score += 10;
-            // Remove the fruit entity from the screen before spawning new one
-            engine.removeEntity("fruit");
+            // spawnFruit() moves the fruit entity to its new place
             spawnFruit();
             gameSpeed = std::min(15, gameSpeed + 1);
             moveDelay = 1.0f / gameSpeed;
@@ -397,12 +411,12 @@ void SnakeGame::updateSnake(float deltaTime) {
             // Grow 3 segments
             for (int i = 0; i < 3; i++) {
                 snake.push_back(snake.back());
+                engine.getSpatialGrid().add(snake.back().position, LAYER_SNAKE);
             }
-            // Remove the superfruit entity from the screen
-            engine.removeEntity("superfruit");
             spawnSuperFruit();
         } else {
             // Normal movement - remove tail
+            engine.getSpatialGrid().remove(snake.back().position, LAYER_SNAKE);
             snake.pop_back();
         }
     }
@@ -415,16 +429,18 @@ void SnakeGame::checkCollisions() {
 void SnakeGame::drawGame() {
     engine.update(0.016f);
     
-    // Clear all previous snake entities before drawing new ones
-    clearSnakeEntities();
+    // One engine entity per segment, reused from frame to frame; only the
+    // ones past the end of a shorter snake are destroyed
+    while (segmentEntities.size() > snake.size()) {
+        engine.destroyEntity(segmentEntities.back());
+        segmentEntities.pop_back();
+    }
+    segmentEntities.resize(snake.size());
     
     // Update snake entities
     for (int i = 0; i < snake.size(); i++) {
-        std::string name = (i == 0) ? "snake_head" : "snake_body_" + std::to_string(i);
-        
         Color color = (i == 0) ? Color(0, 255, 0) : Color(0, 136, 0);
-        Entity segment(name, snake[i].position, color);
-        engine.addEntity(segment);
+        engine.placeEntity(segmentEntities[i], Entity(snake[i].position, color));
     }
     
     // Ensure static entities are still present (reload if needed)
@@ -439,15 +455,23 @@ void SnakeGame::handleGameOver() {
     std::cout << "================\n" << std::endl;
 }
 
+void SnakeGame::resolveEntityIds() {
+    entityIds.head = brickLoader.entityId("head");
+    entityIds.body = brickLoader.entityId("body");
+    entityIds.fruit = brickLoader.entityId("fruit");
+    entityIds.superfruit = brickLoader.entityId("superfruit");
+    entityIds.obstacle = brickLoader.entityId("obstacle");
+    entityIds.wall = brickLoader.entityId("wall");
+}
+
 void SnakeGame::loadEntitiesFromBrick() {
     if (!useBrickFile) return;
     
     const auto& entities = brickLoader.getEntities();
     
     std::cout << "Loading entities from .brick file:" << std::endl;
-    for (const auto& pair : entities) {
-        const std::string& name = pair.first;
-        const brick::Entity& brickEntity = pair.second;
+    for (const auto& brickEntity : entities) {
+        const std::string& name = brickEntity.name;
         
         std::cout << "  Entity: " << name << std::endl;
         std::cout << "    Spawn: (" << brickEntity.spawn.x << ", " << brickEntity.spawn.y << ")" << std::endl;
@@ -474,12 +498,43 @@ void SnakeGame::loadEntitiesFromBrick() {
         
         // Load static entities like obstacles and walls
         Color entityColor = Color::fromHex(brickEntity.color);
-        Entity gameEntity(name, Point(brickEntity.spawn.x, brickEntity.spawn.y), entityColor);
-        engine.addEntity(gameEntity);
+        engine.addEntity(name, Entity(Point(brickEntity.spawn.x, brickEntity.spawn.y), entityColor));
         std::cout << "    Loaded " << name << " at (" << brickEntity.spawn.x << ", " << brickEntity.spawn.y << ")" << std::endl;
     }
 }
 
+// Runs at the top of update(), between two ticks. The snake, score, lives
+// and timers are kept; only what the file describes is replaced.
+void SnakeGame::applyReload() {
+    ReloadDiff diff;
+    if (!reloader.apply(brickLoader, &diff)) return;
+    resolveEntityIds();
+    if (diff.empty()) return;
+    rebuildSolidLayer();
+    diff.applySettings(*this, brickLoader);
+    
+    // Static entities are replaced from the new table; the ones the game
+    // moves keep their place and only take the new color.
+    diff.redoEntities([this](const std::string& name) {
+        if (name == "head" || name == "body") return;
+        
+        EntityHandle* moving = nullptr;
+        if (name == "fruit") moving = &fruitEntity;
+        else if (name == "superfruit") moving = &superfruitEntity;
+        else if (name == "obstacle") moving = &obstacleEntity;
+        else if (name == "wall") moving = &wallEntity;
+        
+        const brick::Entity* brickEntity = brickLoader.findEntity(name);
+        if (moving && brickEntity) {
+            engine.setColor(*moving, Color::fromHex(brickEntity->color));
+        } else if (moving) {
+            engine.destroyEntity(*moving);
+        } else {
+            HotReloader::replaceEntity(engine, brickLoader, name);
+        }
+    });
+}
+
 void SnakeGame::updateMovingObstacles(float deltaTime) {
     if (paused) return;
     
@@ -513,15 +568,14 @@ void SnakeGame::moveObstacle() {
     // Check if new position is valid (within bounds and not colliding with snake)
     if (isValidPosition(newPos) && !isSnakeBody(newPos) && 
         newPos != fruitPosition && newPos != superfruitPosition && newPos != wallPosition) {
+        engine.getSpatialGrid().move(obstaclePosition, newPos, LAYER_SOLID);
         obstaclePosition = newPos;
         
         // Update the visual entity
-        engine.removeEntity("obstacle");
-        if (useBrickFile && brickLoader.hasEntity("obstacle")) {
-            const brick::Entity* obstacleEntity = brickLoader.findEntity("obstacle");
-            Color obstacleColor = Color::fromHex(obstacleEntity->color);
-            Entity obstacleGameEntity("obstacle", obstaclePosition, obstacleColor);
-            engine.addEntity(obstacleGameEntity);
+        if (useBrickFile && brickLoader.entity(entityIds.obstacle)) {
+            const brick::Entity* obstacleBrickEntity = brickLoader.entity(entityIds.obstacle);
+            Color obstacleColor = Color::fromHex(obstacleBrickEntity->color);
+            engine.placeEntity(obstacleEntity, Entity(obstaclePosition, obstacleColor));
         }
     }
 }
@@ -541,20 +595,20 @@ void SnakeGame::moveWall() {
     // Check if new position is valid
     if (isValidPosition(newPos) && !isSnakeBody(newPos) && 
         newPos != fruitPosition && newPos != superfruitPosition && newPos != obstaclePosition) {
+        engine.getSpatialGrid().move(wallPosition, newPos, LAYER_SOLID);
         wallPosition = newPos;
         
         // Update the visual entity
-        engine.removeEntity("wall");
-        if (useBrickFile && brickLoader.hasEntity("wall")) {
-            const brick::Entity* wallEntity = brickLoader.findEntity("wall");
-            Color wallColor = Color::fromHex(wallEntity->color);
-            Entity wallGameEntity("wall", wallPosition, wallColor);
-            engine.addEntity(wallGameEntity);
+        if (useBrickFile && brickLoader.entity(entityIds.wall)) {
+            const brick::Entity* wallBrickEntity = brickLoader.entity(entityIds.wall);
+            Color wallColor = Color::fromHex(wallBrickEntity->color);
+            engine.placeEntity(wallEntity, Entity(wallPosition, wallColor));
         }
     }
 }
 
 void SnakeGame::update(float deltaTime) {
+    applyReload();
     handleInput();
     updateSnake(deltaTime);
     updateMovingObstacles(deltaTime);
@@ -563,36 +617,27 @@ void SnakeGame::update(float deltaTime) {
 
 void SnakeGame::clearSnakeEntities() {
     // Remove all snake-related entities from the game engine
-    engine.removeEntity("snake_head");
-    
-    // Remove all snake body segments (we need to check a reasonable range)
-    for (int i = 1; i < 1000; i++) { // 1000 should be more than enough for any snake length
-        std::string bodyName = "snake_body_" + std::to_string(i);
-        engine.removeEntity(bodyName);
+    for (EntityHandle segment : segmentEntities) {
+        engine.destroyEntity(segment);
     }
+    segmentEntities.clear();
 }
 
+// The static entities are added by loadEntitiesFromBrick() and applyReload().
+// The moving obstacle and wall first appear at their spawn point; after that
+// moveObstacle() and moveWall() place them.
 void SnakeGame::ensureStaticEntities() {
     if (!useBrickFile) return;
     
-    const auto& entities = brickLoader.getEntities();
-    
-    for (const auto& pair : entities) {
-        const std::string& name = pair.first;
-        const brick::Entity& brickEntity = pair.second;
-        
-        // Only ensure static entities (obstacles, walls, etc.)
-        if (name == "fruit" || name == "superfruit" || name == "head" || name == "body") {
-            continue;
-        }
-        
-        // Check if the entity exists in the engine, if not, add it
-        Entity* existingEntity = engine.getEntity(name);
-        if (!existingEntity) {
-            Color entityColor = Color::fromHex(brickEntity.color);
-            Entity gameEntity(name, Point(brickEntity.spawn.x, brickEntity.spawn.y), entityColor);
-            engine.addEntity(gameEntity);
-        }
+    const brick::Entity* obstacleBrickEntity = brickLoader.entity(entityIds.obstacle);
+    if (obstacleBrickEntity && !engine.isAlive(obstacleEntity)) {
+        obstacleEntity = engine.createEntity(Entity(Point(obstacleBrickEntity->spawn.x, obstacleBrickEntity->spawn.y),
+                                                    Color::fromHex(obstacleBrickEntity->color)));
+    }
+    const brick::Entity* wallBrickEntity = brickLoader.entity(entityIds.wall);
+    if (wallBrickEntity && !engine.isAlive(wallEntity)) {
+        wallEntity = engine.createEntity(Entity(Point(wallBrickEntity->spawn.x, wallBrickEntity->spawn.y),
+                                                Color::fromHex(wallBrickEntity->color)));
     }
 }
 
@@ -36,13 +36,15 @@ TankGame::TankGame(SDL_Window* window, SDL_Renderer* renderer, const std::string
     std::srand(static_cast<unsigned>(std::time(nullptr)));
     
     if (brickLoader.loadBrickFile(brickFile)) {
-        engine = GameEngine(window, renderer, brickLoader.getGridWidth(), brickLoader.getGridHeight(), cellSize);
+        engine.reset(window, renderer, brickLoader.getGridWidth(), brickLoader.getGridHeight(), cellSize);
         gameSpeed = brickLoader.getSpeed();
         lives = brickLoader.getLives();
         score = brickLoader.getScore();
         
         Color bgColor = Color::fromHex(brickLoader.getGameColor());
         engine.setBackgroundColor(bgColor);
+        resolveEntityIds();
+        reloader.watch(brickFile);
     }
 }
 
@@ -66,6 +68,9 @@ bool TankGame::initialize() {
     input.mapKeyToAction(SDLK_SPACE, "shoot");
     input.mapKeyToAction(SDLK_p, "pause");
     
+    wallLayer = engine.createStaticLayer();
+    destructibleWallLayer = engine.createStaticLayer();
+    
     initializeGame();
     loadEntitiesFromBrick();
     
@@ -74,8 +79,8 @@ bool TankGame::initialize() {
 
 void TankGame::initializeGame() {
     // Initialize player tank
-    if (useBrickFile && brickLoader.hasEntity("player_tank")) {
-        const brick::Entity* playerEntity = brickLoader.findEntity("player_tank");
+    if (useBrickFile && brickLoader.entity(entityIds.playerTank)) {
+        const brick::Entity* playerEntity = brickLoader.entity(entityIds.playerTank);
         playerTank = Tank(playerEntity->spawn.x, playerEntity->spawn.y, true);
         std::cout << "Player tank initialized at position from .brick: (" << playerEntity->spawn.x << ", " << playerEntity->spawn.y << ")" << std::endl;
     } else {
@@ -84,8 +89,8 @@ void TankGame::initializeGame() {
     
     // Initialize enemy tanks
     enemyTanks.clear();
-    if (useBrickFile && brickLoader.hasEntity("enemy_tank")) {
-        const brick::Entity* enemyEntity = brickLoader.findEntity("enemy_tank");
+    if (useBrickFile && brickLoader.entity(entityIds.enemyTank)) {
+        const brick::Entity* enemyEntity = brickLoader.entity(entityIds.enemyTank);
         Tank enemy(enemyEntity->spawn.x, enemyEntity->spawn.y, false);
         enemyTanks.push_back(enemy);
         std::cout << "Enemy tank spawned at position from .brick: (" << enemyEntity->spawn.x << ", " << enemyEntity->spawn.y << ")" << std::endl;
@@ -117,8 +122,8 @@ void TankGame::initializeGame() {
     
     // Initialize destructible walls
     destructibleWalls.clear();
-    if (useBrickFile && brickLoader.hasEntity("destructible_wall")) {
-        const brick::Entity* wallEntity = brickLoader.findEntity("destructible_wall");
+    if (useBrickFile && brickLoader.entity(entityIds.destructibleWall)) {
+        const brick::Entity* wallEntity = brickLoader.entity(entityIds.destructibleWall);
         destructibleWalls.push_back(Point(wallEntity->spawn.x, wallEntity->spawn.y));
     } else {
         // Add some destructible walls in the middle
@@ -129,9 +134,13 @@ void TankGame::initializeGame() {
         }
     }
     
+    rebuildGrid();
+    rebuildWallLayer();
+    rebuildDestructibleWallLayer();
+    
     // Initialize powerup
-    if (useBrickFile && brickLoader.hasEntity("powerup")) {
-        const brick::Entity* powerupEntity = brickLoader.findEntity("powerup");
+    if (useBrickFile && brickLoader.entity(entityIds.powerup)) {
+        const brick::Entity* powerupEntity = brickLoader.entity(entityIds.powerup);
         powerupPosition = Point(powerupEntity->spawn.x, powerupEntity->spawn.y);
         powerupActive = true;
     } else {
@@ -152,27 +161,10 @@ void TankGame::initializeGame() {
 }
 
 void TankGame::spawnPowerup() {
-    bool validPosition = false;
-    while (!validPosition) {
-        powerupPosition = Point(
-            std::rand() % (engine.getGridWidth() - 2) + 1,
-            std::rand() % (engine.getGridHeight() - 2) + 1
-        );
-        validPosition = !isWall(powerupPosition) && 
-                       !isDestructibleWall(powerupPosition) &&
-                       !isTankAt(powerupPosition);
-    }
-    powerupActive = true;
-    
-    // Create powerup entity
-    Color powerupColor = Color(0, 255, 255); // Cyan
-    if (useBrickFile && brickLoader.hasEntity("powerup")) {
-        const brick::Entity* powerupBrickEntity = brickLoader.findEntity("powerup");
-        powerupColor = Color::fromHex(powerupBrickEntity->color);
-    }
-    
-    Entity powerupEntity("powerup", powerupPosition, powerupColor);
-    engine.addEntity(powerupEntity);
+    // The border is all wall, so any free cell is inside the arena
+    powerupActive = engine.getSpatialGrid().findFreeCell(LAYER_WALL | LAYER_DESTRUCTIBLE | LAYER_TANK,
+                                                         &powerupPosition);
+    // drawPowerup() draws it from the next frame on
 }
 
 void TankGame::spawnEnemyTank() {
@@ -194,6 +186,7 @@ void TankGame::spawnEnemyTank() {
         if (!isTankAt(spawn) && !isDestructibleWall(spawn)) {
             Tank enemy(spawn, false);
             enemyTanks.push_back(enemy);
+            engine.getSpatialGrid().add(spawn, LAYER_TANK);
             std::cout << "Enemy tank spawned at (" << spawn.x << ", " << spawn.y << ")" << std::endl;
             break;
         }
@@ -206,33 +199,63 @@ bool TankGame::isValidPosition(const Point& pos) const {
 }
 
 bool TankGame::isWall(const Point& pos) const {
-    for (const Point& wall : walls) {
-        if (wall.x == pos.x && wall.y == pos.y) {
-            return true;
-        }
-    }
-    return false;
+    return engine.getSpatialGrid().occupied(pos, LAYER_WALL);
 }
 
 bool TankGame::isDestructibleWall(const Point& pos) const {
-    for (const Point& wall : destructibleWalls) {
-        if (wall.x == pos.x && wall.y == pos.y) {
-            return true;
-        }
-    }
-    return false;
+    return engine.getSpatialGrid().occupied(pos, LAYER_DESTRUCTIBLE);
 }
 
 bool TankGame::isTankAt(const Point& pos) const {
-    if (playerTank.position.x == pos.x && playerTank.position.y == pos.y && playerTank.isAlive) {
-        return true;
+    return engine.getSpatialGrid().occupied(pos, LAYER_TANK);
+}
+
+// Walls, destructible walls and live tanks, from the lists that
+// initializeGame() just filled. After this each change updates its cell.
+void TankGame::rebuildGrid() {
+    SpatialGrid& grid = engine.getSpatialGrid();
+    grid.clear();
+    for (const Point& wall : walls) {
+        grid.add(wall, LAYER_WALL);
+    }
+    for (const Point& wall : destructibleWalls) {
+        grid.add(wall, LAYER_DESTRUCTIBLE);
+    }
+    if (playerTank.isAlive) {
+        grid.add(playerTank.position, LAYER_TANK);
     }
     for (const Tank& enemy : enemyTanks) {
-        if (enemy.position.x == pos.x && enemy.position.y == pos.y && enemy.isAlive) {
-            return true;
+        if (enemy.isAlive) {
+            grid.add(enemy.position, LAYER_TANK);
         }
     }
-    return false;
+}
+
+// The wall colors come from the loader, so a hot reload rebuilds these too.
+void TankGame::rebuildWallLayer() {
+    Color wallColor = Color(139, 69, 19); // Brown
+    if (useBrickFile && brickLoader.entity(entityIds.wall)) {
+        const brick::Entity* wallEntity = brickLoader.entity(entityIds.wall);
+        wallColor = Color::fromHex(wallEntity->color);
+    }
+    
+    engine.clearStaticLayer(wallLayer);
+    for (const Point& wall : walls) {
+        engine.addStaticEntity(wallLayer, Entity(wall, wallColor));
+    }
+}
+
+void TankGame::rebuildDestructibleWallLayer() {
+    Color destructibleWallColor = Color(205, 133, 63); // Peru
+    if (useBrickFile && brickLoader.entity(entityIds.destructibleWall)) {
+        const brick::Entity* destructibleWallEntity = brickLoader.entity(entityIds.destructibleWall);
+        destructibleWallColor = Color::fromHex(destructibleWallEntity->color);
+    }
+    
+    engine.clearStaticLayer(destructibleWallLayer);
+    for (const Point& wall : destructibleWalls) {
+        engine.addStaticEntity(destructibleWallLayer, Entity(wall, destructibleWallColor));
+    }
 }
 
 void TankGame::destroyDestructibleWall(const Point& pos) {
@@ -241,7 +264,8 @@ void TankGame::destroyDestructibleWall(const Point& pos) {
     
     if (it != destructibleWalls.end()) {
         destructibleWalls.erase(it);
-        engine.removeEntity("destructible_wall_" + std::to_string(pos.x) + "_" + std::to_string(pos.y));
+        engine.getSpatialGrid().remove(pos, LAYER_DESTRUCTIBLE);
+        rebuildDestructibleWallLayer();
         createExplosion(pos);
     }
 }
@@ -250,6 +274,7 @@ void TankGame::handleInput() {
     SDL_Event event;
     while (SDL_PollEvent(&event)) {
         input.handleEvent(event);
+        engine.handleEvent(event);
     }
     
     input.update();
@@ -311,7 +336,11 @@ void TankGame::moveTank(Tank& tank, TankDirection direction) {
     }
     
     // Check if new position is valid
-    if (isValidPosition(newPos) && !isWall(newPos) && !isDestructibleWall(newPos) && !isTankAt(newPos)) {
+    if (isValidPosition(newPos) &&
+        !engine.getSpatialGrid().occupied(newPos, LAYER_WALL | LAYER_DESTRUCTIBLE | LAYER_TANK)) {
+        if (tank.isAlive) {
+            engine.getSpatialGrid().move(tank.position, newPos, LAYER_TANK);
+        }
         tank.position = newPos;
     }
 }
@@ -457,6 +486,7 @@ void TankGame::updateBullets(float deltaTime) {
                     createExplosion(enemyIt->position);
                     std::cout << "*** ENEMY DESTROYED at (" << newPos.x << ", " << newPos.y << ")! Score: " << score << " ***" << std::endl;
                     enemyIt->isAlive = false;
+                    engine.getSpatialGrid().remove(enemyIt->position, LAYER_TANK);
                     enemyTanks.erase(enemyIt);
                     
                     bullet.isActive = false;
@@ -554,7 +584,6 @@ void TankGame::checkCollisions() {
         score += 50;
         lives++;
         powerupActive = false;
-        engine.removeEntity("powerup");
         std::cout << "Powerup collected! Lives: " << lives << ", Score: " << score << std::endl;
         
         // Spawn new powerup after some time
@@ -590,26 +619,23 @@ void TankGame::drawGame() {
     // Draw player tank
     if (playerTank.isAlive) {
         Color playerColor = Color(0, 255, 0); // Green
-        if (useBrickFile && brickLoader.hasEntity("player_tank")) {
-            const brick::Entity* playerEntity = brickLoader.findEntity("player_tank");
+        if (useBrickFile && brickLoader.entity(entityIds.playerTank)) {
+            const brick::Entity* playerEntity = brickLoader.entity(entityIds.playerTank);
             playerColor = Color::fromHex(playerEntity->color);
         }
-        Entity playerEntity("player_tank", playerTank.position, playerColor);
-        engine.addEntity(playerEntity);
+        frameEntities.push_back(engine.createEntity(Entity(playerTank.position, playerColor)));
     }
     
     // Draw enemy tanks
     Color enemyColor = Color(255, 0, 0); // Red
-    if (useBrickFile && brickLoader.hasEntity("enemy_tank")) {
-        const brick::Entity* enemyEntity = brickLoader.findEntity("enemy_tank");
+    if (useBrickFile && brickLoader.entity(entityIds.enemyTank)) {
+        const brick::Entity* enemyEntity = brickLoader.entity(entityIds.enemyTank);
         enemyColor = Color::fromHex(enemyEntity->color);
     }
     
     for (int i = 0; i < enemyTanks.size(); i++) {
         if (enemyTanks[i].isAlive) {
-            std::string name = "enemy_tank_" + std::to_string(i);
-            Entity enemyEntity(name, enemyTanks[i].position, enemyColor);
-            engine.addEntity(enemyEntity);
+            frameEntities.push_back(engine.createEntity(Entity(enemyTanks[i].position, enemyColor)));
         }
     }
     
@@ -618,42 +644,37 @@ void TankGame::drawGame() {
     Color enemyBulletColor = Color(255, 136, 0); // Orange
     
     if (useBrickFile) {
-        if (brickLoader.hasEntity("bullet")) {
-            const brick::Entity* bulletEntity = brickLoader.findEntity("bullet");
+        if (brickLoader.entity(entityIds.bullet)) {
+            const brick::Entity* bulletEntity = brickLoader.entity(entityIds.bullet);
             bulletColor = Color::fromHex(bulletEntity->color);
         }
-        if (brickLoader.hasEntity("enemy_bullet")) {
-            const brick::Entity* enemyBulletEntity = brickLoader.findEntity("enemy_bullet");
+        if (brickLoader.entity(entityIds.enemyBullet)) {
+            const brick::Entity* enemyBulletEntity = brickLoader.entity(entityIds.enemyBullet);
             enemyBulletColor = Color::fromHex(enemyBulletEntity->color);
         }
     }
     
     for (int i = 0; i < bullets.size(); i++) {
         if (bullets[i].isActive) {
-            std::string name = "bullet_" + std::to_string(i);
             Color color = bullets[i].isPlayerBullet ? bulletColor : enemyBulletColor;
-            Entity bulletEntity(name, bullets[i].position, color);
-            engine.addEntity(bulletEntity);
+            frameEntities.push_back(engine.createEntity(Entity(bullets[i].position, color)));
         }
     }
     
     // Draw explosions
     Color explosionColor = Color(255, 69, 0); // Orange-red
-    if (useBrickFile && brickLoader.hasEntity("explosion")) {
-        const brick::Entity* explosionEntity = brickLoader.findEntity("explosion");
+    if (useBrickFile && brickLoader.entity(entityIds.explosion)) {
+        const brick::Entity* explosionEntity = brickLoader.entity(entityIds.explosion);
         explosionColor = Color::fromHex(explosionEntity->color);
     }
     
     for (int i = 0; i < explosions.size(); i++) {
         if (explosions[i].isActive) {
-            std::string name = "explosion_" + std::to_string(i);
-            Entity explosionEntity(name, explosions[i].position, explosionColor);
-            engine.addEntity(explosionEntity);
+            frameEntities.push_back(engine.createEntity(Entity(explosions[i].position, explosionColor)));
         }
     }
     
-    // Ensure static entities are present
-    ensureStaticEntities();
+    drawPowerup();
     
     engine.render();
 }
@@ -670,15 +691,25 @@ void TankGame::handleGameOver() {
     }
 }
 
+void TankGame::resolveEntityIds() {
+    entityIds.playerTank = brickLoader.entityId("player_tank");
+    entityIds.enemyTank = brickLoader.entityId("enemy_tank");
+    entityIds.destructibleWall = brickLoader.entityId("destructible_wall");
+    entityIds.powerup = brickLoader.entityId("powerup");
+    entityIds.bullet = brickLoader.entityId("bullet");
+    entityIds.enemyBullet = brickLoader.entityId("enemy_bullet");
+    entityIds.explosion = brickLoader.entityId("explosion");
+    entityIds.wall = brickLoader.entityId("wall");
+}
+
 void TankGame::loadEntitiesFromBrick() {
     if (!useBrickFile) return;
     
     const auto& entities = brickLoader.getEntities();
     
     std::cout << "Loading entities from .brick file:" << std::endl;
-    for (const auto& pair : entities) {
-        const std::string& name = pair.first;
-        const brick::Entity& brickEntity = pair.second;
+    for (const auto& brickEntity : entities) {
+        const std::string& name = brickEntity.name;
         
         std::cout << "  Entity: " << name << std::endl;
         std::cout << "    Spawn: (" << brickEntity.spawn.x << ", " << brickEntity.spawn.y << ")" << std::endl;
@@ -700,75 +731,56 @@ void TankGame::loadEntitiesFromBrick() {
         
         // Load other static entities
         Color entityColor = Color::fromHex(brickEntity.color);
-        Entity gameEntity(name, Point(brickEntity.spawn.x, brickEntity.spawn.y), entityColor);
-        engine.addEntity(gameEntity);
+        engine.addEntity(name, Entity(Point(brickEntity.spawn.x, brickEntity.spawn.y), entityColor));
         std::cout << "    Loaded " << name << " at (" << brickEntity.spawn.x << ", " << brickEntity.spawn.y << ")" << std::endl;
     }
 }
 
-void TankGame::clearGameEntities() {
-    // Remove all dynamic entities
-    engine.removeEntity("player_tank");
-    
-    // Remove enemy tanks
-    for (int i = 0; i < 20; i++) { // Reasonable upper limit
-        std::string name = "enemy_tank_" + std::to_string(i);
-        engine.removeEntity(name);
-    }
+// Runs at the top of update(), between two ticks. Tanks, bullets, walls,
+// score and lives are kept. Tank and bullet colors come from the loader every
+// frame; the wall layers and the static entities added by
+// loadEntitiesFromBrick() are redone.
+void TankGame::applyReload() {
+    ReloadDiff diff;
+    if (!reloader.apply(brickLoader, &diff)) return;
+    resolveEntityIds();
+    if (diff.empty()) return;
     
-    // Remove bullets
-    for (int i = 0; i < 100; i++) { // Reasonable upper limit
-        std::string name = "bullet_" + std::to_string(i);
-        engine.removeEntity(name);
-    }
+    diff.applySettings(*this, brickLoader);
+    rebuildWallLayer();
+    rebuildDestructibleWallLayer();
     
-    // Remove explosions
-    for (int i = 0; i < 50; i++) { // Reasonable upper limit
-        std::string name = "explosion_" + std::to_string(i);
-        engine.removeEntity(name);
-    }
+    diff.redoEntities([this](const std::string& name) {
+        if (name == "player_tank" || name == "enemy_tank" || name == "bullet" || name == "enemy_bullet" ||
+            name == "explosion" || name == "powerup" || name == "wall" || name == "destructible_wall") {
+            return;
+        }
+        HotReloader::replaceEntity(engine, brickLoader, name);
+    });
 }
 
-void TankGame::ensureStaticEntities() {
-    // Draw walls
-    Color wallColor = Color(139, 69, 19); // Brown
-    if (useBrickFile && brickLoader.hasEntity("wall")) {
-        const brick::Entity* wallEntity = brickLoader.findEntity("wall");
-        wallColor = Color::fromHex(wallEntity->color);
-    }
-    
-    for (int i = 0; i < walls.size(); i++) {
-        std::string name = "wall_" + std::to_string(walls[i].x) + "_" + std::to_string(walls[i].y);
-        Entity wallEntity(name, walls[i], wallColor);
-        engine.addEntity(wallEntity);
-    }
-    
-    // Draw destructible walls
-    Color destructibleWallColor = Color(205, 133, 63); // Peru
-    if (useBrickFile && brickLoader.hasEntity("destructible_wall")) {
-        const brick::Entity* destructibleWallEntity = brickLoader.findEntity("destructible_wall");
-        destructibleWallColor = Color::fromHex(destructibleWallEntity->color);
-    }
-    
-    for (int i = 0; i < destructibleWalls.size(); i++) {
-        std::string name = "destructible_wall_" + std::to_string(destructibleWalls[i].x) + "_" + std::to_string(destructibleWalls[i].y);
-        Entity wallEntity(name, destructibleWalls[i], destructibleWallColor);
-        engine.addEntity(wallEntity);
+void TankGame::clearGameEntities() {
+    // Remove all dynamic entities
+    for (EntityHandle entity : frameEntities) {
+        engine.destroyEntity(entity);
     }
-    
-    // Draw powerup if active
+    frameEntities.clear();
+}
+
+// Walls are static layers (see rebuildWallLayer)
+void TankGame::drawPowerup() {
     if (powerupActive) {
         Color powerupColor = Color(0, 255, 255); // Cyan
-        if (useBrickFile && brickLoader.hasEntity("powerup")) {
-            const brick::Entity* powerupEntity = brickLoader.findEntity("powerup");
+        if (useBrickFile && brickLoader.entity(entityIds.powerup)) {
+            const brick::Entity* powerupEntity = brickLoader.entity(entityIds.powerup);
             powerupColor = Color::fromHex(powerupEntity->color);
         }
-        Entity powerupEntity("powerup", powerupPosition, powerupColor);
-        engine.addEntity(powerupEntity);
+        frameEntities.push_back(engine.createEntity(Entity(powerupPosition, powerupColor)));
     }
 }
 
 void TankGame::update(float deltaTime) {
+    applyReload();
     handleInput();
     updatePlayerMovement(deltaTime);
     updateTanks(deltaTime);
@@ -48,7 +48,7 @@ TetrisGame::TetrisGame(SDL_Window* window, SDL_Renderer* renderer, const std::st
     if (brickLoader.loadBrickFile(brickFile)) {
         boardWidth = brickLoader.getGridWidth();
         boardHeight = brickLoader.getGridHeight();
-        engine = GameEngine(window, renderer, boardWidth, boardHeight, cellSize);
+        engine.reset(window, renderer, boardWidth, boardHeight, cellSize);
         
         int brickSpeed = brickLoader.getSpeed();
         gravitySpeed = 1.0f / brickSpeed;
@@ -64,6 +64,7 @@ TetrisGame::TetrisGame(SDL_Window* window, SDL_Renderer* renderer, const std::st
         
         Color bgColor = Color::fromHex(brickLoader.getGameColor());
         engine.setBackgroundColor(bgColor);
+        reloader.watch(brickFile);
     }
     
     board = new int*[boardHeight];
@@ -294,6 +295,7 @@ void TetrisGame::handleInput() {
     SDL_Event event;
     while (SDL_PollEvent(&event)) {
         input.handleEvent(event);
+        engine.handleEvent(event);
     }
     
     input.update();
@@ -434,6 +436,12 @@ void TetrisGame::getPieceShape(TetrisBlockType type, RotationState rot,
 void TetrisGame::drawGame() {
     engine.update(0.016f);
     
+    // Blocks and the falling piece are drawn from the board every frame
+    for (EntityHandle entity : frameEntities) {
+        engine.destroyEntity(entity);
+    }
+    frameEntities.clear();
+    
     drawBoard();
     drawCurrentPiece();
     
@@ -445,8 +453,6 @@ void TetrisGame::drawBoard() {
     for (int y = 0; y < boardHeight; y++) {
         for (int x = 0; x < boardWidth; x++) {
             if (board[y][x] != BLOCK_EMPTY) {
-                std::string name = "block_" + std::to_string(y * boardWidth + x);
-                
                 Color colors[] = {
                     Color(0, 0, 0),           // Empty
                     Color(0, 255, 255),       // Cyan I
@@ -458,8 +464,7 @@ void TetrisGame::drawBoard() {
                     Color(255, 165, 0)        // Orange L
                 };
                 
-                Entity block(name, Point(x, y), colors[board[y][x]]);
-                engine.addEntity(block);
+                frameEntities.push_back(engine.createEntity(Entity(Point(x, y), colors[board[y][x]])));
             }
         }
     }
@@ -488,9 +493,7 @@ void TetrisGame::drawCurrentPiece() {
             int boardY = currentPiece.y + y;
             
             if (isValidPosition(boardX, boardY)) {
-                std::string name = "current_" + std::to_string(y * 4 + x);
-                Entity piece(name, Point(boardX, boardY), colors[currentPiece.type]);
-                engine.addEntity(piece);
+                frameEntities.push_back(engine.createEntity(Entity(Point(boardX, boardY), colors[currentPiece.type])));
             }
         }
     }
@@ -514,9 +517,8 @@ void TetrisGame::loadEntitiesFromBrick() {
     const auto& entities = brickLoader.getEntities();
     
     std::cout << "Loading entities from .brick file:" << std::endl;
-    for (const auto& pair : entities) {
-        const std::string& name = pair.first;
-        const brick::Entity& brickEntity = pair.second;
+    for (const auto& brickEntity : entities) {
+        const std::string& name = brickEntity.name;
         
         std::cout << "  Entity: " << name << std::endl;
         std::cout << "    Spawn: (" << brickEntity.spawn.x << ", " << brickEntity.spawn.y << ")" << std::endl;
@@ -524,12 +526,24 @@ void TetrisGame::loadEntitiesFromBrick() {
         std::cout << "    Solid: " << (brickEntity.solid ? "true" : "false") << std::endl;
         
         Color entityColor = Color::fromHex(brickEntity.color);
-        Entity gameEntity(name, Point(brickEntity.spawn.x, brickEntity.spawn.y), entityColor);
-        engine.addEntity(gameEntity);
+        engine.addEntity(name, Entity(Point(brickEntity.spawn.x, brickEntity.spawn.y), entityColor));
     }
 }
 
+// Runs at the top of update(), between two ticks. The board, the falling
+// piece, score and level are kept. The board size is fixed for the game.
+void TetrisGame::applyReload() {
+    ReloadDiff diff;
+    if (!reloader.apply(brickLoader, &diff) || diff.empty()) return;
+    
+    diff.applySettings(*this, brickLoader);
+    diff.redoEntities([this](const std::string& name) {
+        HotReloader::replaceEntity(engine, brickLoader, name);
+    });
+}
+
 void TetrisGame::update(float deltaTime) {
+    applyReload();
     inputTimer += deltaTime;
     handleInput();
     updateDropTimer(deltaTime);
@@ -0,0 +1,644 @@
+#include "game_engine.hpp"
+#include "renderer.hpp"
+#include "fake_sdl.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+#include <map>
+#include <vector>
+
+// ============================================================================
+// Engine tests - run against the fake SDL in fake_sdl.cpp
+// ============================================================================
+
+static int failures = 0;
+
+#define CHECK(condition)                                                   \
+    do {                                                                   \
+        if (!(condition)) {                                                \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n",              \
+                         __FILE__, __LINE__, #condition);                  \
+            failures++;                                                    \
+        }                                                                  \
+    } while (0)
+
+// ============================================================================
+// Entity handles
+// ============================================================================
+
+static void testHandleReuse() {
+    GameEngine engine(nullptr, nullptr, 30, 30);
+    EntityHandle a = engine.createEntity(Entity(Point(1, 1)));
+    EntityHandle b = engine.createEntity(Entity(Point(2, 2)));
+    EntityHandle c = engine.createEntity(Entity(Point(3, 3)));
+    CHECK(engine.getEntityCount() == 3);
+
+    engine.destroyEntity(a);
+    CHECK(!engine.isAlive(a));
+    CHECK(engine.isAlive(b) && engine.isAlive(c));
+
+    // The freed slot is recycled with a new generation, so the old handle
+    // stays dead and destroying it again leaves the new entity alone.
+    EntityHandle d = engine.createEntity(Entity(Point(4, 4)));
+    CHECK(d.index == a.index);
+    CHECK(d != a);
+    CHECK(!engine.isAlive(a));
+    engine.destroyEntity(a);
+    CHECK(engine.isAlive(d));
+    CHECK(engine.getEntityCount() == 3);
+
+    engine.clearEntities();
+    CHECK(engine.getEntityCount() == 0);
+    CHECK(!engine.isAlive(b) && !engine.isAlive(c) && !engine.isAlive(d));
+    EntityHandle e = engine.createEntity(Entity(Point(5, 5)));
+    CHECK(engine.isAlive(e));
+    CHECK(!engine.isAlive(b) && !engine.isAlive(c) && !engine.isAlive(d));
+}
+
+static void testNamedEntities() {
+    GameEngine engine(nullptr, nullptr, 30, 30);
+    EntityHandle first = engine.addEntity("wall", Entity(Point(5, 5)));
+    CHECK(engine.findEntity("wall") == first);
+
+    EntityHandle second = engine.addEntity("wall", Entity(Point(6, 6)));
+    CHECK(!engine.isAlive(first));
+    CHECK(engine.findEntity("wall") == second);
+    CHECK(engine.getEntityCount() == 1);
+
+    engine.destroyEntity(second);
+    CHECK(engine.findEntity("wall") == EntityHandle());
+    engine.removeEntity("wall");
+    engine.removeEntity("missing");
+
+    EntityHandle placed;
+    engine.placeEntity(placed, Entity(Point(7, 7)));
+    CHECK(engine.isAlive(placed));
+    EntityHandle before = placed;
+    engine.placeEntity(placed, Entity(Point(8, 8)));
+    CHECK(placed == before);
+}
+
+// Random creates and destroys checked against a map of the live handles.
+static void testHandleChurn() {
+    GameEngine engine(nullptr, nullptr, 30, 30);
+    std::map<int, EntityHandle> live;
+    std::vector<EntityHandle> dead;
+    int next = 0;
+    std::srand(3);
+    for (int step = 0; step < 20000; step++) {
+        if (live.empty() || std::rand() % 3 != 0) {
+            live[next++] = engine.createEntity(Entity(Point(std::rand() % 30, 0)));
+        } else {
+            std::map<int, EntityHandle>::iterator it = live.begin();
+            std::advance(it, std::rand() % live.size());
+            engine.destroyEntity(it->second);
+            dead.push_back(it->second);
+            live.erase(it);
+        }
+    }
+    CHECK(engine.getEntityCount() == live.size());
+    bool allAlive = true;
+    for (std::map<int, EntityHandle>::const_iterator it = live.begin(); it != live.end(); ++it) {
+        allAlive = allAlive && engine.isAlive(it->second);
+    }
+    CHECK(allAlive);
+    bool allDead = true;
+    for (size_t i = 0; i < dead.size(); i++) {
+        allDead = allDead && !engine.isAlive(dead[i]);
+    }
+    CHECK(allDead);
+}
+
+// ============================================================================
+// Spatial grid
+// ============================================================================
+
+static void testGridCounts() {
+    SpatialGrid grid(4, 3);
+    Point cell(1, 1);
+    CHECK(!grid.occupied(cell, LAYER_SNAKE));
+
+    // A layer stays occupied until every add has been matched by a remove.
+    grid.add(cell, LAYER_SNAKE);
+    grid.add(cell, LAYER_SNAKE);
+    grid.add(cell, LAYER_SOLID);
+    CHECK(grid.count(cell, LAYER_SNAKE) == 2);
+    CHECK(grid.occupied(cell, LAYER_SNAKE | LAYER_TANK));
+    CHECK(!grid.occupied(cell, LAYER_TANK));
+
+    grid.remove(cell, LAYER_SNAKE);
+    CHECK(grid.occupied(cell, LAYER_SNAKE));
+    grid.remove(cell, LAYER_SNAKE);
+    CHECK(!grid.occupied(cell, LAYER_SNAKE));
+    CHECK(grid.occupied(cell, LAYER_SOLID));
+    grid.remove(cell, LAYER_SNAKE);
+    CHECK(grid.count(cell, LAYER_SNAKE) == 0);
+
+    grid.move(cell, Point(2, 2), LAYER_SOLID);
+    CHECK(!grid.occupied(cell, ~0u));
+    CHECK(grid.occupied(Point(2, 2), LAYER_SOLID));
+}
+
+static void testGridOutside() {
+    SpatialGrid grid(4, 3);
+    grid.add(Point(-1, 0), LAYER_WALL);
+    grid.add(Point(4, 0), LAYER_WALL);
+    grid.add(Point(0, 3), LAYER_WALL);
+    CHECK(!grid.occupied(Point(-1, 0), ~0u));
+    CHECK(!grid.occupied(Point(4, 0), ~0u));
+    CHECK(grid.count(Point(4, 0), LAYER_WALL) == 0);
+    for (int y = 0; y < 3; y++) {
+        for (int x = 0; x < 4; x++) {
+            CHECK(!grid.occupied(Point(x, y), ~0u));
+        }
+    }
+    grid.remove(Point(-1, 0), LAYER_WALL);
+}
+
+static void testGridFreeCell() {
+    SpatialGrid grid(4, 3);
+    grid.add(Point(2, 2), LAYER_SOLID);
+    for (int y = 0; y < 3; y++) {
+        for (int x = 0; x < 4; x++) {
+            if (x != 3 || y != 0) {
+                grid.add(Point(x, y), LAYER_WALL);
+            }
+        }
+    }
+    Point cell;
+    bool alwaysFound = true;
+    for (int i = 0; i < 100; i++) {
+        alwaysFound = alwaysFound && grid.findFreeCell(LAYER_WALL, &cell) && cell == Point(3, 0);
+    }
+    CHECK(alwaysFound);
+
+    grid.add(Point(3, 0), LAYER_WALL);
+    CHECK(!grid.findFreeCell(LAYER_WALL, &cell));
+    CHECK(grid.findFreeCell(LAYER_TANK, &cell));
+
+    grid.clearLayer(LAYER_WALL);
+    CHECK(!grid.occupied(Point(0, 0), LAYER_WALL));
+    CHECK(grid.occupied(Point(2, 2), LAYER_SOLID));
+    grid.clear();
+    CHECK(!grid.occupied(Point(2, 2), ~0u));
+
+    SpatialGrid empty;
+    CHECK(!empty.findFreeCell(0, &cell));
+}
+
+// ============================================================================
+// Render batch
+// ============================================================================
+
+static void clearScreen(SDL_Renderer* renderer) {
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+    SDL_SetRenderDrawColor(renderer, 0, 17, 34, 255);
+    SDL_RenderClear(renderer);
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+}
+
+static void testBatchGroupsByColor() {
+    SDL_Renderer* renderer = createFakeRenderer(200, 20);
+    RenderBatch batch;
+    for (int i = 0; i < 10; i++) {
+        if (i % 2 == 0) {
+            batch.fillRect(i * 20, 0, 10, 10, 255, 0, 0);
+        } else {
+            batch.fillRect(i * 20, 0, 10, 10, 0, 0, 255);
+        }
+    }
+    CHECK(batch.flush(renderer) == 2);
+    CHECK(renderer->drawCalls == 2);
+    CHECK(batch.empty());
+    destroyFakeRenderer(renderer);
+}
+
+// A red rect under a blue one and another red rect over it: the second red
+// one must not join the first one's bucket, or blue would end up on top.
+static void testBatchOverlapOrder() {
+    SDL_Renderer* batched = createFakeRenderer(100, 100);
+    SDL_Renderer* direct = createFakeRenderer(100, 100);
+    clearScreen(batched);
+    clearScreen(direct);
+
+    RenderBatch batch;
+    batch.fillRect(0, 0, 10, 10, 255, 0, 0);
+    batch.fillRect(5, 5, 10, 10, 0, 0, 255);
+    batch.fillRect(8, 8, 10, 10, 255, 0, 0);
+    // Clear of the blue rect, so it can join the first bucket.
+    batch.fillRect(50, 50, 10, 10, 255, 0, 0);
+    CHECK(batch.flush(batched) == 3);
+
+    Renderer::fillRect(direct, 0, 0, 10, 10, 255, 0, 0);
+    Renderer::fillRect(direct, 5, 5, 10, 10, 0, 0, 255);
+    Renderer::fillRect(direct, 8, 8, 10, 10, 255, 0, 0);
+    Renderer::fillRect(direct, 50, 50, 10, 10, 255, 0, 0);
+    CHECK(screenDifference(batched, direct) == 0.0);
+
+    destroyFakeRenderer(batched);
+    destroyFakeRenderer(direct);
+}
+
+// Random rects, lines and points from a small palette, some translucent,
+// must come out as if drawn one by one, in fewer calls.
+static void testBatchMatchesDirect() {
+    static const Uint8 palette[4][4] = {
+        {255, 0, 0, 255}, {0, 255, 0, 128}, {0, 0, 255, 255}, {255, 255, 0, 60}
+    };
+    SDL_Renderer* batched = createFakeRenderer(120, 90);
+    SDL_Renderer* direct = createFakeRenderer(120, 90);
+    clearScreen(batched);
+    clearScreen(direct);
+
+    RenderBatch batch;
+    std::srand(7);
+    for (int i = 0; i < 400; i++) {
+        const Uint8* c = palette[std::rand() % 4];
+        int x = std::rand() % 120, y = std::rand() % 90;
+        if (i == 200) {
+            batch.setBlendMode(SDL_BLENDMODE_NONE);
+            SDL_SetRenderDrawBlendMode(direct, SDL_BLENDMODE_NONE);
+        }
+        switch (std::rand() % 4) {
+        case 0: {
+            int w = 1 + std::rand() % 20, h = 1 + std::rand() % 20;
+            batch.fillRect(x, y, w, h, c[0], c[1], c[2], c[3]);
+            Renderer::fillRect(direct, x, y, w, h, c[0], c[1], c[2], c[3]);
+            break;
+        }
+        case 1: {
+            int x2 = std::rand() % 2 ? x : std::rand() % 120;
+            int y2 = std::rand() % 2 ? y : std::rand() % 90;
+            batch.drawLine(x, y, x2, y2, c[0], c[1], c[2], c[3]);
+            Renderer::drawLine(direct, x, y, x2, y2, c[0], c[1], c[2], c[3]);
+            break;
+        }
+        case 2: {
+            // Chained segments, drawn as one polyline by the batch.
+            int x2 = std::rand() % 120, y2 = std::rand() % 90;
+            batch.drawLine(x, y, x2, y2, c[0], c[1], c[2], c[3]);
+            batch.drawLine(x2, y2, x, y2 / 2, c[0], c[1], c[2], c[3]);
+            Renderer::drawLine(direct, x, y, x2, y2, c[0], c[1], c[2], c[3]);
+            Renderer::drawLine(direct, x2, y2, x, y2 / 2, c[0], c[1], c[2], c[3]);
+            break;
+        }
+        default: {
+            SDL_Point point = {x, y};
+            batch.drawPoint(x, y, c[0], c[1], c[2], c[3]);
+            SDL_SetRenderDrawColor(direct, c[0], c[1], c[2], c[3]);
+            SDL_RenderDrawPoints(direct, &point, 1);
+            break;
+        }
+        }
+    }
+
+    int calls = batch.flush(batched);
+    CHECK(calls == batched->drawCalls);
+    CHECK(calls < direct->drawCalls);
+    CHECK(screenDifference(batched, direct) < 1e-12);
+    // flush() puts back the blend mode it found.
+    CHECK(batched->blendMode == SDL_BLENDMODE_BLEND);
+
+    destroyFakeRenderer(batched);
+    destroyFakeRenderer(direct);
+}
+
+// ============================================================================
+// Layer caches
+// ============================================================================
+
+// Walls on two static layers, some translucent, and two entities on top.
+static void buildScene(GameEngine& engine, int frame, int* walls) {
+    if (frame == 0) {
+        *walls = engine.createStaticLayer();
+        for (int x = 0; x < 20; x++) {
+            engine.addStaticEntity(*walls, Entity(Point(x, 0), Color(139, 69, 19)));
+            engine.addStaticEntity(*walls, Entity(Point(x, 14), Color(139, 69, 19, 160)));
+        }
+        int crates = engine.createStaticLayer();
+        for (int x = 5; x < 9; x++) {
+            engine.addStaticEntity(crates, Entity(Point(x, 5), Color(205, 133, 63, 120)));
+        }
+    }
+    if (frame == 3) {
+        engine.clearStaticLayer(*walls);
+        engine.addStaticEntity(*walls, Entity(Point(3, 3), Color(10, 200, 10, 90), 3, 3));
+    }
+    if (frame == 5) {
+        engine.setBackgroundColor(Color(40, 0, 30));
+    }
+    engine.clearEntities();
+    engine.createEntity(Entity(Point(frame, 7), Color(0, 255, 0)));
+    engine.createEntity(Entity(Point(6, 5), Color(255, 0, 0, 128)));
+}
+
+static void testLayerCacheMatchesDirect() {
+    SDL_Renderer* cached = createFakeRenderer(400, 300);
+    SDL_Renderer* direct = createFakeRenderer(400, 300, false);
+    {
+        GameEngine withCache(nullptr, cached, 20, 15, 20);
+        GameEngine withoutCache(nullptr, direct, 20, 15, 20);
+        withCache.initialize();
+        withoutCache.initialize();
+        int cachedWalls = -1, directWalls = -1;
+        for (int frame = 0; frame < 8; frame++) {
+            buildScene(withCache, frame, &cachedWalls);
+            buildScene(withoutCache, frame, &directWalls);
+            withCache.render();
+            withoutCache.render();
+            CHECK(screenDifference(cached, direct) < 1e-9);
+        }
+        CHECK(cached->copies > 0);
+        CHECK(direct->copies == 0);
+    }
+    // The destructor releases every cached texture.
+    CHECK(cached->texturesAlive == 0);
+    destroyFakeRenderer(cached);
+    destroyFakeRenderer(direct);
+}
+
+static void testLayerCacheInvalidation() {
+    SDL_Renderer* renderer = createFakeRenderer(400, 300);
+    {
+        GameEngine engine(nullptr, renderer, 20, 15, 20);
+        engine.initialize();
+        int walls = engine.createStaticLayer();
+        for (int x = 0; x < 20; x++) {
+            engine.addStaticEntity(walls, Entity(Point(x, 0), Color(139, 69, 19)));
+        }
+        engine.render();
+        int textures = renderer->texturesCreated;
+        CHECK(textures == 2);
+
+        // Nothing changed: the grid and the layer are only composited.
+        int calls = renderer->drawCalls;
+        engine.render();
+        CHECK(renderer->drawCalls == calls);
+        CHECK(renderer->texturesCreated == textures);
+
+        // A changed layer is redrawn into the texture it already has.
+        engine.addStaticEntity(walls, Entity(Point(4, 4), Color(9, 9, 200)));
+        calls = renderer->drawCalls;
+        engine.render();
+        CHECK(renderer->drawCalls > calls);
+        CHECK(renderer->texturesCreated == textures);
+
+        // A new background color redraws the grid, whose color follows it.
+        engine.setBackgroundColor(Color(30, 10, 40));
+        calls = renderer->drawCalls;
+        engine.render();
+        CHECK(renderer->drawCalls > calls);
+    }
+    destroyFakeRenderer(renderer);
+}
+
+static void testDeviceReset() {
+    SDL_Renderer* cached = createFakeRenderer(400, 300);
+    SDL_Renderer* direct = createFakeRenderer(400, 300, false);
+    {
+        GameEngine withCache(nullptr, cached, 20, 15, 20);
+        GameEngine withoutCache(nullptr, direct, 20, 15, 20);
+        withCache.initialize();
+        withoutCache.initialize();
+        int cachedWalls = -1, directWalls = -1;
+        buildScene(withCache, 0, &cachedWalls);
+        buildScene(withoutCache, 0, &directWalls);
+        withCache.render();
+
+        // The textures died with the device: they are dropped and made again.
+        SDL_Event event;
+        event.type = SDL_RENDER_DEVICE_RESET;
+        withCache.handleEvent(event);
+        CHECK(cached->texturesAlive == 0);
+        withCache.render();
+        withoutCache.render();
+        CHECK(cached->texturesAlive == 3);
+        CHECK(screenDifference(cached, direct) < 1e-9);
+
+        // The textures survived but lost their contents: they are redrawn.
+        int textures = cached->texturesCreated;
+        int calls = cached->drawCalls;
+        event.type = SDL_RENDER_TARGETS_RESET;
+        withCache.handleEvent(event);
+        withCache.render();
+        CHECK(cached->texturesCreated == textures);
+        CHECK(cached->drawCalls > calls);
+        CHECK(screenDifference(cached, direct) < 1e-9);
+    }
+    destroyFakeRenderer(cached);
+    destroyFakeRenderer(direct);
+}
+
+// reset() lets the games resize the engine in place; it must not leak the
+// old textures or bring old handles back.
+static void testEngineReset() {
+    SDL_Renderer* renderer = createFakeRenderer(400, 300);
+    {
+        GameEngine engine(nullptr, renderer, 20, 15, 20);
+        engine.initialize();
+        int walls = -1;
+        buildScene(engine, 0, &walls);
+        EntityHandle handle = engine.createEntity(Entity(Point(1, 1)));
+        engine.render();
+        CHECK(renderer->texturesAlive == 3);
+
+        engine.reset(nullptr, renderer, 10, 12, 20);
+        CHECK(renderer->texturesAlive == 0);
+        CHECK(!engine.isAlive(handle));
+        CHECK(engine.getEntityCount() == 0);
+        CHECK(engine.getSpatialGrid().getWidth() == 10);
+        CHECK(engine.getSpatialGrid().getHeight() == 12);
+
+        engine.initialize();
+        EntityHandle reused = engine.createEntity(Entity(Point(1, 1)));
+        CHECK(!engine.isAlive(handle));
+        CHECK(engine.isAlive(reused));
+        engine.render();
+        CHECK(renderer->texturesAlive == 1);
+    }
+    destroyFakeRenderer(renderer);
+}
+
+// ============================================================================
+// Incremental rendering
+// ============================================================================
+
+struct SceneObject {
+    Point position;
+    Point size;
+    Color color;
+};
+
+static void placeObjects(GameEngine& engine, const std::vector<SceneObject>& objects) {
+    engine.clearEntities();
+    for (size_t i = 0; i < objects.size(); i++) {
+        const SceneObject& object = objects[i];
+        engine.createEntity(Entity(object.position, object.color, object.size.x, object.size.y));
+    }
+}
+
+// Random objects, some partly off the grid, moved a little every frame next
+// to static layer, background and device changes; every incremental frame
+// must equal the full one.
+static void testIncrementalMatchesFull() {
+    SDL_Renderer* incremental = createFakeRenderer(400, 300);
+    SDL_Renderer* full = createFakeRenderer(400, 300);
+    {
+        GameEngine partial(nullptr, incremental, 20, 15, 20);
+        GameEngine whole(nullptr, full, 20, 15, 20);
+        partial.initialize();
+        whole.initialize();
+        partial.setIncrementalRendering(true);
+        int partialWalls = partial.createStaticLayer();
+        int wholeWalls = whole.createStaticLayer();
+        for (int x = 0; x < 20; x++) {
+            Entity wall(Point(x, 0), Color(139, 69, 19, 200));
+            partial.addStaticEntity(partialWalls, wall);
+            whole.addStaticEntity(wholeWalls, wall);
+        }
+
+        std::srand(3);
+        std::vector<SceneObject> objects;
+        for (int i = 0; i < 25; i++) {
+            SceneObject object;
+            object.position = Point(std::rand() % 22 - 1, std::rand() % 17 - 1);
+            object.size = Point(1 + std::rand() % 3 * (std::rand() % 4 == 0), 1 + (std::rand() % 5 == 0));
+            object.color = Color(std::rand() % 256, std::rand() % 256, std::rand() % 256,
+                                 std::rand() % 2 ? 255 : std::rand() % 256);
+            objects.push_back(object);
+        }
+
+        size_t redrawn = 0;
+        int mismatches = 0;
+        for (int frame = 0; frame < 200; frame++) {
+            for (int k = 0; k < 2; k++) {
+                SceneObject& object = objects[std::rand() % objects.size()];
+                object.position.x += std::rand() % 3 - 1;
+                object.position.y += std::rand() % 3 - 1;
+                if (std::rand() % 7 == 0) {
+                    object.color.a = std::rand() % 256;
+                }
+            }
+            if (frame % 50 == 25) {
+                Entity wall(Point(std::rand() % 20, std::rand() % 15), Color(9, 9, 200, 140));
+                partial.addStaticEntity(partialWalls, wall);
+                whole.addStaticEntity(wholeWalls, wall);
+            }
+            if (frame == 120) {
+                partial.setBackgroundColor(Color(30, 10, 40));
+                whole.setBackgroundColor(Color(30, 10, 40));
+            }
+            if (frame == 150) {
+                partial.clearStaticLayer(partialWalls);
+                whole.clearStaticLayer(wholeWalls);
+            }
+            if (frame == 170) {
+                SDL_Event event;
+                event.type = SDL_RENDER_DEVICE_RESET;
+                partial.handleEvent(event);
+            }
+            // Swapping two objects changes the draw order only.
+            if (frame % 37 == 0) {
+                std::swap(objects[0], objects[1]);
+            }
+            placeObjects(partial, objects);
+            placeObjects(whole, objects);
+            partial.render();
+            whole.render();
+            redrawn += partial.getRedrawnCells();
+            if (screenDifference(incremental, full) > 1e-9) {
+                mismatches++;
+            }
+        }
+        CHECK(mismatches == 0);
+        CHECK(redrawn < 200u * 20 * 15 / 2);
+        CHECK(whole.getRedrawnCells() == 20u * 15);
+    }
+    destroyFakeRenderer(incremental);
+    destroyFakeRenderer(full);
+}
+
+static void testIncrementalDirtyCells() {
+    SDL_Renderer* renderer = createFakeRenderer(400, 300);
+    {
+        GameEngine engine(nullptr, renderer, 20, 15, 20);
+        engine.initialize();
+        engine.setIncrementalRendering(true);
+        EntityHandle head = engine.createEntity(Entity(Point(4, 4), Color(0, 255, 0)));
+        engine.createEntity(Entity(Point(10, 10), Color(255, 0, 0)));
+        engine.render();
+        CHECK(engine.getRedrawnCells() == 20u * 15);
+
+        // Same picture: nothing to redraw.
+        engine.render();
+        CHECK(engine.getRedrawnCells() == 0);
+
+        // One cell left, one cell entered.
+        engine.setPosition(head, Point(5, 4));
+        engine.render();
+        CHECK(engine.getRedrawnCells() == 2);
+
+        // A recolor touches only that cell.
+        engine.setColor(head, Color(0, 128, 0));
+        engine.render();
+        CHECK(engine.getRedrawnCells() == 1);
+
+        engine.setBackgroundColor(Color(30, 10, 40));
+        engine.render();
+        CHECK(engine.getRedrawnCells() == 20u * 15);
+    }
+    destroyFakeRenderer(renderer);
+}
+
+// Without render targets there is no back buffer: every frame is whole and
+// matches a non-incremental engine.
+static void testIncrementalFallback() {
+    SDL_Renderer* fallback = createFakeRenderer(400, 300, false);
+    SDL_Renderer* full = createFakeRenderer(400, 300, false);
+    {
+        GameEngine partial(nullptr, fallback, 20, 15, 20);
+        GameEngine whole(nullptr, full, 20, 15, 20);
+        partial.initialize();
+        whole.initialize();
+        partial.setIncrementalRendering(true);
+        for (int frame = 0; frame < 3; frame++) {
+            partial.clearEntities();
+            whole.clearEntities();
+            partial.createEntity(Entity(Point(frame, 3), Color(0, 255, 0, 128)));
+            whole.createEntity(Entity(Point(frame, 3), Color(0, 255, 0, 128)));
+            partial.render();
+            whole.render();
+            CHECK(partial.getRedrawnCells() == 20u * 15);
+            CHECK(screenDifference(fallback, full) < 1e-9);
+        }
+    }
+    destroyFakeRenderer(fallback);
+    destroyFakeRenderer(full);
+}
+
+int main() {
+    testHandleReuse();
+    testNamedEntities();
+    testHandleChurn();
+    testGridCounts();
+    testGridOutside();
+    testGridFreeCell();
+    testBatchGroupsByColor();
+    testBatchOverlapOrder();
+    testBatchMatchesDirect();
+    testLayerCacheMatchesDirect();
+    testLayerCacheInvalidation();
+    testDeviceReset();
+    testEngineReset();
+    testIncrementalMatchesFull();
+    testIncrementalDirtyCells();
+    testIncrementalFallback();
+
+    if (failures > 0) {
+        std::fprintf(stderr, "%d check(s) failed\n", failures);
+        return EXIT_FAILURE;
+    }
+    std::printf("All engine tests passed\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,297 @@
+#include "fake_sdl.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+// ============================================================================
+// Fake SDL Implementation
+// ============================================================================
+
+namespace {
+
+// What SDL_ComposeCustomBlendMode() hands out: the source is premultiplied.
+const SDL_BlendMode PREMULTIPLIED_BLEND = static_cast<SDL_BlendMode>(0x1000);
+
+SDL_Texture* currentTarget(SDL_Renderer* renderer) {
+    return renderer->target ? renderer->target : &renderer->screen;
+}
+
+bool clipped(const SDL_Renderer* renderer, int x, int y) {
+    if (!renderer->clipEnabled) {
+        return false;
+    }
+    const SDL_Rect& clip = renderer->clip;
+    return x < clip.x || y < clip.y || x >= clip.x + clip.w || y >= clip.y + clip.h;
+}
+
+void plot(SDL_Renderer* renderer, int x, int y) {
+    SDL_Texture* target = currentTarget(renderer);
+    if (clipped(renderer, x, y) || x < 0 || y < 0 || x >= target->w || y >= target->h) {
+        return;
+    }
+    double* pixel = &target->pixels[(y * target->w + x) * 4];
+    double source[4];
+    for (int k = 0; k < 4; k++) {
+        source[k] = renderer->color[k] / 255.0;
+    }
+    if (renderer->blendMode == SDL_BLENDMODE_NONE) {
+        for (int k = 0; k < 4; k++) {
+            pixel[k] = source[k];
+        }
+        return;
+    }
+    for (int k = 0; k < 3; k++) {
+        pixel[k] = source[k] * source[3] + pixel[k] * (1.0 - source[3]);
+    }
+    pixel[3] = source[3] + pixel[3] * (1.0 - source[3]);
+}
+
+// Bresenham, both end points included.
+void line(SDL_Renderer* renderer, int x1, int y1, int x2, int y2) {
+    int dx = std::abs(x2 - x1), dy = -std::abs(y2 - y1);
+    int sx = x1 < x2 ? 1 : -1, sy = y1 < y2 ? 1 : -1;
+    int error = dx + dy;
+    for (;;) {
+        plot(renderer, x1, y1);
+        if (x1 == x2 && y1 == y2) {
+            break;
+        }
+        int twice = 2 * error;
+        if (twice >= dy) {
+            error += dy;
+            x1 += sx;
+        }
+        if (twice <= dx) {
+            error += dx;
+            y1 += sy;
+        }
+    }
+}
+
+void fill(SDL_Renderer* renderer, const SDL_Rect& rect) {
+    for (int y = rect.y; y < rect.y + rect.h; y++) {
+        for (int x = rect.x; x < rect.x + rect.w; x++) {
+            plot(renderer, x, y);
+        }
+    }
+}
+
+} // namespace
+
+SDL_Renderer* createFakeRenderer(int width, int height, bool renderTargets) {
+    SDL_Renderer* renderer = new SDL_Renderer();
+    renderer->screen.w = width;
+    renderer->screen.h = height;
+    renderer->screen.pixels.assign(width * height * 4, 0.0);
+    renderer->screen.blendMode = SDL_BLENDMODE_NONE;
+    renderer->target = nullptr;
+    renderer->blendMode = SDL_BLENDMODE_NONE;
+    renderer->clipEnabled = false;
+    renderer->renderTargets = renderTargets;
+    return renderer;
+}
+
+void destroyFakeRenderer(SDL_Renderer* renderer) {
+    delete renderer;
+}
+
+double screenDifference(const SDL_Renderer* a, const SDL_Renderer* b) {
+    const std::vector<double>& left = a->screen.pixels;
+    const std::vector<double>& right = b->screen.pixels;
+    if (left.size() != right.size()) {
+        return 1.0;
+    }
+    double difference = 0.0;
+    for (size_t i = 0; i < left.size(); i++) {
+        if (i % 4 != 3) {
+            difference = std::max(difference, std::fabs(left[i] - right[i]));
+        }
+    }
+    return difference;
+}
+
+// ============================================================================
+// SDL entry points
+// ============================================================================
+
+int SDL_Init(Uint32) { return 0; }
+void SDL_Quit() {}
+const char* SDL_GetError() { return "fake SDL"; }
+
+SDL_Window* SDL_CreateWindow(const char*, int, int, int, int, Uint32) { return nullptr; }
+void SDL_DestroyWindow(SDL_Window*) {}
+SDL_Renderer* SDL_CreateRenderer(SDL_Window*, int, Uint32) { return nullptr; }
+void SDL_DestroyRenderer(SDL_Renderer*) {}
+
+SDL_bool SDL_RenderTargetSupported(SDL_Renderer* renderer) {
+    return renderer->renderTargets ? SDL_TRUE : SDL_FALSE;
+}
+
+SDL_BlendMode SDL_ComposeCustomBlendMode(SDL_BlendFactor, SDL_BlendFactor, SDL_BlendOperation,
+                                         SDL_BlendFactor, SDL_BlendFactor, SDL_BlendOperation) {
+    return PREMULTIPLIED_BLEND;
+}
+
+SDL_Texture* SDL_CreateTexture(SDL_Renderer* renderer, Uint32, int, int w, int h) {
+    if (!renderer->renderTargets) {
+        return nullptr;
+    }
+    renderer->texturesCreated++;
+    renderer->texturesAlive++;
+    SDL_Texture* texture = new SDL_Texture();
+    texture->w = w;
+    texture->h = h;
+    texture->pixels.assign(w * h * 4, 0.0);
+    texture->blendMode = SDL_BLENDMODE_NONE;
+    texture->owner = renderer;
+    return texture;
+}
+
+void SDL_DestroyTexture(SDL_Texture* texture) {
+    if (texture) {
+        texture->owner->texturesAlive--;
+    }
+    delete texture;
+}
+
+int SDL_SetTextureBlendMode(SDL_Texture* texture, SDL_BlendMode mode) {
+    texture->blendMode = mode;
+    return 0;
+}
+
+int SDL_SetRenderTarget(SDL_Renderer* renderer, SDL_Texture* texture) {
+    renderer->target = texture;
+    return 0;
+}
+
+int SDL_GetRendererOutputSize(SDL_Renderer* renderer, int* w, int* h) {
+    *w = renderer->screen.w;
+    *h = renderer->screen.h;
+    return 0;
+}
+
+int SDL_RenderSetClipRect(SDL_Renderer* renderer, const SDL_Rect* rect) {
+    renderer->clipEnabled = rect != nullptr;
+    if (rect) {
+        renderer->clip = *rect;
+    }
+    return 0;
+}
+
+int SDL_SetRenderDrawColor(SDL_Renderer* renderer, Uint8 r, Uint8 g, Uint8 b, Uint8 a) {
+    renderer->color[0] = r;
+    renderer->color[1] = g;
+    renderer->color[2] = b;
+    renderer->color[3] = a;
+    return 0;
+}
+
+int SDL_SetRenderDrawBlendMode(SDL_Renderer* renderer, SDL_BlendMode mode) {
+    renderer->blendMode = mode;
+    return 0;
+}
+
+int SDL_GetRenderDrawBlendMode(SDL_Renderer* renderer, SDL_BlendMode* mode) {
+    *mode = renderer->blendMode;
+    return 0;
+}
+
+int SDL_RenderClear(SDL_Renderer* renderer) {
+    SDL_Texture* target = currentTarget(renderer);
+    for (size_t i = 0; i < target->pixels.size(); i++) {
+        target->pixels[i] = renderer->color[i % 4] / 255.0;
+    }
+    return 0;
+}
+
+int SDL_RenderFillRect(SDL_Renderer* renderer, const SDL_Rect* rect) {
+    renderer->drawCalls++;
+    if (rect) {
+        fill(renderer, *rect);
+    } else {
+        SDL_Texture* target = currentTarget(renderer);
+        SDL_Rect all = {0, 0, target->w, target->h};
+        fill(renderer, all);
+    }
+    return 0;
+}
+
+int SDL_RenderFillRects(SDL_Renderer* renderer, const SDL_Rect* rects, int count) {
+    renderer->drawCalls++;
+    for (int i = 0; i < count; i++) {
+        fill(renderer, rects[i]);
+    }
+    return 0;
+}
+
+int SDL_RenderDrawRect(SDL_Renderer* renderer, const SDL_Rect* rect) {
+    renderer->drawCalls++;
+    SDL_Rect edges[4] = {
+        {rect->x, rect->y, rect->w, 1},
+        {rect->x, rect->y + rect->h - 1, rect->w, 1},
+        {rect->x, rect->y + 1, 1, rect->h - 2},
+        {rect->x + rect->w - 1, rect->y + 1, 1, rect->h - 2}
+    };
+    for (int i = 0; i < 4; i++) {
+        fill(renderer, edges[i]);
+    }
+    return 0;
+}
+
+int SDL_RenderDrawLine(SDL_Renderer* renderer, int x1, int y1, int x2, int y2) {
+    renderer->drawCalls++;
+    line(renderer, x1, y1, x2, y2);
+    return 0;
+}
+
+// Joints are drawn by both segments, as with separate SDL_RenderDrawLine calls.
+int SDL_RenderDrawLines(SDL_Renderer* renderer, const SDL_Point* points, int count) {
+    renderer->drawCalls++;
+    for (int i = 0; i + 1 < count; i++) {
+        line(renderer, points[i].x, points[i].y, points[i + 1].x, points[i + 1].y);
+    }
+    return 0;
+}
+
+int SDL_RenderDrawPoints(SDL_Renderer* renderer, const SDL_Point* points, int count) {
+    renderer->drawCalls++;
+    for (int i = 0; i < count; i++) {
+        plot(renderer, points[i].x, points[i].y);
+    }
+    return 0;
+}
+
+// No scaling: the texture is placed at the destination's corner.
+int SDL_RenderCopy(SDL_Renderer* renderer, SDL_Texture* texture, const SDL_Rect*, const SDL_Rect* destination) {
+    renderer->copies++;
+    SDL_Texture* target = currentTarget(renderer);
+    int left = destination ? destination->x : 0;
+    int top = destination ? destination->y : 0;
+    int width = destination ? destination->w : target->w;
+    int height = destination ? destination->h : target->h;
+    for (int y = 0; y < height && y < texture->h; y++) {
+        for (int x = 0; x < width && x < texture->w; x++) {
+            int tx = left + x, ty = top + y;
+            if (clipped(renderer, tx, ty) || tx < 0 || ty < 0 || tx >= target->w || ty >= target->h) {
+                continue;
+            }
+            const double* source = &texture->pixels[(y * texture->w + x) * 4];
+            double* pixel = &target->pixels[(ty * target->w + tx) * 4];
+            if (texture->blendMode == SDL_BLENDMODE_NONE) {
+                for (int k = 0; k < 4; k++) {
+                    pixel[k] = source[k];
+                }
+            } else if (texture->blendMode == PREMULTIPLIED_BLEND) {
+                for (int k = 0; k < 4; k++) {
+                    pixel[k] = source[k] + pixel[k] * (1.0 - source[3]);
+                }
+            } else {
+                // The engine only composites premultiplied textures.
+                std::abort();
+            }
+        }
+    }
+    return 0;
+}
+
+void SDL_RenderPresent(SDL_Renderer*) {}
@@ -0,0 +1,45 @@
+#ifndef FAKE_SDL_HPP
+#define FAKE_SDL_HPP
+
+#include <SDL2/SDL.h>
+#include <vector>
+
+// ============================================================================
+// Fake SDL - Software stand-ins for the SDL calls the engine makes
+// ============================================================================
+
+// The tests link these instead of SDL, so they run without a display. Pixels
+// are RGBA doubles holding premultiplied color, so drawing through a cached
+// texture can be compared exactly with drawing straight to the screen.
+struct SDL_Texture {
+    int w, h;
+    std::vector<double> pixels;
+    SDL_BlendMode blendMode;
+    SDL_Renderer* owner;
+};
+
+struct SDL_Renderer {
+    SDL_Texture screen;
+    SDL_Texture* target;
+    Uint8 color[4];
+    SDL_BlendMode blendMode;
+    bool clipEnabled;
+    SDL_Rect clip;
+    bool renderTargets;
+
+    // Counters, never reset by the fake.
+    int drawCalls;
+    int copies;
+    int texturesCreated;
+    int texturesAlive;
+};
+
+// Without render targets SDL_RenderTargetSupported() says so and
+// SDL_CreateTexture() fails.
+SDL_Renderer* createFakeRenderer(int width, int height, bool renderTargets = true);
+void destroyFakeRenderer(SDL_Renderer* renderer);
+
+// Largest difference between the color channels of the two screens.
+double screenDifference(const SDL_Renderer* a, const SDL_Renderer* b);
+
+#endif // FAKE_SDL_HPP